@@ -0,0 +1,188 @@
+#include "Anaglyph.h"
+
+#include <cmath>
+#include <cstdint>
+
+#include <vector>
+
+#include "glm/vec3.hpp"
+#include "glm/mat3x3.hpp"
+#include "glm/common.hpp"
+#include "glm/exponential.hpp"
+#include "glm/matrix.hpp"
+
+#include "GLState.h"
+#include "GLUtils.h"
+#include "logger.h"
+
+#define LOG_TAG "VRVideoPlayerA"
+
+static constexpr float DISPLAY_GAMMA = 2.2f;
+// how much the views are kept grey against the channels of the eye, just enough to decide the
+// colours the channels leave open
+static constexpr float CHROMA_WEIGHT = 0.01f;
+
+/**
+ * The linear anaglyph colour is left * left view + right * right view, clipped; the filter of the
+ * left eye passes leftChannels, the one of the right eye the others.
+ */
+struct AnaglyphEncoding {
+    glm::mat3 left;
+    glm::mat3 right;
+    glm::vec3 leftChannels;
+};
+
+static glm::mat3 FromRows(const glm::vec3 &r, const glm::vec3 &g, const glm::vec3 &b) {
+    return glm::transpose(glm::mat3(r, g, b));
+}
+
+static glm::mat3 Diagonal(const glm::vec3 &diagonal) {
+    return {
+            diagonal.x, 0.0f, 0.0f,
+            0.0f, diagonal.y, 0.0f,
+            0.0f, 0.0f, diagonal.z,
+    };
+}
+
+static AnaglyphEncoding MethodEncoding(AnaglyphMethod method) {
+    switch (method) {
+        case AnaglyphMethod::DUBOIS_RED_CYAN:
+            return {
+                    FromRows({0.437f, 0.449f, 0.164f},
+                             {-0.062f, -0.062f, -0.024f},
+                             {-0.048f, -0.050f, -0.017f}),
+                    FromRows({-0.011f, -0.032f, -0.007f},
+                             {0.377f, 0.761f, 0.009f},
+                             {-0.026f, -0.093f, 1.234f}),
+                    {1.0f, 0.0f, 0.0f}
+            };
+
+        case AnaglyphMethod::DUBOIS_GREEN_MAGENTA:
+            return {
+                    FromRows({-0.062f, -0.158f, -0.039f},
+                             {0.284f, 0.668f, 0.143f},
+                             {-0.015f, -0.027f, 0.021f}),
+                    FromRows({0.529f, 0.705f, 0.024f},
+                             {-0.016f, -0.015f, -0.065f},
+                             {0.009f, 0.075f, 0.937f}),
+                    {0.0f, 1.0f, 0.0f}
+            };
+
+        case AnaglyphMethod::DUBOIS_AMBER_BLUE:
+            return {
+                    FromRows({1.062f, -0.205f, 0.299f},
+                             {-0.026f, 0.908f, 0.068f},
+                             {-0.038f, -0.173f, 0.022f}),
+                    FromRows({-0.016f, -0.123f, -0.017f},
+                             {0.006f, 0.062f, -0.017f},
+                             {0.094f, 0.185f, 0.911f}),
+                    {1.0f, 1.0f, 0.0f}
+            };
+
+        case AnaglyphMethod::HALF_COLOR_RED_CYAN:
+            return {
+                    FromRows({0.299f, 0.587f, 0.114f},
+                             {0.0f, 0.0f, 0.0f},
+                             {0.0f, 0.0f, 0.0f}),
+                    FromRows({0.0f, 0.0f, 0.0f},
+                             {0.0f, 1.0f, 0.0f},
+                             {0.0f, 0.0f, 1.0f}),
+                    {1.0f, 0.0f, 0.0f}
+            };
+
+        default:
+            return {glm::mat3(1.0f), glm::mat3(0.0f), glm::vec3(1.0f)};
+    }
+}
+
+/**
+ * The linear view of the eye from the linear anaglyph colour. The view v minimizes
+ * |P (left + right) v - P a|² + w |v - grey(v)|², where P passes the channels of the eye: the
+ * channels are taken as encoded from the same view twice, and the least colourful of the views
+ * fitting them is chosen.
+ */
+static glm::mat3 DecodeMatrix(const AnaglyphEncoding &encoding, int eye) {
+    const glm::vec3 channels = eye == 0 ? encoding.leftChannels
+                                        : glm::vec3(1.0f) - encoding.leftChannels;
+    const glm::mat3 pass = Diagonal(channels);
+    const glm::mat3 seen = pass * (encoding.left + encoding.right);
+    // v - grey(v), the mean of the channels
+    const glm::vec3 mean(1.0f / 3.0f);
+    const glm::mat3 chroma = glm::mat3(1.0f) - glm::mat3(mean, mean, mean);
+
+    const glm::mat3 seenT = glm::transpose(seen);
+    return glm::inverse(seenT * seen + CHROMA_WEIGHT * glm::transpose(chroma) * chroma) *
+           seenT * pass;
+}
+
+Anaglyph::Anaglyph() :
+        method(AnaglyphMethod::NONE),
+        texture(0),
+        changed(false) {
+}
+
+void Anaglyph::GlSetup() {
+    glGenTextures(1, &texture);
+    GetGLState().BindTexture(GL_TEXTURE_3D, texture);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    CHECK_GL_ERROR("Anaglyph setup");
+    changed = true;
+}
+
+void Anaglyph::SetMethod(AnaglyphMethod newMethod) {
+    changed |= newMethod != method;
+    method = newMethod;
+}
+
+AnaglyphMethod Anaglyph::GetMethod() const {
+    return method;
+}
+
+void Anaglyph::Update() {
+    if (!changed || method == AnaglyphMethod::NONE) {
+        return;
+    }
+    changed = false;
+
+    LOG_DEBUG("Building anaglyph LUTs for method %d", method);
+    const AnaglyphEncoding encoding = MethodEncoding(method);
+    // red along the rows, green along the columns, blue along the slices of the left eye, then
+    // of the right eye
+    std::vector<uint8_t> lut(2 * LUT_SIZE * LUT_SIZE * LUT_SIZE * 4);
+    const float step = 1.0f / float(LUT_SIZE - 1);
+    auto texel = lut.begin();
+    for (int eye = 0; eye < 2; ++eye) {
+        const glm::mat3 decode = DecodeMatrix(encoding, eye);
+        for (int b = 0; b < LUT_SIZE; ++b) {
+            for (int g = 0; g < LUT_SIZE; ++g) {
+                for (int r = 0; r < LUT_SIZE; ++r) {
+                    const glm::vec3 encoded(float(r) * step, float(g) * step, float(b) * step);
+                    const glm::vec3 view = glm::clamp(
+                            decode * glm::pow(encoded, glm::vec3(DISPLAY_GAMMA)), 0.0f, 1.0f);
+                    const glm::vec3 color = glm::pow(view, glm::vec3(1.0f / DISPLAY_GAMMA));
+                    *texel++ = static_cast<uint8_t>(std::lround(color.r * 255.0f));
+                    *texel++ = static_cast<uint8_t>(std::lround(color.g * 255.0f));
+                    *texel++ = static_cast<uint8_t>(std::lround(color.b * 255.0f));
+                    *texel++ = 255;
+                }
+            }
+        }
+    }
+
+    GetGLState().BindTexture(GL_TEXTURE_3D, texture);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA8, LUT_SIZE, LUT_SIZE, 2 * LUT_SIZE, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, lut.data());
+    CHECK_GL_ERROR("Anaglyph upload");
+}
+
+GLuint Anaglyph::GetTexture() const {
+    return texture;
+}
+
+float Anaglyph::LutOffset(int eye) {
+    return 0.5f * float(eye);
+}
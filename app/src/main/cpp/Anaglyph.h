@@ -0,0 +1,61 @@
+#ifndef VR_VIDEO_PLAYER_ANAGLYPH_H
+#define VR_VIDEO_PLAYER_ANAGLYPH_H
+
+#include <GLES3/gl3.h>
+
+/**
+ * How the anaglyph video was made from its views, and for which glasses.
+ */
+enum class AnaglyphMethod {
+    NONE = 0,
+    // the least-squares projections of Eric Dubois
+    DUBOIS_RED_CYAN = 1,
+    DUBOIS_GREEN_MAGENTA = 2,
+    DUBOIS_AMBER_BLUE = 3,
+    // the luminance of the left view in red, the colours of the right view in green and blue
+    HALF_COLOR_RED_CYAN = 4,
+};
+
+/**
+ * Decoding of anaglyph video into the views of the eyes, by a 3D LUT per eye the anaglyph video
+ * programs sample right after the video texture; the LUT of the right eye is stacked above the
+ * one of the left eye along the blue axis. Each eye keeps the channels its filter passes, and
+ * takes the rest of its colour from the least-squares estimate of both views being the same. The
+ * LUTs work in linear light for a display gamma of 2.2 and are built on the CPU whenever the
+ * method changes.
+ */
+class Anaglyph {
+public:
+    // texels along each axis of the LUT of an eye, the input colours in between are interpolated
+    static constexpr int LUT_SIZE = 33;
+
+    Anaglyph();
+
+    /**
+     * Creates the texture in a new context; the LUTs are uploaded by the next Update.
+     */
+    void GlSetup();
+
+    void SetMethod(AnaglyphMethod method);
+
+    AnaglyphMethod GetMethod() const;
+
+    /**
+     * Builds and uploads the LUTs of the method, if it changed since the last call.
+     */
+    void Update();
+
+    GLuint GetTexture() const;
+
+    /**
+     * Where the LUT of the eye starts along the blue axis of the texture, in texture coordinates.
+     */
+    static float LutOffset(int eye);
+
+private:
+    AnaglyphMethod method;
+    GLuint texture;
+    bool changed;
+};
+
+#endif //VR_VIDEO_PLAYER_ANAGLYPH_H
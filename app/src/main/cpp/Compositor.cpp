@@ -0,0 +1,362 @@
+#include "Compositor.h"
+
+#include <chrono>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <EGL/eglext.h>
+
+#include "glm/vec3.hpp"
+#include "glm/mat3x3.hpp"
+#define GLM_ENABLE_EXPERIMENTAL // quaternion.hpp is an experimental extension in GLM
+#include "glm/gtx/quaternion.hpp"
+#include "glm/gtc/type_ptr.hpp"
+
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "GLUtils.h"
+#include "logger.h"
+
+#define LOG_TAG "VRVideoPlayerA"
+
+// the pose is latched right before the distortion pass, one swap and the scanout before display
+static constexpr uint64_t PREDICTION_NANOS = 20'000'000UL;
+// the urgent display priority of the system compositor
+static constexpr int COMPOSITOR_NICE = -8;
+// the render thread is not held back by a compositor not showing frames
+static constexpr auto DISPLAY_WAIT_TIMEOUT = std::chrono::milliseconds(50);
+
+Compositor::Compositor() :
+        slots{},
+        format{GL_TEXTURE_2D, 0, 0, false},
+        headTracker(nullptr),
+        distortionRenderer{},
+        display(EGL_NO_DISPLAY),
+        context(EGL_NO_CONTEXT),
+        surface(EGL_NO_SURFACE),
+        running(false),
+        failed(false),
+        shownSlot(-1),
+        readySlot(-1) {
+}
+
+Compositor::~Compositor() {
+    Stop();
+}
+
+bool Compositor::IsRunning() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return running;
+}
+
+bool Compositor::HasFailed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return failed;
+}
+
+void Compositor::SetLens(int eye, const CardboardMesh &mesh,
+                         const std::array<float, 4> &fieldOfView) {
+    distortionRenderer.SetMesh(eye, mesh);
+    distortionRenderer.SetFieldOfView(eye, fieldOfView);
+}
+
+bool Compositor::Start(ANativeWindow *window, CardboardHeadTracker *tracker,
+                       const Format &requestedFormat) {
+    Stop();
+    format = requestedFormat;
+    headTracker = tracker;
+    GlSetupSlots();
+
+    // the compositor context is created like the current one, whose config supports windows too
+    display = eglGetCurrentDisplay();
+    EGLContext shareContext = eglGetCurrentContext();
+    EGLint configId = 0;
+    EGLint clientVersion = 0;
+    eglQueryContext(display, shareContext, EGL_CONFIG_ID, &configId);
+    eglQueryContext(display, shareContext, EGL_CONTEXT_CLIENT_VERSION, &clientVersion);
+    const EGLint configAttributes[] = {EGL_CONFIG_ID, configId, EGL_NONE};
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) ||
+        configCount < 1) {
+        LOG_ERROR("Cannot find compositor EGL config %d: 0x%x", configId, eglGetError());
+        return false;
+    }
+
+    std::vector<EGLint> contextAttributes{EGL_CONTEXT_CLIENT_VERSION, clientVersion};
+    if (HasEGLExtension(display, "EGL_IMG_context_priority")) {
+        // lets the distortion pass preempt the eye buffer rendering on GPUs that can
+        contextAttributes.push_back(EGL_CONTEXT_PRIORITY_LEVEL_IMG);
+        contextAttributes.push_back(EGL_CONTEXT_PRIORITY_HIGH_IMG);
+    }
+    contextAttributes.push_back(EGL_NONE);
+    context = eglCreateContext(display, config, shareContext, contextAttributes.data());
+    if (context == EGL_NO_CONTEXT) {
+        LOG_ERROR("Cannot create compositor context: 0x%x", eglGetError());
+        return false;
+    }
+    surface = eglCreateWindowSurface(display, config, window, nullptr);
+    if (surface == EGL_NO_SURFACE) {
+        LOG_ERROR("Cannot create compositor window surface: 0x%x", eglGetError());
+        eglDestroyContext(display, context);
+        context = EGL_NO_CONTEXT;
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = true;
+        failed = false;
+        shownSlot = -1;
+        readySlot = -1;
+    }
+    thread = std::thread(&Compositor::Run, this);
+    LOG_DEBUG("Compositor started");
+    return true;
+}
+
+/**
+ * Also joins a thread that stopped on its own after an error.
+ */
+void Compositor::Stop() {
+    if (!thread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    thread.join();
+    eglDestroySurface(display, surface);
+    surface = EGL_NO_SURFACE;
+    eglDestroyContext(display, context);
+    context = EGL_NO_CONTEXT;
+    LOG_DEBUG("Compositor stopped");
+}
+
+void Compositor::GlReset() {
+    Stop();
+    slots = {};
+}
+
+void Compositor::GlSetupSlots() {
+    GlTeardownSlots();
+
+    GLState &glState = GetGLState();
+    const GLsizei layerCount = format.textureTarget == GL_TEXTURE_2D_ARRAY ? 2 : 1;
+    for (Slot &slot: slots) {
+        glGenTextures(1, &slot.texture);
+        glState.BindTexture(format.textureTarget, slot.texture);
+        if (layerCount > 1) {
+            glTexStorage3D(format.textureTarget, 1, format.internalFormat, format.width,
+                           format.height, layerCount);
+        } else {
+            glTexStorage2D(format.textureTarget, 1, format.internalFormat, format.width,
+                           format.height);
+        }
+        glTexParameteri(format.textureTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(format.textureTarget, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(format.textureTarget, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(format.textureTarget, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glGenFramebuffers(layerCount, slot.framebuffers.data());
+        for (GLint layer = 0; layer < layerCount; ++layer) {
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, slot.framebuffers[layer]);
+            if (layerCount > 1) {
+                glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, slot.texture,
+                                          0, layer);
+            } else {
+                glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                                       slot.texture, 0);
+            }
+        }
+    }
+    glState.BindTexture(format.textureTarget, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    CHECK_GL_ERROR("Compositor slots");
+}
+
+void Compositor::GlTeardownSlots() {
+    for (Slot &slot: slots) {
+        glDeleteTextures(1, &slot.texture);
+        glDeleteFramebuffers(static_cast<GLsizei>(slot.framebuffers.size()),
+                             slot.framebuffers.data());
+        glDeleteSync(slot.copyFence);
+        glDeleteSync(slot.displayFence);
+    }
+    slots = {};
+    GetGLState().Reset();
+}
+
+void Compositor::Submit(const std::array<GLuint, 2> &framebuffers, GLsizei width, GLsizei height,
+                        const Frame &frame) {
+    // the slot neither shown nor ready; after a missed vsync it may hold an older ready frame
+    int slotIndex = 0;
+    GLsync displayFence;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (slotIndex == shownSlot || slotIndex == readySlot) {
+            ++slotIndex;
+        }
+        Slot &slot = slots[slotIndex];
+        displayFence = slot.displayFence;
+        slot.displayFence = nullptr;
+        glDeleteSync(slot.copyFence);
+        slot.copyFence = nullptr;
+    }
+
+    Slot &slot = slots[slotIndex];
+    if (displayFence != nullptr) {
+        glWaitSync(displayFence, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(displayFence);
+    }
+    const GLsizei layerCount = format.textureTarget == GL_TEXTURE_2D_ARRAY ? 2 : 1;
+    for (GLint layer = 0; layer < layerCount; ++layer) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffers[layer]);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, slot.framebuffers[layer]);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT,
+                          GL_NEAREST);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLsync copyFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    // the compositor context only sees the fence once it is flushed
+    glFlush();
+    CHECK_GL_ERROR("Compositor submit");
+
+    std::lock_guard<std::mutex> lock(mutex);
+    slot.copyFence = copyFence;
+    slot.frame = frame;
+    for (CardboardEyeTextureDescription &eye: slot.frame.eyes) {
+        eye.texture = slot.texture;
+    }
+    readySlot = slotIndex;
+}
+
+void Compositor::WaitForDisplay() {
+    std::unique_lock<std::mutex> lock(mutex);
+    frameTaken.wait_for(lock, DISPLAY_WAIT_TIMEOUT, [this] {
+        return readySlot < 0 || !running;
+    });
+}
+
+void Compositor::Run() {
+    // lowering the nice value may be refused, the compositor then just competes as usual
+    if (setpriority(PRIO_PROCESS, 0, COMPOSITOR_NICE) != 0) {
+        LOG_WARN("Cannot raise the compositor thread priority");
+    }
+    if (!eglMakeCurrent(display, surface, surface, context)) {
+        LOG_ERROR("Cannot make the compositor context current: 0x%x", eglGetError());
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+        failed = true;
+        frameTaken.notify_all();
+        return;
+    }
+    eglSwapInterval(display, 1);
+    distortionRenderer.GlSetup();
+    GLuint readFramebuffer = 0;
+    glGenFramebuffers(1, &readFramebuffer);
+
+    Frame frame{};
+    bool swapFailed = false;
+    while (true) {
+        int slotIndex;
+        GLsync copyFence = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running) {
+                break;
+            }
+            if (readySlot >= 0) {
+                shownSlot = readySlot;
+                readySlot = -1;
+                frame = slots[shownSlot].frame;
+                copyFence = slots[shownSlot].copyFence;
+                slots[shownSlot].copyFence = nullptr;
+                frameTaken.notify_all();
+            }
+            slotIndex = shownSlot;
+        }
+
+        if (copyFence != nullptr) {
+            glWaitSync(copyFence, 0, GL_TIMEOUT_IGNORED);
+            glDeleteSync(copyFence);
+        }
+        if (slotIndex >= 0) {
+            // a frame not replaced in time is shown again, reprojected to the newer pose
+            Composite(frame, readFramebuffer, slots[slotIndex].texture);
+            GLsync displayFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            std::lock_guard<std::mutex> lock(mutex);
+            glDeleteSync(slots[slotIndex].displayFence);
+            slots[slotIndex].displayFence = displayFence;
+        } else {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+        if (!eglSwapBuffers(display, surface)) {
+            LOG_ERROR("Compositor swap failed: 0x%x", eglGetError());
+            swapFailed = true;
+            break;
+        }
+    }
+
+    glDeleteFramebuffers(1, &readFramebuffer);
+    distortionRenderer.GlTeardown();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+        failed = swapFailed;
+        // the render thread must not wait for fences nobody flushes anymore
+        for (Slot &slot: slots) {
+            glDeleteSync(slot.displayFence);
+            slot.displayFence = nullptr;
+        }
+        frameTaken.notify_all();
+    }
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+void Compositor::Composite(const Frame &frame, GLuint readFramebuffer, GLuint texture) {
+    EGLint width = 0;
+    EGLint height = 0;
+    eglQuerySurface(display, surface, EGL_WIDTH, &width);
+    eglQuerySurface(display, surface, EGL_HEIGHT, &height);
+
+    if (!format.distort) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture,
+                               0);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, format.width, format.height, 0, 0, width, height,
+                          GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        CHECK_GL_ERROR("Compositor blit");
+        return;
+    }
+
+    glm::quat headOrientationQuat;
+    glm::vec3 headPosition;
+    CardboardHeadTracker_getPose(
+            headTracker,
+            static_cast<int64_t>(GetBootTimeNano() + PREDICTION_NANOS),
+            kLandscapeLeft,
+            glm::value_ptr(headPosition),
+            glm::value_ptr(headOrientationQuat)
+    );
+    const glm::mat3 reprojection =
+            glm::mat3(frame.viewMatrix) * glm::transpose(glm::toMat3(headOrientationQuat));
+    distortionRenderer.RenderEyeToDisplay(format.textureTarget, frame.multiResolution,
+                                          reprojection, 0, 0, 0, width, height,
+                                          frame.eyes[0], frame.eyes[1]);
+
+    // the Cardboard align line, from the bottom edge up to 40 % of the height
+    GLState &glState = GetGLState();
+    glState.SetEnabled(GL_SCISSOR_TEST, true);
+    glScissor(width / 2, 0, 1, height * 2 / 5);
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glState.SetEnabled(GL_SCISSOR_TEST, false);
+    CHECK_GL_ERROR("Compositor distortion");
+}
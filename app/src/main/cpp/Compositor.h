@@ -0,0 +1,142 @@
+#ifndef VR_VIDEO_PLAYER_COMPOSITOR_H
+#define VR_VIDEO_PLAYER_COMPOSITOR_H
+
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <EGL/egl.h>
+#include <GLES3/gl3.h>
+#include <android/native_window.h>
+
+#include <cardboard.h>
+
+#include "glm/mat4x4.hpp"
+
+#include "DistortionRenderer.h"
+#include "MultiResolution.h"
+
+/**
+ * Asynchronous timewarp: a high priority thread owning the window, which every vsync reprojects
+ * the most recently completed eye buffers to the latest head pose and shows them. The render
+ * thread submits eye buffers at whatever rate it manages, so a late frame shows the previous eye
+ * buffers at the current head rotation instead of a judder.
+ *
+ * Submitted eye buffers are copied into a ring of three textures shared with the context of the
+ * compositor: one shown, one ready and one being written.
+ */
+class Compositor {
+public:
+    /**
+     * Layout of the eye buffers: both eyes side by side in a GL_TEXTURE_2D or in the two layers of
+     * a GL_TEXTURE_2D_ARRAY for the lens distortion, or a single undistorted view of the window.
+     */
+    struct Format {
+        GLenum textureTarget;
+        // of the eye buffers, which the copies keep
+        GLenum internalFormat;
+        GLsizei width;
+        GLsizei height;
+        bool distort;
+    };
+
+    struct Frame {
+        // the texture names are filled in by Submit
+        std::array<CardboardEyeTextureDescription, 2> eyes;
+        MultiResolution multiResolution;
+        // the head pose the eye buffers were rendered at
+        glm::mat4 viewMatrix;
+    };
+
+    Compositor();
+
+    ~Compositor();
+
+    /**
+     * Whether the thread is compositing; false once it stopped on an error, until restarted.
+     */
+    bool IsRunning() const;
+
+    /**
+     * Whether the thread stopped on an EGL error rather than by Stop.
+     */
+    bool HasFailed() const;
+
+    /**
+     * Sets the distortion of the eye (0 = left, 1 = right) while the compositor is stopped.
+     */
+    void SetLens(int eye, const CardboardMesh &mesh, const std::array<float, 4> &fieldOfView);
+
+    /**
+     * Starts compositing into the window, in a context sharing the objects of the one current on
+     * the calling thread. Submit must then be called with that context current.
+     */
+    bool Start(ANativeWindow *window, CardboardHeadTracker *headTracker, const Format &format);
+
+    /**
+     * Stops the thread and releases its context and window surface; the eye buffer copies are
+     * deleted by the next Start.
+     */
+    void Stop();
+
+    /**
+     * Forgets the objects of a lost context without deleting them.
+     */
+    void GlReset();
+
+    /**
+     * Copies the eye buffers from the framebuffers (one per texture array layer, else just the
+     * first one), width x height of each, and makes them the next frame to be shown.
+     */
+    void Submit(const std::array<GLuint, 2> &framebuffers, GLsizei width, GLsizei height,
+                const Frame &frame);
+
+    /**
+     * Waits until the compositor picks up the last submitted frame, so the render thread does not
+     * run ahead of the display; gives up after a timeout.
+     */
+    void WaitForDisplay();
+
+private:
+    static constexpr int SLOT_COUNT = 3;
+
+    struct Slot {
+        GLuint texture;
+        // per texture array layer
+        std::array<GLuint, 2> framebuffers;
+        // signaled when the copy of the eye buffers is done
+        GLsync copyFence;
+        // signaled when the compositor is done reading the texture
+        GLsync displayFence;
+        Frame frame;
+    };
+
+    std::array<Slot, SLOT_COUNT> slots;
+    Format format;
+    CardboardHeadTracker *headTracker;
+    DistortionRenderer distortionRenderer;
+
+    EGLDisplay display;
+    EGLContext context;
+    EGLSurface surface;
+    std::thread thread;
+
+    // guards the slot indices and the fences and frames of the slots changing hands
+    mutable std::mutex mutex;
+    std::condition_variable frameTaken;
+    bool running;
+    bool failed;
+    int shownSlot;
+    int readySlot;
+
+    void GlSetupSlots();
+
+    void GlTeardownSlots();
+
+    void Run();
+
+    void Composite(const Frame &frame, GLuint readFramebuffer, GLuint texture);
+};
+
+#endif //VR_VIDEO_PLAYER_COMPOSITOR_H
@@ -0,0 +1,196 @@
+#include "DisplayTiming.h"
+
+#include <dlfcn.h>
+
+#include <android/choreographer.h>
+
+#include "GLExtensions.h"
+#include "GLUtils.h"
+#include "logger.h"
+
+#define LOG_TAG "VRVideoPlayerV"
+
+using PostFrameCallback64Proc = void (*)(AChoreographer *, void (*)(int64_t, void *), void *);
+
+DisplayTiming::DisplayTiming() :
+        model{},
+        looper(nullptr),
+        running(false),
+        display(EGL_NO_DISPLAY),
+        surface(EGL_NO_SURFACE),
+        getNextFrameId(nullptr),
+        getFrameTimestamps(nullptr),
+        pendingFrames{},
+        firstPending(0),
+        pendingCount(0) {
+}
+
+DisplayTiming::~DisplayTiming() {
+    Stop();
+}
+
+void DisplayTiming::Start() {
+    if (thread.joinable()) {
+        return;
+    }
+
+    running = true;
+    thread = std::thread(&DisplayTiming::Run, this);
+}
+
+void DisplayTiming::Stop() {
+    if (!thread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+        if (looper != nullptr) {
+            ALooper_wake(looper);
+        }
+    }
+    thread.join();
+}
+
+void DisplayTiming::Run() {
+    // the Choreographer delivers its callbacks on the looper of the thread that asked for them
+    ALooper *threadLooper = ALooper_prepare(0);
+    ALooper_acquire(threadLooper);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        looper = threadLooper;
+    }
+
+    PostFrameCallback();
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running) {
+                looper = nullptr;
+                break;
+            }
+        }
+        ALooper_pollOnce(-1, nullptr, nullptr, nullptr);
+    }
+    ALooper_release(threadLooper);
+}
+
+void DisplayTiming::PostFrameCallback() {
+    // the 64-bit variant is only available since API 29
+    static const auto postFrameCallback64 = reinterpret_cast<PostFrameCallback64Proc>(
+            dlsym(RTLD_DEFAULT, "AChoreographer_postFrameCallback64"));
+
+    AChoreographer *choreographer = AChoreographer_getInstance();
+    if (postFrameCallback64 != nullptr) {
+        postFrameCallback64(choreographer, OnVsync, this);
+    } else {
+        AChoreographer_postFrameCallback(choreographer, OnVsyncLong, this);
+    }
+}
+
+void DisplayTiming::OnVsync(int64_t frameTimeNanos, void *data) {
+    auto *timing = static_cast<DisplayTiming *>(data);
+    {
+        std::lock_guard<std::mutex> lock(timing->mutex);
+        if (!timing->running) {
+            return;
+        }
+        timing->model.OnVsync(static_cast<uint64_t>(frameTimeNanos));
+    }
+    timing->PostFrameCallback();
+}
+
+void DisplayTiming::OnVsyncLong(long frameTimeNanos, void *data) {
+    // a 32-bit long overflows every few seconds, the callback time is then the best estimate
+    OnVsync(sizeof(long) < sizeof(int64_t) ? static_cast<int64_t>(GetMonotonicTimeNano())
+                                           : static_cast<int64_t>(frameTimeNanos), data);
+}
+
+uint64_t DisplayTiming::BeginFrame() {
+    if (eglGetCurrentSurface(EGL_DRAW) != surface) {
+        EnableTimestamps();
+    }
+    if (getFrameTimestamps != nullptr) {
+        CollectPresentTimes();
+    }
+
+    const uint64_t nowNanos = GetMonotonicTimeNano();
+    uint64_t predictedNanos;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        predictedNanos = model.PredictDisplayTime(nowNanos);
+    }
+
+    // the frame swapped after this one is drawn
+    EGLuint64KHR frameId = 0;
+    if (getNextFrameId != nullptr && getNextFrameId(display, surface, &frameId)) {
+        if (pendingCount == MAX_PENDING_FRAMES) {
+            firstPending = (firstPending + 1) % MAX_PENDING_FRAMES;
+            --pendingCount;
+        }
+        pendingFrames[(firstPending + pendingCount) % MAX_PENDING_FRAMES] =
+                {frameId, nowNanos, predictedNanos};
+        ++pendingCount;
+    }
+
+    return GetBootTimeNano() + (predictedNanos - nowNanos);
+}
+
+FrameTimingModel DisplayTiming::GetModel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return model;
+}
+
+uint64_t DisplayTiming::GetVsyncPeriodNanos() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return model.GetVsyncPeriodNanos();
+}
+
+void DisplayTiming::EnableTimestamps() {
+    display = eglGetCurrentDisplay();
+    surface = eglGetCurrentSurface(EGL_DRAW);
+    getNextFrameId = nullptr;
+    getFrameTimestamps = nullptr;
+    firstPending = 0;
+    pendingCount = 0;
+    if (surface == EGL_NO_SURFACE ||
+        !HasEGLExtension(display, "EGL_ANDROID_get_frame_timestamps")) {
+        return;
+    }
+
+    // pbuffers, such as the offscreen surface of asynchronous timewarp, are never presented
+    const auto timestampSupported = reinterpret_cast<PFNEGLGETFRAMETIMESTAMPSUPPORTEDANDROIDPROC>(
+            eglGetProcAddress("eglGetFrameTimestampSupportedANDROID"));
+    if (timestampSupported == nullptr ||
+        !timestampSupported(display, surface, EGL_DISPLAY_PRESENT_TIME_ANDROID) ||
+        !eglSurfaceAttrib(display, surface, EGL_TIMESTAMPS_ANDROID, EGL_TRUE)) {
+        LOG_DEBUG("Present times not available");
+        return;
+    }
+    getNextFrameId = reinterpret_cast<PFNEGLGETNEXTFRAMEIDANDROIDPROC>(
+            eglGetProcAddress("eglGetNextFrameIdANDROID"));
+    getFrameTimestamps = reinterpret_cast<PFNEGLGETFRAMETIMESTAMPSANDROIDPROC>(
+            eglGetProcAddress("eglGetFrameTimestampsANDROID"));
+    LOG_DEBUG("Present times enabled");
+}
+
+void DisplayTiming::CollectPresentTimes() {
+    while (pendingCount > 0) {
+        const PendingFrame &frame = pendingFrames[firstPending];
+        const EGLint name = EGL_DISPLAY_PRESENT_TIME_ANDROID;
+        EGLnsecsANDROID presentNanos = EGL_TIMESTAMP_INVALID_ANDROID;
+        if (getFrameTimestamps(display, surface, frame.id, 1, &name, &presentNanos) &&
+            presentNanos == EGL_TIMESTAMP_PENDING_ANDROID) {
+            // the later frames are not presented either
+            break;
+        }
+        if (presentNanos >= 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            model.OnFramePresented(frame.startNanos, frame.predictedNanos,
+                                   static_cast<uint64_t>(presentNanos));
+        }
+        firstPending = (firstPending + 1) % MAX_PENDING_FRAMES;
+        --pendingCount;
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef VR_VIDEO_PLAYER_DISPLAYTIMING_H
+#define VR_VIDEO_PLAYER_DISPLAYTIMING_H
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <android/looper.h>
+
+#include "FrameTimingModel.h"
+
+/**
+ * Feeds a FrameTimingModel with the display vsyncs, from a Choreographer on its own looper
+ * thread, and with the present times of the frames drawn into the current window surface, where
+ * EGL_ANDROID_get_frame_timestamps is supported.
+ */
+class DisplayTiming {
+public:
+    DisplayTiming();
+
+    ~DisplayTiming();
+
+    /**
+     * Starts receiving vsyncs; they are not needed while paused.
+     */
+    void Start();
+
+    void Stop();
+
+    /**
+     * Called on the GL thread at the start of every frame; returns when the frame will be
+     * displayed, on the boot time clock of the head tracker.
+     */
+    uint64_t BeginFrame();
+
+    /**
+     * A copy of the model, for its metrics; callable on any thread.
+     */
+    FrameTimingModel GetModel();
+
+    /**
+     * The measured vsync period, or 0 before there are enough vsyncs.
+     */
+    uint64_t GetVsyncPeriodNanos();
+
+private:
+    static constexpr int MAX_PENDING_FRAMES = 8;
+
+    struct PendingFrame {
+        EGLuint64KHR id;
+        uint64_t startNanos;
+        uint64_t predictedNanos;
+    };
+
+    std::mutex mutex;
+    FrameTimingModel model;
+    std::thread thread;
+    ALooper *looper;
+    bool running;
+
+    // the surface the present times are queried for, the current one when they were enabled
+    EGLDisplay display;
+    EGLSurface surface;
+    PFNEGLGETNEXTFRAMEIDANDROIDPROC getNextFrameId;
+    PFNEGLGETFRAMETIMESTAMPSANDROIDPROC getFrameTimestamps;
+    std::array<PendingFrame, MAX_PENDING_FRAMES> pendingFrames;
+    int firstPending;
+    int pendingCount;
+
+    void Run();
+
+    void PostFrameCallback();
+
+    static void OnVsync(int64_t frameTimeNanos, void *data);
+
+    static void OnVsyncLong(long frameTimeNanos, void *data);
+
+    void EnableTimestamps();
+
+    void CollectPresentTimes();
+};
+
+#endif //VR_VIDEO_PLAYER_DISPLAYTIMING_H
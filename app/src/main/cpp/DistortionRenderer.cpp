@@ -0,0 +1,177 @@
+#include "DistortionRenderer.h"
+
+#include <cmath>
+#include <string>
+
+#include "glm/gtc/type_ptr.hpp"
+
+#include "GLState.h"
+#include "GLUtils.h"
+
+// The reprojection is evaluated per vertex, the distortion mesh is dense enough for the small
+// rotations of a single frame.
+constexpr const char *kDistortionVertexShader = R"glsl(#version 300 es
+uniform mat3 u_Reprojection;
+// left and bottom tangents of the eye view, then its size in tangents
+uniform vec4 u_Tangents;
+in vec2 a_Position;
+in vec2 a_UV;
+out vec2 v_UV;
+
+void main() {
+  vec3 direction = u_Reprojection * vec3(a_UV * u_Tangents.zw - u_Tangents.xy, -1.0);
+  v_UV = (direction.xy / -direction.z + u_Tangents.xy) / u_Tangents.zw;
+  gl_Position = vec4(a_Position, 0.0, 1.0);
+})glsl";
+
+// The eye view is unpacked per fragment, the multi-resolution regions are not aligned with the
+// distortion mesh.
+constexpr const char *kDistortionFragmentShader = R"glsl(#version 300 es
+precision mediump float;
+
+#ifdef TEXTURE_ARRAY
+precision mediump sampler2DArray;
+uniform sampler2DArray u_Texture;
+uniform float u_Layer;
+#define SAMPLE_EYE(uv) texture(u_Texture, vec3(uv, u_Layer))
+#else
+uniform sampler2D u_Texture;
+#define SAMPLE_EYE(uv) texture(u_Texture, uv)
+#endif
+
+// left, bottom, right, top of the packed eye view in the texture
+uniform vec4 u_UVRect;
+// the full density region of the view, and the density of the rest
+uniform vec4 u_CenterBounds;
+uniform vec2 u_PeripheryDensity;
+in vec2 v_UV;
+out vec4 fragColor;
+
+void main() {
+  vec2 low = u_CenterBounds.xy;
+  vec2 high = u_CenterBounds.zw;
+  vec2 packedUV = u_PeripheryDensity * (min(v_UV, low) + max(v_UV - high, 0.0)) +
+                  clamp(v_UV, low, high) - low;
+  vec2 packedSize = u_PeripheryDensity * (low + 1.0 - high) + high - low;
+  fragColor = SAMPLE_EYE(mix(u_UVRect.xy, u_UVRect.zw, packedUV / packedSize));
+})glsl";
+
+DistortionRenderer::DistortionRenderer() :
+        meshes{},
+        eyeTangents{glm::vec4(1.0f, 1.0f, 2.0f, 2.0f), glm::vec4(1.0f, 1.0f, 2.0f, 2.0f)},
+        texture2DProgram{},
+        textureArrayProgram{},
+        programCache() {
+}
+
+GLuint DistortionRenderer::StartProgram(const char *definitions) {
+    const std::string fragmentSource = kDistortionFragmentShader;
+    const std::size_t lineEnd = fragmentSource.find('\n') + 1;
+    return programCache.Start(
+            kDistortionVertexShader,
+            fragmentSource.substr(0, lineEnd) + definitions + fragmentSource.substr(lineEnd));
+}
+
+DistortionRenderer::Program DistortionRenderer::FinishProgram(GLuint program) {
+    Program result{};
+    result.program = program;
+    if (!programCache.Finish(result.program)) {
+        return result;
+    }
+    GetGLState().UseProgram(result.program);
+    CHECK_GL_ERROR("Distortion program");
+
+    result.paramPosition = glGetAttribLocation(result.program, "a_Position");
+    result.paramUV = glGetAttribLocation(result.program, "a_UV");
+    result.paramUVRect = glGetUniformLocation(result.program, "u_UVRect");
+    result.paramLayer = glGetUniformLocation(result.program, "u_Layer");
+    result.paramCenterBounds = glGetUniformLocation(result.program, "u_CenterBounds");
+    result.paramPeripheryDensity = glGetUniformLocation(result.program, "u_PeripheryDensity");
+    result.paramReprojection = glGetUniformLocation(result.program, "u_Reprojection");
+    result.paramTangents = glGetUniformLocation(result.program, "u_Tangents");
+    glUniform1i(glGetUniformLocation(result.program, "u_Texture"), 0);
+    CHECK_GL_ERROR("Distortion program params");
+    return result;
+}
+
+void DistortionRenderer::GlSetup() {
+    programCache.GlSetup();
+    const GLuint texture2D = StartProgram("");
+    const GLuint textureArray = StartProgram("#define TEXTURE_ARRAY 1\n");
+    texture2DProgram = FinishProgram(texture2D);
+    textureArrayProgram = FinishProgram(textureArray);
+}
+
+void DistortionRenderer::GlTeardown() {
+    glDeleteProgram(texture2DProgram.program);
+    texture2DProgram = {};
+    glDeleteProgram(textureArrayProgram.program);
+    textureArrayProgram = {};
+    GetGLState().Reset();
+}
+
+void DistortionRenderer::SetMesh(int eye, const CardboardMesh &mesh) {
+    Mesh &target = meshes[eye];
+    target.vertices.assign(mesh.vertices, mesh.vertices + 2 * mesh.n_vertices);
+    target.uvs.assign(mesh.uvs, mesh.uvs + 2 * mesh.n_vertices);
+    target.indices.assign(mesh.indices, mesh.indices + mesh.n_indices);
+}
+
+void DistortionRenderer::SetFieldOfView(int eye, const std::array<float, 4> &fieldOfView) {
+    const float left = std::tan(fieldOfView[0]);
+    const float bottom = std::tan(fieldOfView[2]);
+    eyeTangents[eye] = {left, bottom, left + std::tan(fieldOfView[1]),
+                        bottom + std::tan(fieldOfView[3])};
+}
+
+void DistortionRenderer::RenderEyeToDisplay(GLenum textureTarget,
+                                            const MultiResolution &multiResolution,
+                                            const glm::mat3 &reprojection,
+                                            GLuint target, int x, int y, int width, int height,
+                                            const CardboardEyeTextureDescription &leftEye,
+                                            const CardboardEyeTextureDescription &rightEye) const {
+    GLState &glState = GetGLState();
+    glBindFramebuffer(GL_FRAMEBUFFER, target);
+    glState.SetEnabled(GL_BLEND, false);
+    glState.SetEnabled(GL_CULL_FACE, false);
+    glState.SetEnabled(GL_STENCIL_TEST, false);
+    glState.SetEnabled(GL_SCISSOR_TEST, false);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    const Program &program =
+            textureTarget == GL_TEXTURE_2D_ARRAY ? textureArrayProgram : texture2DProgram;
+    glState.UseProgram(program.program);
+    glState.ActiveTexture(GL_TEXTURE0);
+    glState.BindVertexArray(0);
+    glState.EnableVertexAttribArray(program.paramPosition);
+    glState.EnableVertexAttribArray(program.paramUV);
+    const glm::vec4 &centerBounds = multiResolution.GetCenterBounds();
+    const glm::vec2 &peripheryDensity = multiResolution.GetPeripheryDensity();
+    glUniform4f(program.paramCenterBounds, centerBounds.x, centerBounds.y, centerBounds.z,
+                centerBounds.w);
+    glUniform2f(program.paramPeripheryDensity, peripheryDensity.x, peripheryDensity.y);
+    glUniformMatrix3fv(program.paramReprojection, 1, GL_FALSE, glm::value_ptr(reprojection));
+
+    const std::array<const CardboardEyeTextureDescription *, 2> eyes{&leftEye, &rightEye};
+    for (int eye = 0; eye < 2; ++eye) {
+        const Mesh &mesh = meshes[eye];
+        const CardboardEyeTextureDescription &description = *eyes[eye];
+
+        glState.Viewport(x + eye * width / 2, y, width / 2, height);
+        glState.BindTexture(textureTarget, static_cast<GLuint>(description.texture));
+        glUniform4f(program.paramUVRect, description.left_u, description.bottom_v,
+                    description.right_u, description.top_v);
+        glUniform1f(program.paramLayer, float(eye));
+        glUniform4fv(program.paramTangents, 1, glm::value_ptr(eyeTangents[eye]));
+
+        glVertexAttribPointer(program.paramPosition, 2, GL_FLOAT, GL_FALSE, 0,
+                              mesh.vertices.data());
+        glVertexAttribPointer(program.paramUV, 2, GL_FLOAT, GL_FALSE, 0, mesh.uvs.data());
+        glDrawElements(GL_TRIANGLE_STRIP, static_cast<GLsizei>(mesh.indices.size()),
+                       GL_UNSIGNED_SHORT, mesh.indices.data());
+    }
+
+    glState.DisableVertexAttribArray(program.paramUV);
+    CHECK_GL_ERROR("Distortion");
+}
@@ -0,0 +1,88 @@
+#ifndef VR_VIDEO_PLAYER_DISTORTIONRENDERER_H
+#define VR_VIDEO_PLAYER_DISTORTIONRENDERER_H
+
+#include <array>
+#include <vector>
+
+#include <GLES3/gl3.h>
+
+#include <cardboard.h>
+
+#include "glm/mat3x3.hpp"
+#include "glm/vec4.hpp"
+
+#include "MultiResolution.h"
+#include "ProgramCache.h"
+
+/**
+ * Lens distortion pass drawing the Cardboard distortion meshes, which also reads eye buffers the
+ * Cardboard distortion renderer cannot: the two layers of a texture array, or views packed by
+ * multi-resolution shading. The eye texture descriptions address the packed eye views, in the
+ * layer of their eye for texture arrays.
+ *
+ * The eye buffers are reprojected to the latest head rotation on the way, so the pose can be
+ * latched right before the pass instead of at the start of the frame.
+ */
+class DistortionRenderer {
+public:
+    DistortionRenderer();
+
+    void GlSetup();
+
+    void GlTeardown();
+
+    /**
+     * Copies the distortion mesh of the eye (0 = left, 1 = right).
+     */
+    void SetMesh(int eye, const CardboardMesh &mesh);
+
+    /**
+     * Sets the field of view the eye buffer of the eye covers, as the left, right, bottom and top
+     * half-angles.
+     */
+    void SetFieldOfView(int eye, const std::array<float, 4> &fieldOfView);
+
+    /**
+     * Renders eye buffers of the textureTarget type (GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY), with
+     * their views packed by multiResolution. The reprojection rotates view directions at display
+     * time into the head orientation the eye buffers were rendered with.
+     */
+    void RenderEyeToDisplay(GLenum textureTarget, const MultiResolution &multiResolution,
+                            const glm::mat3 &reprojection,
+                            GLuint target, int x, int y, int width, int height,
+                            const CardboardEyeTextureDescription &leftEye,
+                            const CardboardEyeTextureDescription &rightEye) const;
+
+private:
+    struct Program {
+        GLuint program;
+        GLint paramPosition;
+        GLint paramUV;
+        GLint paramUVRect;
+        GLint paramLayer;
+        GLint paramCenterBounds;
+        GLint paramPeripheryDensity;
+        GLint paramReprojection;
+        GLint paramTangents;
+    };
+
+    struct Mesh {
+        std::vector<GLfloat> vertices;
+        std::vector<GLfloat> uvs;
+        std::vector<GLushort> indices;
+    };
+
+    std::array<Mesh, 2> meshes;
+    // left and bottom tangents of the field of view, then its width and height in tangents
+    std::array<glm::vec4, 2> eyeTangents;
+    Program texture2DProgram;
+    Program textureArrayProgram;
+
+    ProgramCache programCache;
+
+    GLuint StartProgram(const char *definitions);
+
+    Program FinishProgram(GLuint program);
+};
+
+#endif //VR_VIDEO_PLAYER_DISTORTIONRENDERER_H
@@ -0,0 +1,73 @@
+#include "DynamicResolution.h"
+
+#include <cmath>
+
+#include "glm/common.hpp"
+
+#include "logger.h"
+
+#define LOG_TAG "VRVideoPlayerD"
+
+static constexpr float MIN_SCALE = 0.5f;
+static constexpr float MAX_SCALE = 1.0f;
+static constexpr float SCALE_STEP_DOWN = 0.1f;
+static constexpr float SCALE_STEP_UP = 0.05f;
+// weight of the newest frame in the smoothed frame time
+static constexpr float SMOOTHING = 0.2f;
+// grow only below this fraction of the target, and only after this many frames in a row
+static constexpr float GROW_THRESHOLD = 0.75f;
+static constexpr int GROW_FRAMES = 60;
+// the measured display period jitters, only a new refresh rate moves the target
+static constexpr float TARGET_TOLERANCE = 0.02f;
+
+DynamicResolution::DynamicResolution(uint64_t targetFrameNanos) :
+        targetFrameNanos(targetFrameNanos),
+        scale(MAX_SCALE),
+        smoothedFrameNanos(0.0f),
+        framesUnderBudget(0) {
+}
+
+void DynamicResolution::Reset() {
+    scale = MAX_SCALE;
+    smoothedFrameNanos = 0.0f;
+    framesUnderBudget = 0;
+}
+
+void DynamicResolution::SetTargetFrameNanos(uint64_t newTargetFrameNanos) {
+    const float change = std::abs(float(newTargetFrameNanos) - float(targetFrameNanos));
+    if (change <= TARGET_TOLERANCE * float(targetFrameNanos)) {
+        return;
+    }
+    LOG_DEBUG("Frame time target %.2f ms", float(newTargetFrameNanos) * 1e-6f);
+    targetFrameNanos = newTargetFrameNanos;
+    framesUnderBudget = 0;
+}
+
+bool DynamicResolution::Update(uint64_t frameTimeNanos) {
+    smoothedFrameNanos = smoothedFrameNanos == 0.0f
+                         ? float(frameTimeNanos)
+                         : glm::mix(smoothedFrameNanos, float(frameTimeNanos), SMOOTHING);
+
+    const float previousScale = scale;
+    const float target = float(targetFrameNanos);
+    if (smoothedFrameNanos > target) {
+        // the pixel count, and roughly the frame time, goes with the square of the scale
+        framesUnderBudget = 0;
+        scale = glm::max(MIN_SCALE, scale - SCALE_STEP_DOWN);
+        // give the new scale time to show in the measurements before dropping again
+        smoothedFrameNanos *= (scale * scale) / (previousScale * previousScale);
+    } else if (smoothedFrameNanos < GROW_THRESHOLD * target) {
+        if (++framesUnderBudget >= GROW_FRAMES) {
+            framesUnderBudget = 0;
+            scale = glm::min(MAX_SCALE, scale + SCALE_STEP_UP);
+        }
+    } else {
+        framesUnderBudget = 0;
+    }
+
+    if (scale != previousScale) {
+        LOG_DEBUG("Frame time %.2f ms, eye buffer scale %.2f", smoothedFrameNanos * 1e-6f, scale);
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,38 @@
+#ifndef VR_VIDEO_PLAYER_DYNAMICRESOLUTION_H
+#define VR_VIDEO_PLAYER_DYNAMICRESOLUTION_H
+
+#include <cstdint>
+
+/**
+ * Adjusts the fraction of the eye buffer rendered into, to keep the measured frame time below
+ * the target. The scale drops as soon as the smoothed frame time exceeds the target, but grows
+ * back only after a run of frames well below it, so it does not oscillate around the limit.
+ */
+class DynamicResolution {
+public:
+    explicit DynamicResolution(uint64_t targetFrameNanos);
+
+    /**
+     * Feeds one measured frame time; returns true if the scale changed.
+     */
+    bool Update(uint64_t frameTimeNanos);
+
+    void Reset();
+
+    /**
+     * Follows the display refresh rate; the scale adapts to the new target with the next frames.
+     */
+    void SetTargetFrameNanos(uint64_t newTargetFrameNanos);
+
+    float GetScale() const {
+        return scale;
+    }
+
+private:
+    uint64_t targetFrameNanos;
+    float scale;
+    float smoothedFrameNanos;
+    int framesUnderBudget;
+};
+
+#endif //VR_VIDEO_PLAYER_DYNAMICRESOLUTION_H
@@ -0,0 +1,86 @@
+#include "Foveation.h"
+
+#include <cmath>
+
+#include <GLES2/gl2ext.h>
+#include <GLES3/gl3.h>
+
+#include "GLExtensions.h"
+#include "GLUtils.h"
+#include "logger.h"
+
+#define LOG_TAG "VRVideoPlayerF"
+
+// full density everywhere until a lens sets the profile
+Foveation::Foveation()
+        : profile{0.0f, 0.0f, 1.0f},
+          lensCenters{},
+          tangentSpans{glm::vec2(2.0f), glm::vec2(2.0f)},
+          texture(0),
+          layered(false) {
+}
+
+void Foveation::SetProfile(const FoveationProfile &newProfile) {
+    profile = newProfile;
+}
+
+void Foveation::SetLens(int eye, const std::array<float, 4> &fieldOfView) {
+    const glm::vec2 tangentsLow{std::tan(fieldOfView[0]), std::tan(fieldOfView[2])};
+    const glm::vec2 tangentsHigh{std::tan(fieldOfView[1]), std::tan(fieldOfView[3])};
+    tangentSpans[eye] = tangentsLow + tangentsHigh;
+    // the optical axis is where the view tangent is zero
+    lensCenters[eye] = (tangentsLow - tangentsHigh) / tangentSpans[eye];
+}
+
+bool Foveation::GlSetup(GLenum target, GLuint newTexture, bool newLayered) {
+    texture = 0;
+    if (!GetGLExtensions().textureFoveated) {
+        return false;
+    }
+
+    // side by side eyes need a focal point each within the single layer
+    GLint features = 0;
+    GLint focalPoints = 0;
+    glGetTexParameteriv(target, GL_TEXTURE_FOVEATED_FEATURE_QUERY_QCOM, &features);
+    glGetTexParameteriv(target, GL_TEXTURE_FOVEATED_NUM_FOCAL_POINTS_QUERY_QCOM, &focalPoints);
+    if ((features & GL_FOVEATION_ENABLE_BIT_QCOM) == 0 || focalPoints < (newLayered ? 1 : 2)) {
+        LOG_DEBUG("Foveation not available (features %x, %d focal points)", features, focalPoints);
+        return false;
+    }
+
+    glTexParameteri(target, GL_TEXTURE_FOVEATED_FEATURE_BITS_QCOM,
+                    GL_FOVEATION_ENABLE_BIT_QCOM |
+                    (features & GL_FOVEATION_SCALED_BIN_METHOD_BIT_QCOM));
+    glTexParameterf(target, GL_TEXTURE_FOVEATED_MIN_PIXEL_DENSITY_QCOM, profile.minDensity);
+    CHECK_GL_ERROR("Foveation setup");
+
+    texture = newTexture;
+    layered = newLayered;
+    return true;
+}
+
+void Foveation::GlTeardown() {
+    texture = 0;
+}
+
+void Foveation::Update(GLsizei eyeWidth, GLsizei eyeHeight, GLsizei bufferWidth,
+                       GLsizei bufferHeight) const {
+    if (texture == 0) {
+        return;
+    }
+
+    const glm::vec2 textureSize{float(layered ? bufferWidth : 2 * bufferWidth),
+                                float(bufferHeight)};
+    const glm::vec2 eyeSize{float(eyeWidth), float(eyeHeight)};
+    for (int eye = 0; eye < 2; ++eye) {
+        const float eyeOffset = layered ? 0.0f : float(eye * bufferWidth);
+        const glm::vec2 focalPixel = glm::vec2(eyeOffset, 0.0f) +
+                                     0.5f * (lensCenters[eye] + 1.0f) * eyeSize;
+        const glm::vec2 focal = 2.0f * focalPixel / textureSize - 1.0f;
+        // the profile gain is per view tangent, the parameters take it per texture NDC
+        const glm::vec2 gain = profile.gain * tangentSpans[eye] * textureSize / (2.0f * eyeSize);
+        GetGLExtensions().glTextureFoveationParametersQCOM(
+                texture, layered ? eye : 0, layered ? 0 : eye, focal.x, focal.y, gain.x, gain.y,
+                profile.foveaArea);
+    }
+}
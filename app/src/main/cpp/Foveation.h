@@ -0,0 +1,63 @@
+#ifndef VR_VIDEO_PLAYER_FOVEATION_H
+#define VR_VIDEO_PLAYER_FOVEATION_H
+
+#include <array>
+
+#include <GLES2/gl2.h>
+
+#include "glm/vec2.hpp"
+
+/**
+ * Falloff of the shading density away from the lens center, in view tangent units so that it does
+ * not depend on the eye buffer size: the density is 1 / (|gain * tangentOffset|^2 - foveaArea),
+ * clamped to [minDensity, 1].
+ */
+struct FoveationProfile {
+    float gain;
+    float foveaArea;
+    float minDensity;
+};
+
+/**
+ * Fixed foveated rendering of the stereo eye buffer through QCOM_texture_foveated, with a focal
+ * point on the optical axis of each lens.
+ */
+class Foveation {
+public:
+    Foveation();
+
+    /**
+     * Sets the density profile, applied to the eye buffer texture by the next GlSetup.
+     */
+    void SetProfile(const FoveationProfile &newProfile);
+
+    /**
+     * Sets the field of view of the eye, as the left, right, bottom and top half-angles.
+     */
+    void SetLens(int eye, const std::array<float, 4> &fieldOfView);
+
+    /**
+     * Enables foveation on the bound, newly allocated eye buffer texture, which holds the eyes side
+     * by side or in its first two layers. Returns false if the driver cannot foveate it.
+     */
+    bool GlSetup(GLenum target, GLuint texture, bool layered);
+
+    void GlTeardown();
+
+    /**
+     * Places the focal points into the eyeWidth x eyeHeight part of each eye buffer rendered into
+     * this frame.
+     */
+    void Update(GLsizei eyeWidth, GLsizei eyeHeight, GLsizei bufferWidth,
+                GLsizei bufferHeight) const;
+
+private:
+    FoveationProfile profile;
+    // in normalized device coordinates of the eye viewport
+    std::array<glm::vec2, 2> lensCenters;
+    std::array<glm::vec2, 2> tangentSpans;
+    GLuint texture;
+    bool layered;
+};
+
+#endif //VR_VIDEO_PLAYER_FOVEATION_H
@@ -0,0 +1,38 @@
+#include "FrameScheduler.h"
+
+#include <cmath>
+
+#include <algorithm>
+
+FrameScheduler::FrameScheduler(float poseThresholdRadians) :
+        poseThresholdRadians(poseThresholdRadians),
+        invalidated(true),
+        animating(false),
+        drawnOrientation(1.0f, 0.0f, 0.0f, 0.0f) {
+}
+
+void FrameScheduler::Invalidate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    invalidated = true;
+}
+
+void FrameScheduler::OnFrameDrawn(const glm::quat &orientation, bool frameAnimating) {
+    std::lock_guard<std::mutex> lock(mutex);
+    drawnOrientation = orientation;
+    animating = frameAnimating;
+}
+
+bool FrameScheduler::NeedsRedraw(const glm::quat *orientation) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (invalidated || animating) {
+        invalidated = false;
+        return true;
+    }
+    if (orientation == nullptr) {
+        return false;
+    }
+
+    // the rotation angle between the orientations, q and -q being the same one
+    const float cosHalfAngle = std::min(std::abs(glm::dot(*orientation, drawnOrientation)), 1.0f);
+    return 2.0f * std::acos(cosHalfAngle) > poseThresholdRadians;
+}
@@ -0,0 +1,42 @@
+#ifndef VR_VIDEO_PLAYER_FRAMESCHEDULER_H
+#define VR_VIDEO_PLAYER_FRAMESCHEDULER_H
+
+#include <mutex>
+
+#include "glm/gtc/quaternion.hpp"
+
+/**
+ * Decides on every vsync whether a new frame is needed, so nothing is drawn while neither the
+ * picture nor the view changes. New video frames request their own redraws; this covers the
+ * head pose, animations and option changes.
+ */
+class FrameScheduler {
+public:
+    explicit FrameScheduler(float poseThresholdRadians);
+
+    /**
+     * Requests a frame for a change of the options or of the surface; from any thread.
+     */
+    void Invalidate();
+
+    /**
+     * Records the head orientation a frame was drawn with and whether it shows anything animated.
+     */
+    void OnFrameDrawn(const glm::quat &orientation, bool animating);
+
+    /**
+     * Returns whether to draw a frame, given the current head orientation, null in modes not
+     * following the head.
+     */
+    bool NeedsRedraw(const glm::quat *orientation);
+
+private:
+    const float poseThresholdRadians;
+
+    std::mutex mutex;
+    bool invalidated;
+    bool animating;
+    glm::quat drawnOrientation;
+};
+
+#endif //VR_VIDEO_PLAYER_FRAMESCHEDULER_H
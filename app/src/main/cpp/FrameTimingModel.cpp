@@ -0,0 +1,83 @@
+#include "FrameTimingModel.h"
+
+#include <cmath>
+
+#include <algorithm>
+
+#include "glm/common.hpp"
+
+// until the first vsync period is known
+static constexpr uint64_t DEFAULT_LATENCY_NANOS = 50'000'000UL;
+// queued by the swap, latched by the compositor on the next vsync and shown on the one after
+static constexpr float DEFAULT_PIPELINE_DEPTH = 1.0f;
+static constexpr float MAX_PIPELINE_DEPTH = 4.0f;
+// longer gaps between vsync timestamps are pauses rather than skipped callbacks
+static constexpr uint64_t MAX_VSYNC_GAP_NANOS = 200'000'000UL;
+static constexpr float MIN_PERIOD_NANOS = 4'000'000.0f;
+// weight of the newest sample in the smoothed values
+static constexpr float PERIOD_SMOOTHING = 0.05f;
+static constexpr float DEPTH_SMOOTHING = 0.1f;
+static constexpr float ERROR_SMOOTHING = 0.05f;
+
+FrameTimingModel::FrameTimingModel() :
+        lastVsyncNanos(0),
+        periodNanos(0.0f),
+        pipelineDepth(DEFAULT_PIPELINE_DEPTH),
+        predictionErrorNanos(0.0f),
+        presentedFrames(0) {
+}
+
+void FrameTimingModel::Reset() {
+    lastVsyncNanos = 0;
+    periodNanos = 0.0f;
+    pipelineDepth = DEFAULT_PIPELINE_DEPTH;
+    predictionErrorNanos = 0.0f;
+    presentedFrames = 0;
+}
+
+void FrameTimingModel::OnVsync(uint64_t vsyncNanos) {
+    if (lastVsyncNanos != 0 && vsyncNanos > lastVsyncNanos &&
+        vsyncNanos - lastVsyncNanos < MAX_VSYNC_GAP_NANOS) {
+        const float interval = float(vsyncNanos - lastVsyncNanos);
+        if (periodNanos <= 0.0f) {
+            periodNanos = interval;
+        } else {
+            // callbacks may skip vsyncs
+            const float periods = std::max(1.0f, std::round(interval / periodNanos));
+            periodNanos += PERIOD_SMOOTHING * (interval / periods - periodNanos);
+        }
+        periodNanos = std::max(periodNanos, MIN_PERIOD_NANOS);
+    }
+    lastVsyncNanos = vsyncNanos;
+}
+
+void FrameTimingModel::OnFramePresented(uint64_t startNanos, uint64_t predictedNanos,
+                                        uint64_t presentNanos) {
+    const float error = std::abs(float(int64_t(presentNanos - predictedNanos)));
+    predictionErrorNanos = presentedFrames == 0
+                           ? error
+                           : predictionErrorNanos + ERROR_SMOOTHING * (error - predictionErrorNanos);
+    ++presentedFrames;
+
+    if (periodNanos <= 0.0f) {
+        return;
+    }
+    const float depth = float(int64_t(presentNanos - NextVsync(startNanos))) / periodNanos;
+    pipelineDepth += DEPTH_SMOOTHING * (glm::clamp(depth, 0.0f, MAX_PIPELINE_DEPTH) -
+                                        pipelineDepth);
+}
+
+uint64_t FrameTimingModel::PredictDisplayTime(uint64_t nowNanos) const {
+    if (periodNanos <= 0.0f) {
+        return nowNanos + DEFAULT_LATENCY_NANOS;
+    }
+    return NextVsync(nowNanos) + static_cast<uint64_t>(pipelineDepth * periodNanos);
+}
+
+uint64_t FrameTimingModel::NextVsync(uint64_t timeNanos) const {
+    if (timeNanos < lastVsyncNanos) {
+        return lastVsyncNanos;
+    }
+    const auto periods = static_cast<uint64_t>(float(timeNanos - lastVsyncNanos) / periodNanos);
+    return lastVsyncNanos + static_cast<uint64_t>(float(periods + 1) * periodNanos);
+}
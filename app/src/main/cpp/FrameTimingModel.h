@@ -0,0 +1,61 @@
+#ifndef VR_VIDEO_PLAYER_FRAMETIMINGMODEL_H
+#define VR_VIDEO_PLAYER_FRAMETIMINGMODEL_H
+
+#include <cstdint>
+
+/**
+ * Predicts when a frame started now will be scanned out: at a vsync, a learned number of vsync
+ * periods after the first one following the start. The vsync phase and period come from display
+ * vsync timestamps, the pipeline depth from the present times of earlier frames. All times are on
+ * one clock of the caller's choice; there are no platform dependencies.
+ */
+class FrameTimingModel {
+public:
+    FrameTimingModel();
+
+    void Reset();
+
+    void OnVsync(uint64_t vsyncNanos);
+
+    /**
+     * A frame started at startNanos, with the display time predicted for it, was presented at
+     * presentNanos.
+     */
+    void OnFramePresented(uint64_t startNanos, uint64_t predictedNanos, uint64_t presentNanos);
+
+    uint64_t PredictDisplayTime(uint64_t nowNanos) const;
+
+    /**
+     * Smoothed absolute difference between the predicted and actual present times.
+     */
+    uint64_t GetPredictionErrorNanos() const {
+        return static_cast<uint64_t>(predictionErrorNanos);
+    }
+
+    uint64_t GetVsyncPeriodNanos() const {
+        return static_cast<uint64_t>(periodNanos);
+    }
+
+    float GetPipelineDepth() const {
+        return pipelineDepth;
+    }
+
+    /**
+     * Frames with a present time; without any, the prediction error is not known.
+     */
+    uint64_t GetPresentedFrameCount() const {
+        return presentedFrames;
+    }
+
+private:
+    uint64_t lastVsyncNanos;
+    float periodNanos;
+    // vsync periods from the first vsync after a frame starts to its presentation
+    float pipelineDepth;
+    float predictionErrorNanos;
+    uint64_t presentedFrames;
+
+    uint64_t NextVsync(uint64_t timeNanos) const;
+};
+
+#endif //VR_VIDEO_PLAYER_FRAMETIMINGMODEL_H
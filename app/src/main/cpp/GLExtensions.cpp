@@ -0,0 +1,93 @@
+#include "GLExtensions.h"
+
+#include <cstring>
+
+#include <EGL/egl.h>
+#include <GLES3/gl3.h>
+
+#include "logger.h"
+
+#define LOG_TAG "VRVideoPlayerX"
+
+static GLExtensions glExtensions{};
+
+template<typename Proc>
+static Proc GetProc(const char *name) {
+    return reinterpret_cast<Proc>(eglGetProcAddress(name));
+}
+
+bool HasGLExtension(const char *name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const auto *extension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+        if (extension != nullptr && strcmp(extension, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HasEGLExtension(EGLDisplay display, const char *name) {
+    const char *extensions = eglQueryString(display, EGL_EXTENSIONS);
+    if (extensions == nullptr) {
+        return false;
+    }
+    const std::size_t length = strlen(name);
+    for (const char *found = strstr(extensions, name); found != nullptr;
+         found = strstr(found + length, name)) {
+        if ((found == extensions || found[-1] == ' ') &&
+            (found[length] == ' ' || found[length] == '\0')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void LoadGLExtensions() {
+    glExtensions = {};
+
+    if (HasGLExtension("GL_EXT_disjoint_timer_query")) {
+        glExtensions.glGetQueryObjectui64vEXT =
+                GetProc<PFNGLGETQUERYOBJECTUI64VEXTPROC>("glGetQueryObjectui64vEXT");
+        glExtensions.disjointTimerQuery = glExtensions.glGetQueryObjectui64vEXT != nullptr;
+    }
+
+    if (HasGLExtension("GL_OVR_multiview2")) {
+        GLint maxViews = 0;
+        glGetIntegerv(GL_MAX_VIEWS_OVR, &maxViews);
+        glExtensions.glFramebufferTextureMultiviewOVR =
+                GetProc<PFNGLFRAMEBUFFERTEXTUREMULTIVIEWOVRPROC>("glFramebufferTextureMultiviewOVR");
+        glExtensions.multiview =
+                maxViews >= 2 && glExtensions.glFramebufferTextureMultiviewOVR != nullptr;
+    }
+
+    if (HasGLExtension("GL_QCOM_texture_foveated")) {
+        glExtensions.glTextureFoveationParametersQCOM =
+                GetProc<PFNGLTEXTUREFOVEATIONPARAMETERSQCOMPROC>(
+                        "glTextureFoveationParametersQCOM");
+        glExtensions.textureFoveated = glExtensions.glTextureFoveationParametersQCOM != nullptr;
+    }
+
+    if (HasGLExtension("GL_KHR_parallel_shader_compile")) {
+        glExtensions.glMaxShaderCompilerThreadsKHR =
+                GetProc<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>("glMaxShaderCompilerThreadsKHR");
+        glExtensions.parallelShaderCompile =
+                glExtensions.glMaxShaderCompilerThreadsKHR != nullptr;
+    }
+
+    if (HasGLExtension("GL_EXT_texture_filter_anisotropic")) {
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &glExtensions.maxTextureAnisotropy);
+        glExtensions.textureFilterAnisotropic = glExtensions.maxTextureAnisotropy > 1.0f;
+    }
+
+    LOG_DEBUG("GL extensions: disjoint timer query %d, multiview %d, texture foveation %d, "
+              "parallel shader compile %d, anisotropic filtering %.0f",
+              glExtensions.disjointTimerQuery, glExtensions.multiview,
+              glExtensions.textureFoveated, glExtensions.parallelShaderCompile,
+              glExtensions.textureFilterAnisotropic ? glExtensions.maxTextureAnisotropy : 1.0f);
+}
+
+const GLExtensions &GetGLExtensions() {
+    return glExtensions;
+}
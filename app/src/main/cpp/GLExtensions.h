@@ -0,0 +1,39 @@
+#ifndef VR_VIDEO_PLAYER_GLEXTENSIONS_H
+#define VR_VIDEO_PLAYER_GLEXTENSIONS_H
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+/**
+ * Optional OpenGL ES extensions of the current context, with their entry points resolved through
+ * eglGetProcAddress. Entry points of unsupported extensions are null.
+ */
+struct GLExtensions {
+    bool disjointTimerQuery;
+    PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64vEXT;
+    // OVR_multiview2 with at least two views
+    bool multiview;
+    PFNGLFRAMEBUFFERTEXTUREMULTIVIEWOVRPROC glFramebufferTextureMultiviewOVR;
+    bool textureFoveated;
+    PFNGLTEXTUREFOVEATIONPARAMETERSQCOMPROC glTextureFoveationParametersQCOM;
+    // KHR_parallel_shader_compile, shaders compile in the background until their status is read
+    bool parallelShaderCompile;
+    PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glMaxShaderCompilerThreadsKHR;
+    bool textureFilterAnisotropic;
+    GLfloat maxTextureAnisotropy;
+};
+
+/**
+ * Queries the extensions of the context current on this thread; call again whenever the context
+ * is recreated.
+ */
+void LoadGLExtensions();
+
+const GLExtensions &GetGLExtensions();
+
+bool HasGLExtension(const char *name);
+
+bool HasEGLExtension(EGLDisplay display, const char *name);
+
+#endif //VR_VIDEO_PLAYER_GLEXTENSIONS_H
@@ -0,0 +1,157 @@
+#include "GLState.h"
+
+#include <GLES2/gl2ext.h>
+
+// taken by reference by std::array::fill
+constexpr GLuint GLState::UNKNOWN;
+
+static int TextureTargetIndex(GLenum target) {
+    switch (target) {
+        case GL_TEXTURE_2D:
+            return 0;
+        case GL_TEXTURE_2D_ARRAY:
+            return 1;
+        case GL_TEXTURE_EXTERNAL_OES:
+            return 2;
+        case GL_TEXTURE_3D:
+            return 3;
+        default:
+            return -1;
+    }
+}
+
+static int CapabilityIndex(GLenum capability) {
+    switch (capability) {
+        case GL_BLEND:
+            return 0;
+        case GL_CULL_FACE:
+            return 1;
+        case GL_DEPTH_TEST:
+            return 2;
+        case GL_SCISSOR_TEST:
+            return 3;
+        case GL_STENCIL_TEST:
+            return 4;
+        default:
+            return -1;
+    }
+}
+
+GLState::GLState() {
+    Reset();
+}
+
+void GLState::Reset() {
+    program = UNKNOWN;
+    activeTexture = UNKNOWN;
+    for (auto &unit: textures) {
+        unit.fill(UNKNOWN);
+    }
+    capabilities.fill(-1);
+    blendFunc.fill(UNKNOWN);
+    viewport.fill(-1);
+    vertexArray = UNKNOWN;
+    attributeArrays.fill(-1);
+}
+
+void GLState::UseProgram(GLuint newProgram) {
+    if (newProgram != program) {
+        glUseProgram(newProgram);
+        program = newProgram;
+    }
+}
+
+void GLState::ActiveTexture(GLenum unit) {
+    if (unit != activeTexture) {
+        glActiveTexture(unit);
+        activeTexture = unit;
+    }
+}
+
+void GLState::BindTexture(GLenum target, GLuint texture) {
+    const int targetIndex = TextureTargetIndex(target);
+    const GLenum unitIndex = activeTexture - GL_TEXTURE0;
+    if (targetIndex < 0 || activeTexture == UNKNOWN || unitIndex >= TEXTURE_UNIT_COUNT) {
+        glBindTexture(target, texture);
+        return;
+    }
+    GLuint &bound = textures[unitIndex][targetIndex];
+    if (texture != bound) {
+        glBindTexture(target, texture);
+        bound = texture;
+    }
+}
+
+void GLState::SetEnabled(GLenum capability, bool enabled) {
+    const int index = CapabilityIndex(capability);
+    if (index >= 0 && capabilities[index] == int8_t(enabled)) {
+        return;
+    }
+    if (enabled) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+    if (index >= 0) {
+        capabilities[index] = int8_t(enabled);
+    }
+}
+
+void GLState::BlendFunc(GLenum sourceFactor, GLenum destinationFactor) {
+    BlendFuncSeparate(sourceFactor, destinationFactor, sourceFactor, destinationFactor);
+}
+
+void GLState::BlendFuncSeparate(GLenum sourceColorFactor, GLenum destinationColorFactor,
+                                GLenum sourceAlphaFactor, GLenum destinationAlphaFactor) {
+    const std::array<GLenum, 4> newBlendFunc{sourceColorFactor, destinationColorFactor,
+                                             sourceAlphaFactor, destinationAlphaFactor};
+    if (newBlendFunc != blendFunc) {
+        glBlendFuncSeparate(sourceColorFactor, destinationColorFactor, sourceAlphaFactor,
+                            destinationAlphaFactor);
+        blendFunc = newBlendFunc;
+    }
+}
+
+void GLState::Viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    const std::array<GLint, 4> newViewport{x, y, width, height};
+    if (newViewport != viewport) {
+        glViewport(x, y, width, height);
+        viewport = newViewport;
+    }
+}
+
+void GLState::BindVertexArray(GLuint newVertexArray) {
+    if (newVertexArray != vertexArray) {
+        glBindVertexArray(newVertexArray);
+        vertexArray = newVertexArray;
+    }
+}
+
+void GLState::EnableVertexAttribArray(GLint index) {
+    if (index < 0) {
+        return;
+    }
+    if (vertexArray != 0 || index >= ATTRIBUTE_COUNT) {
+        glEnableVertexAttribArray(static_cast<GLuint>(index));
+    } else if (attributeArrays[index] != 1) {
+        glEnableVertexAttribArray(static_cast<GLuint>(index));
+        attributeArrays[index] = 1;
+    }
+}
+
+void GLState::DisableVertexAttribArray(GLint index) {
+    if (index < 0) {
+        return;
+    }
+    if (vertexArray != 0 || index >= ATTRIBUTE_COUNT) {
+        glDisableVertexAttribArray(static_cast<GLuint>(index));
+    } else if (attributeArrays[index] != 0) {
+        glDisableVertexAttribArray(static_cast<GLuint>(index));
+        attributeArrays[index] = 0;
+    }
+}
+
+GLState &GetGLState() {
+    static thread_local GLState state;
+    return state;
+}
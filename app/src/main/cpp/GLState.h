@@ -0,0 +1,75 @@
+#ifndef VR_VIDEO_PLAYER_GLSTATE_H
+#define VR_VIDEO_PLAYER_GLSTATE_H
+
+#include <array>
+#include <cstdint>
+
+#include <GLES3/gl3.h>
+
+/**
+ * Shadows the GL state the passes change per draw and skips the calls that would not change it.
+ * Every thread has its own, for the context current on it; Reset it for a new context, after
+ * deleting bound objects, and whenever the state may have been changed bypassing it.
+ *
+ * Vertex attribute arrays are tracked for the default vertex array object only.
+ */
+class GLState {
+public:
+    GLState();
+
+    void Reset();
+
+    void UseProgram(GLuint program);
+
+    void ActiveTexture(GLenum unit);
+
+    /**
+     * Binds the texture to the target of the active unit.
+     */
+    void BindTexture(GLenum target, GLuint texture);
+
+    /**
+     * Enables or disables one of GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_SCISSOR_TEST and
+     * GL_STENCIL_TEST.
+     */
+    void SetEnabled(GLenum capability, bool enabled);
+
+    void BlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+
+    void BlendFuncSeparate(GLenum sourceColorFactor, GLenum destinationColorFactor,
+                           GLenum sourceAlphaFactor, GLenum destinationAlphaFactor);
+
+    void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    void BindVertexArray(GLuint vertexArray);
+
+    void EnableVertexAttribArray(GLint index);
+
+    void DisableVertexAttribArray(GLint index);
+
+private:
+    static constexpr int TEXTURE_UNIT_COUNT = 4;
+    static constexpr int TEXTURE_TARGET_COUNT = 4;
+    static constexpr int CAPABILITY_COUNT = 5;
+    static constexpr int ATTRIBUTE_COUNT = 16;
+    // a name no object has, so the next call is never skipped
+    static constexpr GLuint UNKNOWN = ~0u;
+
+    GLuint program;
+    GLenum activeTexture;
+    std::array<std::array<GLuint, TEXTURE_TARGET_COUNT>, TEXTURE_UNIT_COUNT> textures;
+    // 0 disabled, 1 enabled, -1 unknown
+    std::array<int8_t, CAPABILITY_COUNT> capabilities;
+    // color source and destination, then alpha source and destination
+    std::array<GLenum, 4> blendFunc;
+    std::array<GLint, 4> viewport;
+    GLuint vertexArray;
+    std::array<int8_t, ATTRIBUTE_COUNT> attributeArrays;
+};
+
+/**
+ * The state of the context current on this thread.
+ */
+GLState &GetGLState();
+
+#endif //VR_VIDEO_PLAYER_GLSTATE_H
@@ -17,33 +17,6 @@
 
 #define LOG_TAG "VRVideoPlayerU"
 
-GLuint LoadGLShader(GLenum type, const char *shader_source) {
-    GLuint shader = glCreateShader(type);
-    glShaderSource(shader, 1, &shader_source, nullptr);
-    glCompileShader(shader);
-
-    // Get the compilation status.
-    GLint compile_status;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &compile_status);
-
-    // If the compilation failed, delete the shader and show an error.
-    if (compile_status == 0) {
-        GLint info_len = 0;
-        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &info_len);
-        if (info_len == 0) {
-            return 0;
-        }
-
-        std::vector<char> info_string(info_len);
-        glGetShaderInfoLog(shader, info_len, nullptr, info_string.data());
-        LOG_ERROR("Could not compile shader of type %d: %s", type, info_string.data());
-        glDeleteShader(shader);
-        return 0;
-    } else {
-        return shader;
-    }
-}
-
 void CheckGlError(const char *file, int line, const char *label) {
     bool hasError = false;
     for (GLenum gl_error = glGetError(); gl_error != GL_NO_ERROR; gl_error = glGetError()) {
@@ -63,3 +36,9 @@ uint64_t GetBootTimeNano() {
     clock_gettime(CLOCK_BOOTTIME, &res);
     return (res.tv_sec * kNanosInSeconds) + res.tv_nsec;
 }
+
+uint64_t GetMonotonicTimeNano() {
+    struct timespec res{};
+    clock_gettime(CLOCK_MONOTONIC, &res);
+    return (res.tv_sec * kNanosInSeconds) + res.tv_nsec;
+}
@@ -10,8 +10,6 @@
 
 #include <cardboard.h>
 
-GLuint LoadGLShader(GLenum type, const char *shader_source);
-
 void CheckGlError(const char *file, int line, const char *label);
 
 #define CHECK_GL_ERROR(label) CheckGlError(__FILE__, __LINE__, label)
@@ -23,6 +21,9 @@ bool InitVideoTexturePlayback(JNIEnv *env, jobject javaVideoTexturePlayer, GLuin
 
 uint64_t GetBootTimeNano();
 
+// the clock of vsync and present timestamps
+uint64_t GetMonotonicTimeNano();
+
 struct CardboardHeadTrackerDeleter {
     void operator()(CardboardHeadTracker *p) const { CardboardHeadTracker_destroy(p); }
 };
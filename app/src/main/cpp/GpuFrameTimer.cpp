@@ -0,0 +1,94 @@
+#include "GpuFrameTimer.h"
+
+#include <GLES2/gl2ext.h>
+
+#include "GLExtensions.h"
+#include "GLUtils.h"
+#include "logger.h"
+
+#define LOG_TAG "VRVideoPlayerT"
+
+GpuFrameTimer::GpuFrameTimer() :
+        frames{},
+        current(0),
+        oldest(0),
+        useTimerQuery(false) {
+}
+
+void GpuFrameTimer::GlSetup() {
+    // called for a new context, the objects of the previous one are gone with it
+    frames = {};
+    current = 0;
+    oldest = 0;
+
+    useTimerQuery = GetGLExtensions().disjointTimerQuery;
+    if (!useTimerQuery) {
+        LOG_INFO("No GPU timer queries, frame times are not measured");
+        return;
+    }
+    for (Frame &frame: frames) {
+        glGenQueries(1, &frame.query);
+    }
+    // reading the disjoint flag clears it
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    CHECK_GL_ERROR("GpuFrameTimer setup");
+}
+
+bool GpuFrameTimer::IsAvailable() const {
+    return useTimerQuery;
+}
+
+void GpuFrameTimer::BeginFrame() {
+    Frame &frame = frames[current];
+    if (!useTimerQuery || frame.pending) {
+        // all the slots are still waiting for the GPU, skip measuring this frame
+        return;
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED_EXT, frame.query);
+}
+
+void GpuFrameTimer::EndFrame() {
+    Frame &frame = frames[current];
+    if (!useTimerQuery || frame.pending) {
+        return;
+    }
+
+    glEndQuery(GL_TIME_ELAPSED_EXT);
+    frame.pending = true;
+    current = (current + 1) % FRAMES_IN_FLIGHT;
+}
+
+bool GpuFrameTimer::Poll(uint64_t &frameTimeNanos) {
+    while (useTimerQuery && frames[oldest].pending) {
+        Frame &frame = frames[oldest];
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(frame.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            return false;
+        }
+        GLuint64 elapsed = 0;
+        GetGLExtensions().glGetQueryObjectui64vEXT(frame.query, GL_QUERY_RESULT, &elapsed);
+        const bool discarded = frame.discarded;
+        frame.pending = false;
+        frame.discarded = false;
+        oldest = (oldest + 1) % FRAMES_IN_FLIGHT;
+
+        // a disjoint event (e.g. a GPU frequency change) makes all the results in flight
+        // meaningless, not just this one
+        GLint disjoint = 0;
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+        if (disjoint) {
+            for (Frame &other: frames) {
+                other.discarded = other.pending;
+            }
+            continue;
+        }
+        if (!discarded) {
+            frameTimeNanos = elapsed;
+            return true;
+        }
+    }
+    return false;
+}
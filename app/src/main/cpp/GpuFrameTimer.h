@@ -0,0 +1,51 @@
+#ifndef VR_VIDEO_PLAYER_GPUFRAMETIMER_H
+#define VR_VIDEO_PLAYER_GPUFRAMETIMER_H
+
+#include <array>
+#include <cstdint>
+
+#include <GLES3/gl3.h>
+
+/**
+ * Measures how long the GPU takes to render a frame without ever waiting for it: results are
+ * collected a few frames later. Needs EXT_disjoint_timer_query; without it nothing is measured.
+ * A fence would only tell when the frame was seen done on the next frame, which is at least the
+ * vsync interval however fast the GPU is.
+ */
+class GpuFrameTimer {
+public:
+    GpuFrameTimer();
+
+    void GlSetup();
+
+    /**
+     * Whether the frame times are measured at all.
+     */
+    bool IsAvailable() const;
+
+    void BeginFrame();
+
+    void EndFrame();
+
+    /**
+     * Returns true and the duration of the oldest unreported finished frame, if there is any.
+     */
+    bool Poll(uint64_t &frameTimeNanos);
+
+private:
+    static constexpr int FRAMES_IN_FLIGHT = 4;
+
+    struct Frame {
+        GLuint query;
+        bool pending;
+        // in flight during a disjoint event, the result is not reported
+        bool discarded;
+    };
+
+    std::array<Frame, FRAMES_IN_FLIGHT> frames;
+    int current;
+    int oldest;
+    bool useTimerQuery;
+};
+
+#endif //VR_VIDEO_PLAYER_GPUFRAMETIMER_H
@@ -48,6 +48,10 @@ JavaInterface::JavaInterface(JavaVM *vm, jobject javaContextObj, jobject javaAss
                                                                "executeButtonAction",
                                                                "(I)V");
 
+    jclass activityClass = env->FindClass("cz/mormegil/vrvideoplayer/MainActivity");
+    javaMethodActivityOnCompositorFailed = env->GetMethodID(activityClass, "onCompositorFailed",
+                                                            "()V");
+
     jclass bitmapFactoryClass =
             env->FindClass("android/graphics/BitmapFactory");
     jclass assetManagerClass =
@@ -147,3 +151,15 @@ bool JavaInterface::ExecuteButtonAction(JNIEnv *env, const ButtonAction action)
 
     return true;
 }
+
+bool JavaInterface::DisableAsyncTimewarp(JNIEnv *env) {
+    env->CallVoidMethod(javaContext, javaMethodActivityOnCompositorFailed);
+
+    if (env->ExceptionOccurred() != nullptr) {
+        LOG_ERROR("Java exception in onCompositorFailed");
+        env->ExceptionClear();
+        return false;
+    }
+
+    return true;
+}
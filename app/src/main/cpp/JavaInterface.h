@@ -22,6 +22,11 @@ public:
 
     bool ExecuteButtonAction(JNIEnv *env, const ButtonAction action);
 
+    /**
+     * Asks the activity to render into the window again, without the compositor.
+     */
+    bool DisableAsyncTimewarp(JNIEnv *env);
+
 private:
     JavaVM *javaVm;
     jobject javaContext;
@@ -34,6 +39,7 @@ private:
 
     jmethodID javaMethodVideoTexturePlayerInitializePlayback;
     jmethodID javaMethodControllerExecuteButtonAction;
+    jmethodID javaMethodActivityOnCompositorFailed;
     jmethodID javaMethodBitmapFactoryDecodeStream;
     jmethodID javaMethodAssetManagerOpen;
     jmethodID javaMethodGlUtilsTexImage2D;
@@ -0,0 +1,50 @@
+#include "LensMask.h"
+
+#include <limits>
+
+#include "GLState.h"
+#include "logger.h"
+
+#define LOG_TAG "VRVideoPlayerL"
+
+// grow the mask a little, so bilinear filtering at its edge never reads unshaded texels
+static constexpr float MASK_MARGIN = 1.01f;
+
+LensMask::LensMask() :
+        vertexPos{},
+        vertexIndex{} {
+}
+
+void LensMask::SetDistortionMesh(const CardboardMesh &mesh) {
+    vertexPos.clear();
+    vertexIndex.clear();
+
+    if (mesh.n_vertices > std::numeric_limits<GLushort>::max() + 1) {
+        LOG_ERROR("Distortion mesh too large for the lens mask (%d vertices)", mesh.n_vertices);
+        return;
+    }
+
+    // eye texture coordinates [0, 1] map to the whole eye viewport
+    vertexPos.reserve(2 * mesh.n_vertices);
+    for (int i = 0; i < 2 * mesh.n_vertices; ++i) {
+        vertexPos.push_back((2.0f * mesh.uvs[i] - 1.0f) * MASK_MARGIN);
+    }
+
+    vertexIndex.reserve(mesh.n_indices);
+    for (int i = 0; i < mesh.n_indices; ++i) {
+        vertexIndex.push_back(static_cast<GLushort>(mesh.indices[i]));
+    }
+}
+
+void LensMask::Render(GLint programParamPosition) const {
+    if (vertexIndex.empty()) {
+        return;
+    }
+
+    GetGLState().EnableVertexAttribArray(programParamPosition);
+    glVertexAttribPointer(programParamPosition, 2, GL_FLOAT, GL_FALSE, 0, vertexPos.data());
+
+    // the distortion mesh is a triangle strip, like the Cardboard distortion renderer draws it
+    glDrawElements(GL_TRIANGLE_STRIP, static_cast<GLsizei>(vertexIndex.size()), GL_UNSIGNED_SHORT,
+                   vertexIndex.data());
+}
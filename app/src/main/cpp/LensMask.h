@@ -0,0 +1,33 @@
+#ifndef VR_VIDEO_PLAYER_LENSMASK_H
+#define VR_VIDEO_PLAYER_LENSMASK_H
+
+#include <vector>
+
+#include <GLES2/gl2.h>
+
+#include <cardboard.h>
+
+/**
+ * The area of an eye buffer the Cardboard distortion pass samples, i.e. what is visible through
+ * the lens. Rendered into the stencil buffer, it keeps the eye passes from shading the rest.
+ */
+class LensMask {
+public:
+    LensMask();
+
+    /**
+     * Builds the mask from the texture coordinates of the eye's distortion mesh.
+     */
+    void SetDistortionMesh(const CardboardMesh &mesh);
+
+    /**
+     * Renders the mask over the eye viewport (positions only, in normalized device coordinates).
+     */
+    void Render(GLint programParamPosition) const;
+
+private:
+    std::vector<GLfloat> vertexPos;
+    std::vector<GLushort> vertexIndex;
+};
+
+#endif //VR_VIDEO_PLAYER_LENSMASK_H
@@ -0,0 +1,213 @@
+#include "MeshCache.h"
+
+#include <cstdint>
+#include <cstdio>
+
+#include <memory>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <GLES2/gl2.h>
+
+#include "logger.h"
+
+#define LOG_TAG "VRVideoPlayerC"
+
+static constexpr uint32_t MESH_CACHE_MAGIC = 0x48534d56; // "VMSH"
+// bump whenever the layout changes, older files are then just rebuilt
+static constexpr uint32_t MESH_CACHE_VERSION = 1;
+static constexpr uint32_t MESH_CACHE_MAX_MESHES = 16;
+
+struct MeshCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t meshCount;
+    uint32_t fileSize;
+};
+
+/**
+ * Offsets are from the start of the file and 4-byte aligned, so the arrays can be used directly.
+ */
+struct MeshCacheEntry {
+    uint32_t mode;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t positionOffset;
+    uint32_t uvOffset;
+    uint32_t indexOffset;
+};
+
+static uint32_t AlignSize(std::size_t size) {
+    return static_cast<uint32_t>((size + 3) & ~std::size_t(3));
+}
+
+/**
+ * Read-only mapping of a whole file, unmapped when the last mesh using it goes away.
+ */
+class MappedFile {
+public:
+    MappedFile(void *data, std::size_t size) : data(data), size(size) {
+    }
+
+    ~MappedFile() {
+        munmap(data, size);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const uint8_t *Bytes() const {
+        return static_cast<const uint8_t *>(data);
+    }
+
+private:
+    void *data;
+    std::size_t size;
+};
+
+bool WriteMeshCache(const std::string &path, const std::vector<TexturedMesh::Builder> &meshes) {
+    if (meshes.size() > MESH_CACHE_MAX_MESHES) {
+        return false;
+    }
+
+    MeshCacheHeader header{MESH_CACHE_MAGIC, MESH_CACHE_VERSION,
+                           static_cast<uint32_t>(meshes.size()), 0};
+    std::vector<MeshCacheEntry> entries;
+    std::size_t offset = sizeof(MeshCacheHeader) + meshes.size() * sizeof(MeshCacheEntry);
+    for (const TexturedMesh::Builder &mesh: meshes) {
+        MeshCacheEntry entry{};
+        entry.mode = GL_TRIANGLES;
+        entry.vertexCount = static_cast<uint32_t>(mesh.positions().size() / 3);
+        entry.indexCount = static_cast<uint32_t>(mesh.indices().size());
+        entry.positionOffset = AlignSize(offset);
+        offset = entry.positionOffset + mesh.positions().size() * sizeof(GLfloat);
+        entry.uvOffset = AlignSize(offset);
+        offset = entry.uvOffset + mesh.uvs().size() * sizeof(GLfloat);
+        entry.indexOffset = AlignSize(offset);
+        offset = entry.indexOffset + mesh.indices().size() * sizeof(GLushort);
+        entries.push_back(entry);
+    }
+    header.fileSize = AlignSize(offset);
+
+    // write into a temporary file first, so a partially written cache is never loaded
+    const std::string tempPath = path + ".tmp";
+    FILE *file = fopen(tempPath.c_str(), "wb");
+    if (file == nullptr) {
+        LOG_ERROR("Cannot create mesh cache %s", tempPath.c_str());
+        return false;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    if (!entries.empty()) {
+        ok = ok && fwrite(entries.data(), sizeof(MeshCacheEntry), entries.size(), file) ==
+                   entries.size();
+    }
+    auto writeAt = [&](uint32_t position, const void *data, std::size_t size) {
+        return ok && fseek(file, position, SEEK_SET) == 0 &&
+               (size == 0 || fwrite(data, size, 1, file) == 1);
+    };
+    for (std::size_t i = 0; i < meshes.size(); ++i) {
+        const TexturedMesh::Builder &mesh = meshes[i];
+        ok = writeAt(entries[i].positionOffset, mesh.positions().data(),
+                     mesh.positions().size() * sizeof(GLfloat));
+        ok = writeAt(entries[i].uvOffset, mesh.uvs().data(), mesh.uvs().size() * sizeof(GLfloat));
+        ok = writeAt(entries[i].indexOffset, mesh.indices().data(),
+                     mesh.indices().size() * sizeof(GLushort));
+    }
+    ok = ok && ftruncate(fileno(file), header.fileSize) == 0;
+    ok = (fclose(file) == 0) && ok;
+
+    if (!ok || rename(tempPath.c_str(), path.c_str()) != 0) {
+        LOG_ERROR("Cannot write mesh cache %s", path.c_str());
+        unlink(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool IsValidArray(const MeshCacheHeader &header, uint32_t offset, uint64_t size) {
+    return offset % 4 == 0 && offset >= sizeof(MeshCacheHeader) && offset <= header.fileSize &&
+           size <= header.fileSize - offset;
+}
+
+/**
+ * The meshes are drawn from client arrays, so an index beyond the vertices would read past them.
+ */
+static bool IsValidMesh(const MeshCacheEntry &entry, const GLushort *indices) {
+    // WriteMeshCache stores triangle lists only
+    if (entry.mode != GL_TRIANGLES || entry.indexCount % 3 != 0) {
+        return false;
+    }
+    for (uint32_t i = 0; i < entry.indexCount; ++i) {
+        if (indices[i] >= entry.vertexCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LoadMeshCache(const std::string &path, std::vector<TexturedMesh> &meshes) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat fileStat{};
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size < (off_t) sizeof(MeshCacheHeader)) {
+        close(fd);
+        return false;
+    }
+    const auto fileSize = static_cast<std::size_t>(fileStat.st_size);
+    void *data = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        LOG_ERROR("Cannot map mesh cache %s", path.c_str());
+        return false;
+    }
+    std::shared_ptr<MappedFile> mapping = std::make_shared<MappedFile>(data, fileSize);
+
+    const auto &header = *reinterpret_cast<const MeshCacheHeader *>(mapping->Bytes());
+    if (header.magic != MESH_CACHE_MAGIC || header.version != MESH_CACHE_VERSION ||
+        header.fileSize != fileSize || header.meshCount > MESH_CACHE_MAX_MESHES ||
+        sizeof(MeshCacheHeader) + header.meshCount * sizeof(MeshCacheEntry) > fileSize) {
+        LOG_DEBUG("Ignoring stale mesh cache %s", path.c_str());
+        return false;
+    }
+
+    const auto *entries = reinterpret_cast<const MeshCacheEntry *>(
+            mapping->Bytes() + sizeof(MeshCacheHeader));
+    std::vector<TexturedMesh> loaded;
+    for (uint32_t i = 0; i < header.meshCount; ++i) {
+        const MeshCacheEntry &entry = entries[i];
+        if (!IsValidArray(header, entry.positionOffset,
+                          uint64_t(entry.vertexCount) * 3 * sizeof(GLfloat)) ||
+            !IsValidArray(header, entry.uvOffset,
+                          uint64_t(entry.vertexCount) * 2 * sizeof(GLfloat)) ||
+            !IsValidArray(header, entry.indexOffset,
+                          uint64_t(entry.indexCount) * sizeof(GLushort)) ||
+            !IsValidMesh(entry, reinterpret_cast<const GLushort *>(
+                    mapping->Bytes() + entry.indexOffset))) {
+            LOG_ERROR("Corrupted mesh cache %s", path.c_str());
+            return false;
+        }
+
+        // the aliasing constructor shares the ownership of the mapping
+        loaded.emplace_back(
+                entry.mode,
+                static_cast<GLsizei>(entry.indexCount),
+                std::shared_ptr<const GLfloat>(mapping, reinterpret_cast<const GLfloat *>(
+                        mapping->Bytes() + entry.positionOffset)),
+                std::shared_ptr<const GLfloat>(mapping, reinterpret_cast<const GLfloat *>(
+                        mapping->Bytes() + entry.uvOffset)),
+                std::shared_ptr<const GLushort>(mapping, reinterpret_cast<const GLushort *>(
+                        mapping->Bytes() + entry.indexOffset))
+        );
+    }
+
+    meshes = std::move(loaded);
+    return true;
+}
@@ -0,0 +1,22 @@
+#ifndef VR_VIDEO_PLAYER_MESHCACHE_H
+#define VR_VIDEO_PLAYER_MESHCACHE_H
+
+#include <string>
+#include <vector>
+
+#include "TexturedMesh.h"
+
+/**
+ * Writes the meshes into a versioned binary file whose arrays are stored exactly in the
+ * TexturedMesh layout, so LoadMeshCache can use them in place. An empty list is valid and records
+ * that the source has no mesh.
+ */
+bool WriteMeshCache(const std::string &path, const std::vector<TexturedMesh::Builder> &meshes);
+
+/**
+ * Memory-maps a file written by WriteMeshCache; the meshes point directly into the mapping, which
+ * stays alive as long as any of them. Returns false if the file is missing, stale or invalid.
+ */
+bool LoadMeshCache(const std::string &path, std::vector<TexturedMesh> &meshes);
+
+#endif //VR_VIDEO_PLAYER_MESHCACHE_H
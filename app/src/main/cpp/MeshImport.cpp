@@ -0,0 +1,596 @@
+#include "MeshImport.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <utility>
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "glm/vec2.hpp"
+#include "glm/vec3.hpp"
+#include "glm/geometric.hpp"
+
+#include "logger.h"
+
+#define LOG_TAG "VRVideoPlayerI"
+
+static constexpr std::size_t MAX_MESH_VERTICES = std::numeric_limits<GLushort>::max() + 1;
+
+// the whole moov box is read into memory, and the inflated meshes are kept there as well
+static constexpr uint64_t MAX_MOVIE_BOX_SIZE = 64 * 1024 * 1024;
+static constexpr std::size_t MAX_INFLATED_MESH_SIZE = 64 * 1024 * 1024;
+static constexpr std::size_t INFLATE_CHUNK_SIZE = 64 * 1024;
+
+// reserved bytes and data reference index of a SampleEntry, then the fixed fields of a
+// VisualSampleEntry, up to its child boxes
+static constexpr std::ptrdiff_t VISUAL_SAMPLE_ENTRY_HEADER_SIZE = 78;
+// version, flags and entry count of the stsd box
+static constexpr std::ptrdiff_t SAMPLE_DESCRIPTION_HEADER_SIZE = 8;
+// version, flags, CRC and encoding of the mshp box
+static constexpr std::ptrdiff_t PROJECTION_MESH_HEADER_SIZE = 12;
+
+static constexpr uint32_t COUNT_MASK = 0x7fffffffu;
+
+enum class MeshIndexType {
+    TRIANGLES = 0,
+    TRIANGLE_STRIP = 1,
+    TRIANGLE_FAN = 2,
+};
+
+struct MeshVertex {
+    glm::vec3 pos;
+    glm::vec2 uv;
+};
+
+static constexpr uint32_t FourCC(char a, char b, char c, char d) {
+    return (uint32_t(uint8_t(a)) << 24) | (uint32_t(uint8_t(b)) << 16) |
+           (uint32_t(uint8_t(c)) << 8) | uint32_t(uint8_t(d));
+}
+
+static constexpr uint32_t BOX_MOOV = FourCC('m', 'o', 'o', 'v');
+static constexpr uint32_t BOX_TRAK = FourCC('t', 'r', 'a', 'k');
+static constexpr uint32_t BOX_MDIA = FourCC('m', 'd', 'i', 'a');
+static constexpr uint32_t BOX_MINF = FourCC('m', 'i', 'n', 'f');
+static constexpr uint32_t BOX_STBL = FourCC('s', 't', 'b', 'l');
+static constexpr uint32_t BOX_STSD = FourCC('s', 't', 's', 'd');
+static constexpr uint32_t BOX_SV3D = FourCC('s', 'v', '3', 'd');
+static constexpr uint32_t BOX_PROJ = FourCC('p', 'r', 'o', 'j');
+static constexpr uint32_t BOX_MSHP = FourCC('m', 's', 'h', 'p');
+static constexpr uint32_t BOX_MESH = FourCC('m', 'e', 's', 'h');
+static constexpr uint32_t ENCODING_RAW = FourCC('r', 'a', 'w', ' ');
+static constexpr uint32_t ENCODING_DEFLATE = FourCC('d', 'f', 'l', '8');
+
+static uint32_t ReadU32(const uint8_t *p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+static uint64_t ReadU64(const uint8_t *p) {
+    return (uint64_t(ReadU32(p)) << 32) | ReadU32(p + 4);
+}
+
+/**
+ * Adds the mesh scaled uniformly around the origin so that its farthest vertex is at distance 1.
+ * The viewer is at the origin, so this does not change what the mesh looks like, but it brings
+ * any model units into the depth range the video is rendered with.
+ */
+static void AddScaledMesh(const std::vector<MeshVertex> &vertices,
+                          const std::vector<GLushort> &triangles,
+                          TexturedMesh::Builder &meshBuilder) {
+    float maxDistance = 0.0f;
+    for (const MeshVertex &vertex: vertices) {
+        maxDistance = std::max(maxDistance, glm::length(vertex.pos));
+    }
+    const float scale = maxDistance > 0.0f ? 1.0f / maxDistance : 1.0f;
+
+    GLushort base = 0;
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        const MeshVertex &vertex = vertices[i];
+        GLushort index = meshBuilder.add_vertex(vertex.pos.x * scale, vertex.pos.y * scale,
+                                                vertex.pos.z * scale, vertex.uv.x, vertex.uv.y);
+        if (i == 0) {
+            base = index;
+        }
+    }
+    for (std::size_t i = 0; i + 2 < triangles.size(); i += 3) {
+        meshBuilder.add_triangle(base + triangles[i], base + triangles[i + 1],
+                                 base + triangles[i + 2]);
+    }
+}
+
+static long ResolveObjIndex(long index, std::size_t count) {
+    // OBJ indices are 1-based, negative indices are relative to the end of the list so far
+    if (index > 0) {
+        return index - 1;
+    } else if (index < 0) {
+        return static_cast<long>(count) + index;
+    } else {
+        return -1;
+    }
+}
+
+bool ImportObjMesh(const std::string &path, TexturedMesh::Builder &meshBuilder) {
+    std::ifstream file(path);
+    if (!file) {
+        LOG_ERROR("Cannot open mesh file %s", path.c_str());
+        return false;
+    }
+
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<MeshVertex> vertices;
+    std::vector<GLushort> triangles;
+    std::map<std::pair<long, long>, GLushort> vertexIndices;
+    std::vector<GLushort> polygon;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream tokens(line);
+        std::string keyword;
+        tokens >> keyword;
+
+        if (keyword == "v") {
+            glm::vec3 pos;
+            tokens >> pos.x >> pos.y >> pos.z;
+            positions.push_back(pos);
+        } else if (keyword == "vt") {
+            glm::vec2 uv;
+            tokens >> uv.x >> uv.y;
+            // OBJ has the texture origin at the bottom
+            uvs.emplace_back(uv.x, 1.0f - uv.y);
+        } else if (keyword == "f") {
+            polygon.clear();
+            std::string corner;
+            while (tokens >> corner) {
+                // v, v/vt, v/vt/vn or v//vn
+                char *end;
+                long positionIndex = ResolveObjIndex(std::strtol(corner.c_str(), &end, 10),
+                                                     positions.size());
+                long uvIndex = -1;
+                if (end[0] == '/' && end[1] != '/') {
+                    uvIndex = ResolveObjIndex(std::strtol(end + 1, nullptr, 10), uvs.size());
+                }
+                if (positionIndex < 0 || positionIndex >= static_cast<long>(positions.size()) ||
+                    uvIndex >= static_cast<long>(uvs.size())) {
+                    LOG_ERROR("Invalid face vertex %s in %s", corner.c_str(), path.c_str());
+                    return false;
+                }
+
+                auto key = std::make_pair(positionIndex, uvIndex);
+                auto found = vertexIndices.find(key);
+                if (found == vertexIndices.end()) {
+                    if (vertices.size() >= MAX_MESH_VERTICES) {
+                        LOG_ERROR("Too many vertices in %s", path.c_str());
+                        return false;
+                    }
+                    found = vertexIndices.emplace(key,
+                                                  static_cast<GLushort>(vertices.size())).first;
+                    vertices.push_back({positions[positionIndex],
+                                        uvIndex >= 0 ? uvs[uvIndex] : glm::vec2(0.0f)});
+                }
+                polygon.push_back(found->second);
+            }
+
+            for (std::size_t i = 2; i < polygon.size(); ++i) {
+                triangles.push_back(polygon[0]);
+                triangles.push_back(polygon[i - 1]);
+                triangles.push_back(polygon[i]);
+            }
+        }
+        // everything else (normals, groups, materials...) is irrelevant for a projection mesh
+    }
+
+    if (triangles.empty()) {
+        LOG_ERROR("No faces in mesh file %s", path.c_str());
+        return false;
+    }
+
+    AddScaledMesh(vertices, triangles, meshBuilder);
+    LOG_DEBUG("Imported %zu vertices, %zu triangles from %s", vertices.size(),
+              triangles.size() / 3, path.c_str());
+    return true;
+}
+
+/**
+ * Calls the callback with the type and payload of every box in [begin, end), until the callback
+ * returns true. Returns false if no callback returned true, including on malformed data.
+ */
+template<typename Callback>
+static bool ForEachBox(const uint8_t *begin, const uint8_t *end, Callback callback) {
+    const uint8_t *pos = begin;
+    while (end - pos >= 8) {
+        uint64_t size = ReadU32(pos);
+        const uint32_t type = ReadU32(pos + 4);
+        std::ptrdiff_t headerSize = 8;
+        if (size == 1) {
+            if (end - pos < 16) {
+                return false;
+            }
+            size = ReadU64(pos + 8);
+            headerSize = 16;
+        } else if (size == 0) {
+            // box extends to the end of its parent
+            size = static_cast<uint64_t>(end - pos);
+        }
+        if (size < static_cast<uint64_t>(headerSize) || size > static_cast<uint64_t>(end - pos)) {
+            return false;
+        }
+
+        if (callback(type, pos + headerSize, pos + size)) {
+            return true;
+        }
+        pos += size;
+    }
+    return false;
+}
+
+static bool FindProjectionMeshBox(const uint8_t *begin, const uint8_t *end, bool sampleEntries,
+                                  const uint8_t *&meshBoxBegin, const uint8_t *&meshBoxEnd) {
+    return ForEachBox(begin, end, [&](uint32_t type, const uint8_t *payload,
+                                      const uint8_t *payloadEnd) {
+        if (sampleEntries) {
+            // sample entries of other than video tracks have a different layout, so searching
+            // them just does not find anything
+            if (payloadEnd - payload < VISUAL_SAMPLE_ENTRY_HEADER_SIZE) {
+                return false;
+            }
+            return FindProjectionMeshBox(payload + VISUAL_SAMPLE_ENTRY_HEADER_SIZE, payloadEnd,
+                                         false, meshBoxBegin, meshBoxEnd);
+        }
+
+        switch (type) {
+            case BOX_TRAK:
+            case BOX_MDIA:
+            case BOX_MINF:
+            case BOX_STBL:
+            case BOX_SV3D:
+            case BOX_PROJ:
+                return FindProjectionMeshBox(payload, payloadEnd, false, meshBoxBegin,
+                                             meshBoxEnd);
+
+            case BOX_STSD:
+                if (payloadEnd - payload < SAMPLE_DESCRIPTION_HEADER_SIZE) {
+                    return false;
+                }
+                return FindProjectionMeshBox(payload + SAMPLE_DESCRIPTION_HEADER_SIZE, payloadEnd,
+                                             true, meshBoxBegin, meshBoxEnd);
+
+            case BOX_MSHP:
+                meshBoxBegin = payload;
+                meshBoxEnd = payloadEnd;
+                return true;
+
+            default:
+                return false;
+        }
+    });
+}
+
+static bool ReadFully(int fd, uint8_t *buffer, std::size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t read = pread(fd, buffer, size, offset);
+        if (read <= 0) {
+            return false;
+        }
+        buffer += read;
+        size -= static_cast<std::size_t>(read);
+        offset += read;
+    }
+    return true;
+}
+
+static bool ReadMovieBox(int fd, std::vector<uint8_t> &movieBox) {
+    struct stat fileStat{};
+    if (fstat(fd, &fileStat) != 0) {
+        LOG_ERROR("Cannot stat video file");
+        return false;
+    }
+    const auto fileSize = static_cast<uint64_t>(fileStat.st_size);
+
+    uint64_t offset = 0;
+    while (offset + 8 <= fileSize) {
+        std::array<uint8_t, 16> header{};
+        if (!ReadFully(fd, header.data(), std::min<uint64_t>(header.size(), fileSize - offset),
+                       static_cast<off_t>(offset))) {
+            return false;
+        }
+
+        uint64_t size = ReadU32(header.data());
+        const uint32_t type = ReadU32(header.data() + 4);
+        uint64_t headerSize = 8;
+        if (size == 1) {
+            if (offset + 16 > fileSize) {
+                return false;
+            }
+            size = ReadU64(header.data() + 8);
+            headerSize = 16;
+        } else if (size == 0) {
+            size = fileSize - offset;
+        }
+        if (size < headerSize || size > fileSize - offset) {
+            return false;
+        }
+
+        if (type == BOX_MOOV) {
+            const uint64_t payloadSize = size - headerSize;
+            if (payloadSize > MAX_MOVIE_BOX_SIZE) {
+                LOG_ERROR("Movie box too large (%llu B)", (unsigned long long) payloadSize);
+                return false;
+            }
+            movieBox.resize(payloadSize);
+            return ReadFully(fd, movieBox.data(), movieBox.size(),
+                             static_cast<off_t>(offset + headerSize));
+        }
+        offset += size;
+    }
+    return false;
+}
+
+static bool InflateRaw(const uint8_t *begin, const uint8_t *end, std::vector<uint8_t> &output) {
+    z_stream stream{};
+    // negative window bits: raw deflate data without the zlib header
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+        return false;
+    }
+    stream.next_in = const_cast<Bytef *>(begin);
+    stream.avail_in = static_cast<uInt>(end - begin);
+
+    int result = Z_OK;
+    while (result == Z_OK && output.size() < MAX_INFLATED_MESH_SIZE) {
+        const std::size_t offset = output.size();
+        output.resize(offset + INFLATE_CHUNK_SIZE);
+        stream.next_out = output.data() + offset;
+        stream.avail_out = static_cast<uInt>(INFLATE_CHUNK_SIZE);
+        result = inflate(&stream, Z_NO_FLUSH);
+        output.resize(output.size() - stream.avail_out);
+    }
+    inflateEnd(&stream);
+
+    if (result != Z_STREAM_END) {
+        LOG_ERROR("Cannot inflate projection mesh (%d)", result);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Reads big-endian bit fields, most significant bit first.
+ */
+class BitReader {
+public:
+    BitReader(const uint8_t *begin, const uint8_t *end) :
+            data(begin),
+            bitCount(static_cast<std::size_t>(end - begin) * 8),
+            bitPos(0) {
+    }
+
+    bool Read(int bits, uint32_t &value) {
+        if (bitPos > bitCount || bitCount - bitPos < static_cast<std::size_t>(bits)) {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < bits; ++i, ++bitPos) {
+            value = (value << 1) | ((data[bitPos >> 3] >> (7 - (bitPos & 7))) & 1u);
+        }
+        return true;
+    }
+
+    void AlignToByte() {
+        bitPos = (bitPos + 7) & ~std::size_t(7);
+    }
+
+private:
+    const uint8_t *data;
+    std::size_t bitCount;
+    std::size_t bitPos;
+};
+
+// ceil(log2(2 * count)), the width of the zigzag-encoded index deltas
+static int IndexDeltaBits(uint32_t count) {
+    int bits = 0;
+    while ((uint64_t(1) << bits) < 2 * uint64_t(count)) {
+        ++bits;
+    }
+    return bits;
+}
+
+static int32_t DecodeZigZag(uint32_t value) {
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+static bool AppendTriangles(uint32_t indexType, const std::vector<GLushort> &list,
+                            std::vector<GLushort> &triangles) {
+    switch (static_cast<MeshIndexType>(indexType)) {
+        case MeshIndexType::TRIANGLES:
+            for (std::size_t i = 0; i + 2 < list.size(); i += 3) {
+                triangles.insert(triangles.end(), {list[i], list[i + 1], list[i + 2]});
+            }
+            return true;
+
+        case MeshIndexType::TRIANGLE_STRIP:
+            for (std::size_t i = 2; i < list.size(); ++i) {
+                if (i % 2 == 0) {
+                    triangles.insert(triangles.end(), {list[i - 2], list[i - 1], list[i]});
+                } else {
+                    triangles.insert(triangles.end(), {list[i - 1], list[i - 2], list[i]});
+                }
+            }
+            return true;
+
+        case MeshIndexType::TRIANGLE_FAN:
+            for (std::size_t i = 2; i < list.size(); ++i) {
+                triangles.insert(triangles.end(), {list[0], list[i - 1], list[i]});
+            }
+            return true;
+
+        default:
+            LOG_ERROR("Unsupported projection mesh index type %u", indexType);
+            return false;
+    }
+}
+
+static bool ParseMeshBox(const uint8_t *begin, const uint8_t *end,
+                         TexturedMesh::Builder &meshBuilder) {
+    BitReader reader(begin, end);
+
+    uint32_t coordinateCount;
+    if (!reader.Read(32, coordinateCount)) {
+        return false;
+    }
+    coordinateCount &= COUNT_MASK;
+    if (coordinateCount > static_cast<std::size_t>(end - begin) / sizeof(float)) {
+        return false;
+    }
+    std::vector<float> coordinates(coordinateCount);
+    for (float &coordinate: coordinates) {
+        uint32_t bits;
+        if (!reader.Read(32, bits)) {
+            return false;
+        }
+        std::memcpy(&coordinate, &bits, sizeof(coordinate));
+    }
+
+    uint32_t vertexCount;
+    if (!reader.Read(32, vertexCount)) {
+        return false;
+    }
+    vertexCount &= COUNT_MASK;
+    if (vertexCount > MAX_MESH_VERTICES) {
+        LOG_ERROR("Too many projection mesh vertices (%u)", vertexCount);
+        return false;
+    }
+
+    // every vertex component is a delta-coded index into the coordinate list
+    const int coordinateIndexBits = IndexDeltaBits(coordinateCount);
+    std::vector<MeshVertex> vertices(vertexCount);
+    std::array<int64_t, 5> coordinateIndices{};
+    for (MeshVertex &vertex: vertices) {
+        std::array<float, 5> values{};
+        for (std::size_t k = 0; k < values.size(); ++k) {
+            uint32_t delta;
+            if (!reader.Read(coordinateIndexBits, delta)) {
+                return false;
+            }
+            coordinateIndices[k] += DecodeZigZag(delta);
+            if (coordinateIndices[k] < 0 || coordinateIndices[k] >= coordinateCount) {
+                return false;
+            }
+            values[k] = coordinates[coordinateIndices[k]];
+        }
+        // the mesh has the texture origin at the bottom
+        vertex = {{values[0], values[1], values[2]},
+                  {values[3], 1.0f - values[4]}};
+    }
+    reader.AlignToByte();
+
+    uint32_t vertexListCount;
+    if (!reader.Read(32, vertexListCount)) {
+        return false;
+    }
+    vertexListCount &= COUNT_MASK;
+
+    const int vertexIndexBits = IndexDeltaBits(vertexCount);
+    std::vector<GLushort> triangles;
+    std::vector<GLushort> list;
+    for (uint32_t l = 0; l < vertexListCount; ++l) {
+        uint32_t textureId, indexType, indexCount;
+        if (!reader.Read(8, textureId) || !reader.Read(8, indexType) ||
+            !reader.Read(32, indexCount)) {
+            return false;
+        }
+        indexCount &= COUNT_MASK;
+
+        list.clear();
+        int64_t index = 0;
+        for (uint32_t i = 0; i < indexCount; ++i) {
+            uint32_t delta;
+            if (!reader.Read(vertexIndexBits, delta)) {
+                return false;
+            }
+            index += DecodeZigZag(delta);
+            if (index < 0 || index >= vertexCount) {
+                return false;
+            }
+            list.push_back(static_cast<GLushort>(index));
+        }
+
+        if (!AppendTriangles(indexType, list, triangles)) {
+            return false;
+        }
+    }
+
+    if (triangles.empty()) {
+        return false;
+    }
+
+    AddScaledMesh(vertices, triangles, meshBuilder);
+    return true;
+}
+
+static bool ParseProjectionMeshBox(const uint8_t *begin, const uint8_t *end,
+                                   std::vector<TexturedMesh::Builder> &meshes) {
+    if (end - begin < PROJECTION_MESH_HEADER_SIZE) {
+        return false;
+    }
+    const uint32_t encoding = ReadU32(begin + 8);
+    const uint8_t *meshesBegin = begin + PROJECTION_MESH_HEADER_SIZE;
+    const uint8_t *meshesEnd = end;
+
+    std::vector<uint8_t> inflated;
+    if (encoding == ENCODING_DEFLATE) {
+        if (!InflateRaw(meshesBegin, meshesEnd, inflated)) {
+            return false;
+        }
+        meshesBegin = inflated.data();
+        meshesEnd = inflated.data() + inflated.size();
+    } else if (encoding != ENCODING_RAW) {
+        LOG_ERROR("Unsupported projection mesh encoding 0x%08x", encoding);
+        return false;
+    }
+
+    bool valid = true;
+    ForEachBox(meshesBegin, meshesEnd, [&](uint32_t type, const uint8_t *payload,
+                                           const uint8_t *payloadEnd) {
+        if (type != BOX_MESH) {
+            return false;
+        }
+        meshes.emplace_back();
+        valid = ParseMeshBox(payload, payloadEnd, meshes.back());
+        return !valid;
+    });
+    return valid && !meshes.empty();
+}
+
+bool ImportSv3dMeshes(int fd, std::vector<TexturedMesh::Builder> &meshes) {
+    std::vector<uint8_t> movieBox;
+    if (!ReadMovieBox(fd, movieBox)) {
+        LOG_DEBUG("No movie box found");
+        return false;
+    }
+
+    const uint8_t *meshBoxBegin = nullptr;
+    const uint8_t *meshBoxEnd = nullptr;
+    if (!FindProjectionMeshBox(movieBox.data(), movieBox.data() + movieBox.size(), false,
+                               meshBoxBegin, meshBoxEnd)) {
+        // not a mesh projection video, that is the usual case
+        return false;
+    }
+
+    if (!ParseProjectionMeshBox(meshBoxBegin, meshBoxEnd, meshes)) {
+        LOG_ERROR("Invalid sv3d projection mesh");
+        meshes.clear();
+        return false;
+    }
+
+    LOG_DEBUG("Imported %zu sv3d projection meshes", meshes.size());
+    return true;
+}
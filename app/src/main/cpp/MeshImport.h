@@ -0,0 +1,22 @@
+#ifndef VR_VIDEO_PLAYER_MESHIMPORT_H
+#define VR_VIDEO_PLAYER_MESHIMPORT_H
+
+#include <string>
+#include <vector>
+
+#include "TexturedMesh.h"
+
+/**
+ * Imports a textured Wavefront OBJ mesh (e.g. a dome or curved cinema screen model). Polygons are
+ * triangulated as fans, and the mesh is scaled uniformly so that its farthest vertex is at
+ * distance 1 from the viewer at the origin, which keeps its look but fits the depth range.
+ */
+bool ImportObjMesh(const std::string &path, TexturedMesh::Builder &meshBuilder);
+
+/**
+ * Imports the sv3d mshp projection meshes embedded in an MP4 file: one mesh for monoscopic video,
+ * or two (left eye, right eye) for stereoscopic video. The file descriptor is not closed.
+ */
+bool ImportSv3dMeshes(int fd, std::vector<TexturedMesh::Builder> &meshes);
+
+#endif //VR_VIDEO_PLAYER_MESHIMPORT_H
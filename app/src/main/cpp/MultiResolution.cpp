@@ -0,0 +1,91 @@
+#include "MultiResolution.h"
+
+#include <cmath>
+
+#include "glm/common.hpp"
+
+MultiResolution::MultiResolution() :
+        enabled(false),
+        centerBounds{0.0f, 0.0f, 1.0f, 1.0f},
+        peripheryDensity{1.0f, 1.0f} {
+}
+
+void MultiResolution::SetLayout(const glm::vec4 &newCenterBounds,
+                                const glm::vec2 &newPeripheryDensity) {
+    enabled = true;
+    centerBounds = newCenterBounds;
+    peripheryDensity = newPeripheryDensity;
+}
+
+void MultiResolution::Disable() {
+    enabled = false;
+    centerBounds = {0.0f, 0.0f, 1.0f, 1.0f};
+    peripheryDensity = {1.0f, 1.0f};
+}
+
+glm::vec2 MultiResolution::GetPackedScale() const {
+    const glm::vec2 low{centerBounds.x, centerBounds.y};
+    const glm::vec2 high{centerBounds.z, centerBounds.w};
+    return peripheryDensity * (low + 1.0f - high) + high - low;
+}
+
+/**
+ * Splits one axis of a packed view into the spans of the low periphery, the center and the high
+ * periphery, as viewport start and size plus the clip scale and offset of each.
+ */
+static void SplitAxis(float low, float high, float density, GLint start, GLsizei size,
+                      std::array<glm::ivec2, 3> &spans, std::array<glm::vec2, 3> &transforms) {
+    const float packedSize = density * (low + 1.0f - high) + high - low;
+    auto packed = [&](float u) {
+        const float p = density * (std::min(u, low) + std::max(u - high, 0.0f)) +
+                        glm::clamp(u, low, high) - low;
+        return float(size) * p / packedSize;
+    };
+
+    const std::array<float, 4> edges{0.0f, low, high, 1.0f};
+    for (int i = 0; i < 3; ++i) {
+        const float p0 = packed(edges[i]);
+        const float p1 = packed(edges[i + 1]);
+        // neighbors share the rounded edge, so the viewports tile the view without gaps
+        const auto r0 = GLint(std::lround(p0));
+        const auto r1 = GLint(std::lround(p1));
+        spans[i] = {start + r0, r1 - r0};
+        if (r1 <= r0) {
+            transforms[i] = {1.0f, 0.0f};
+            continue;
+        }
+
+        // packed position = a * view NDC + b within the span, mapped onto the rounded viewport
+        const float a = 0.5f * (p1 - p0) / (edges[i + 1] - edges[i]);
+        const float b = p0 + (0.5f - edges[i]) * 2.0f * a;
+        const float viewportSize = float(r1 - r0);
+        transforms[i] = {2.0f * a / viewportSize, 2.0f * (b - float(r0)) / viewportSize - 1.0f};
+    }
+}
+
+int MultiResolution::GetRegions(GLint x, GLsizei width, GLsizei height,
+                                std::array<Region, REGION_COUNT> &regions) const {
+    if (!enabled) {
+        regions[0] = {{x, 0, width, height}, {1.0f, 1.0f, 0.0f, 0.0f}};
+        return 1;
+    }
+
+    std::array<glm::ivec2, 3> columns{};
+    std::array<glm::vec2, 3> columnTransforms{};
+    std::array<glm::ivec2, 3> rows{};
+    std::array<glm::vec2, 3> rowTransforms{};
+    SplitAxis(centerBounds.x, centerBounds.z, peripheryDensity.x, x, width, columns,
+              columnTransforms);
+    SplitAxis(centerBounds.y, centerBounds.w, peripheryDensity.y, 0, height, rows, rowTransforms);
+
+    for (int row = 0; row < 3; ++row) {
+        for (int column = 0; column < 3; ++column) {
+            regions[row * 3 + column] = {
+                    {columns[column].x, rows[row].x, columns[column].y, rows[row].y},
+                    {columnTransforms[column].x, rowTransforms[row].x,
+                     columnTransforms[column].y, rowTransforms[row].y}
+            };
+        }
+    }
+    return REGION_COUNT;
+}
@@ -0,0 +1,70 @@
+#ifndef VR_VIDEO_PLAYER_MULTIRESOLUTION_H
+#define VR_VIDEO_PLAYER_MULTIRESOLUTION_H
+
+#include <array>
+
+#include <GLES2/gl2.h>
+
+#include "glm/vec2.hpp"
+#include "glm/vec4.hpp"
+
+/**
+ * Lens-matched multi-resolution shading: the eye view is split into a 3 x 3 grid of regions, the
+ * center one rendered at full density and the periphery at the lower density the lens
+ * magnification needs there. The regions are packed next to each other into a smaller eye buffer,
+ * which stays continuous, just scaled differently in every column and row of the grid.
+ */
+class MultiResolution {
+public:
+    static constexpr int REGION_COUNT = 9;
+
+    struct Region {
+        // x, y, width, height
+        glm::ivec4 viewport;
+        // clip space xy scale and offset stretching the part of the view onto the viewport
+        glm::vec4 transform;
+    };
+
+    MultiResolution();
+
+    /**
+     * Sets the full density region in eye texture coordinates (left, bottom, right, top) and the
+     * density of the rest, per axis.
+     */
+    void SetLayout(const glm::vec4 &centerBounds, const glm::vec2 &peripheryDensity);
+
+    /**
+     * Goes back to a single full density region.
+     */
+    void Disable();
+
+    bool IsEnabled() const {
+        return enabled;
+    }
+
+    const glm::vec4 &GetCenterBounds() const {
+        return centerBounds;
+    }
+
+    const glm::vec2 &GetPeripheryDensity() const {
+        return peripheryDensity;
+    }
+
+    /**
+     * Size of the packed view relative to the full density one.
+     */
+    glm::vec2 GetPackedScale() const;
+
+    /**
+     * Splits a packed view of the given size placed at x into the regions; returns their count.
+     */
+    int GetRegions(GLint x, GLsizei width, GLsizei height,
+                   std::array<Region, REGION_COUNT> &regions) const;
+
+private:
+    bool enabled;
+    glm::vec4 centerBounds;
+    glm::vec2 peripheryDensity;
+};
+
+#endif //VR_VIDEO_PLAYER_MULTIRESOLUTION_H
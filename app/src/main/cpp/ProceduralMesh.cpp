@@ -0,0 +1,58 @@
+#include "ProceduralMesh.h"
+
+#include <GLES3/gl3.h>
+
+// two triangles per grid cell
+static constexpr int VERTICES_PER_CELL = 6;
+
+ProceduralMesh::ProceduralMesh() :
+        params{},
+        vertexCount(0) {
+}
+
+ProceduralMesh::ProceduralMesh(Shape shape, int n_slices, int n_stacks, float minTheta,
+                               float maxTheta, float uvLeft, float uvTop, float uvRight,
+                               float uvBottom) :
+        params{
+                {n_slices, n_stacks, static_cast<int>(shape), 0},
+                {minTheta, maxTheta, 0.0f, 0.0f},
+                {uvLeft, uvTop, uvRight, uvBottom}
+        },
+        vertexCount(n_slices * n_stacks * VERTICES_PER_CELL) {
+}
+
+ProceduralMesh
+ProceduralMesh::UvSphere(int n_slices, int n_stacks, float minTheta, float maxTheta, float uvLeft,
+                         float uvTop, float uvRight, float uvBottom) {
+    return {Shape::UV_SPHERE, n_slices, n_stacks, minTheta, maxTheta, uvLeft, uvTop, uvRight,
+            uvBottom};
+}
+
+ProceduralMesh
+ProceduralMesh::Cylinder(int n_slices, float minTheta, float maxTheta, float uvLeft, float uvTop,
+                         float uvRight, float uvBottom) {
+    return {Shape::CYLINDER, n_slices, 1, minTheta, maxTheta, uvLeft, uvTop, uvRight, uvBottom};
+}
+
+bool ProceduralMesh::IsEmpty() const {
+    return vertexCount == 0;
+}
+
+const ProceduralMesh::GridParams &ProceduralMesh::Params() const {
+    return params;
+}
+
+void ProceduralMesh::Upload(GLuint uniformBuffer) const {
+    glBindBuffer(GL_UNIFORM_BUFFER, uniformBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(params), &params, GL_STATIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void ProceduralMesh::Render(GLsizei instanceCount) const {
+    if (vertexCount == 0) {
+        // uninitialized/empty mesh
+        return;
+    }
+
+    glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, instanceCount);
+}
@@ -0,0 +1,58 @@
+#ifndef VR_VIDEO_PLAYER_PROCEDURALMESH_H
+#define VR_VIDEO_PLAYER_PROCEDURALMESH_H
+
+#include <GLES3/gl3.h>
+
+#include "glm/vec4.hpp"
+
+/**
+ * A regular sphere or cylinder grid whose vertices are computed in the vertex shader from
+ * gl_VertexID, so no vertex data is stored or uploaded; only the grid parameters are needed.
+ */
+class ProceduralMesh {
+public:
+    enum class Shape {
+        NONE = 0,
+        UV_SPHERE = 1,
+        CYLINDER = 2,
+    };
+
+    /**
+     * CPU mirror of the std140 MeshGrid uniform block.
+     */
+    struct GridParams {
+        // slices, stacks, shape, unused
+        glm::ivec4 grid;
+        // minTheta, maxTheta, unused, unused
+        glm::vec4 thetaRange;
+        // left, top, right, bottom
+        glm::vec4 uvRect;
+    };
+
+    ProceduralMesh();
+
+    static ProceduralMesh
+    UvSphere(int n_slices, int n_stacks, float minTheta, float maxTheta, float uvLeft, float uvTop,
+             float uvRight, float uvBottom);
+
+    static ProceduralMesh
+    Cylinder(int n_slices, float minTheta, float maxTheta, float uvLeft, float uvTop,
+             float uvRight, float uvBottom);
+
+    bool IsEmpty() const;
+
+    const GridParams &Params() const;
+
+    void Upload(GLuint uniformBuffer) const;
+
+    void Render(GLsizei instanceCount = 1) const;
+
+private:
+    ProceduralMesh(Shape shape, int n_slices, int n_stacks, float minTheta, float maxTheta,
+                   float uvLeft, float uvTop, float uvRight, float uvBottom);
+
+    GridParams params;
+    GLsizei vertexCount;
+};
+
+#endif //VR_VIDEO_PLAYER_PROCEDURALMESH_H
@@ -0,0 +1,252 @@
+#include "ProgramCache.h"
+
+#include <cinttypes>
+#include <cstdlib>
+#include <cstdio>
+
+#include <algorithm>
+#include <mutex>
+
+#include <unistd.h>
+
+#include <GLES2/gl2ext.h>
+
+#include "GLExtensions.h"
+#include "logger.h"
+
+#define LOG_TAG "VRVideoPlayerP"
+
+static constexpr uint32_t PROGRAM_CACHE_MAGIC = 0x47525056; // "VPRG"
+// bump whenever the layout changes, older files are then just rebuilt
+static constexpr uint32_t PROGRAM_CACHE_VERSION = 1;
+// far more than any of the programs needs, a larger length means a corrupted file
+static constexpr uint32_t MAX_BINARY_LENGTH = 16 * 1024 * 1024;
+
+// FNV-1a
+static constexpr uint64_t HASH_SEED = 0xcbf29ce484222325ULL;
+static constexpr uint64_t HASH_PRIME = 0x100000001b3ULL;
+
+struct ProgramCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t driverHash;
+    uint64_t sourceHash;
+    uint32_t binaryFormat;
+    uint32_t binaryLength;
+};
+
+static std::mutex cacheDirectoryMutex;
+static std::string cacheDirectory;
+
+void SetProgramCacheDirectory(const std::string &path) {
+    std::lock_guard<std::mutex> lock(cacheDirectoryMutex);
+    cacheDirectory = path;
+}
+
+/**
+ * The file of the program; a newer driver overwrites the binaries of the older one.
+ */
+static std::string CachePath(uint64_t sourceHash) {
+    std::lock_guard<std::mutex> lock(cacheDirectoryMutex);
+    if (cacheDirectory.empty()) {
+        return {};
+    }
+    char name[24];
+    snprintf(name, sizeof(name), "/%016" PRIx64 ".bin", sourceHash);
+    return cacheDirectory + name;
+}
+
+static uint64_t Hash(uint64_t hash, const char *text) {
+    for (; *text != '\0'; ++text) {
+        hash = (hash ^ static_cast<uint8_t>(*text)) * HASH_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * Leaves the status to Finish, reading it would wait for a background compilation.
+ */
+static GLuint CompileShader(GLenum type, const std::string &source) {
+    const GLuint shader = glCreateShader(type);
+    const char *sourceText = source.c_str();
+    glShaderSource(shader, 1, &sourceText, nullptr);
+    glCompileShader(shader);
+    return shader;
+}
+
+static void LogShaderInfo(GLuint shader) {
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    GLint infoLength = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLength);
+    if (compiled || infoLength <= 0) {
+        return;
+    }
+    std::vector<char> info(static_cast<std::size_t>(infoLength));
+    glGetShaderInfoLog(shader, infoLength, nullptr, info.data());
+    LOG_ERROR("Could not compile shader: %s", info.data());
+}
+
+ProgramCache::ProgramCache() :
+        driverHash(HASH_SEED),
+        binariesSupported(false) {
+}
+
+void ProgramCache::GlSetup() {
+    // the programs of the previous context are gone with it
+    pending.clear();
+
+    driverHash = HASH_SEED;
+    for (GLenum name: {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+        const auto *value = reinterpret_cast<const char *>(glGetString(name));
+        driverHash = Hash(driverHash, value != nullptr ? value : "");
+    }
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    binariesSupported = formatCount > 0;
+
+    if (GetGLExtensions().parallelShaderCompile) {
+        // as many compiler threads as the driver finds reasonable
+        GetGLExtensions().glMaxShaderCompilerThreadsKHR(0xffffffffu);
+    }
+}
+
+GLuint ProgramCache::Start(const std::string &vertexSource, const std::string &fragmentSource) {
+    const uint64_t sourceHash =
+            Hash(Hash(Hash(HASH_SEED, vertexSource.c_str()), "\n"), fragmentSource.c_str());
+
+    PendingProgram entry{glCreateProgram(), sourceHash, 0, 0};
+    if (!LoadBinary(entry.program, sourceHash)) {
+        entry.vertexShader = CompileShader(GL_VERTEX_SHADER, vertexSource);
+        entry.fragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentSource);
+        glAttachShader(entry.program, entry.vertexShader);
+        glAttachShader(entry.program, entry.fragmentShader);
+        if (binariesSupported) {
+            glProgramParameteri(entry.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+        glLinkProgram(entry.program);
+    }
+    pending.push_back(entry);
+    return entry.program;
+}
+
+bool ProgramCache::Finish(GLuint &program) {
+    const auto found = std::find_if(pending.begin(), pending.end(),
+                                    [program](const PendingProgram &entry) {
+                                        return entry.program == program;
+                                    });
+    if (found == pending.end()) {
+        return false;
+    }
+    const PendingProgram entry = *found;
+    pending.erase(found);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        LogShaderInfo(entry.vertexShader);
+        LogShaderInfo(entry.fragmentShader);
+        GLint infoLength = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLength);
+        std::vector<char> info(static_cast<std::size_t>(std::max(infoLength, 1)));
+        glGetProgramInfoLog(program, GLsizei(info.size()), nullptr, info.data());
+        LOG_ERROR("Could not link program: %s", info.data());
+    } else if (entry.vertexShader != 0 && binariesSupported) {
+        StoreBinary(program, entry.sourceHash);
+    }
+
+    // a linked program keeps working without its shaders
+    if (entry.vertexShader != 0) {
+        glDetachShader(program, entry.vertexShader);
+        glDetachShader(program, entry.fragmentShader);
+        glDeleteShader(entry.vertexShader);
+        glDeleteShader(entry.fragmentShader);
+    }
+    if (!linked) {
+        glDeleteProgram(program);
+        program = 0;
+        return false;
+    }
+    return true;
+}
+
+bool ProgramCache::LoadBinary(GLuint program, uint64_t sourceHash) const {
+    const std::string path = CachePath(sourceHash);
+    if (!binariesSupported || path.empty()) {
+        return false;
+    }
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    ProgramCacheHeader header{};
+    std::vector<uint8_t> binary;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+              header.magic == PROGRAM_CACHE_MAGIC && header.version == PROGRAM_CACHE_VERSION &&
+              header.driverHash == driverHash && header.sourceHash == sourceHash &&
+              header.binaryLength > 0 && header.binaryLength <= MAX_BINARY_LENGTH;
+    if (ok) {
+        binary.resize(header.binaryLength);
+        ok = fread(binary.data(), binary.size(), 1, file) == 1;
+    }
+    fclose(file);
+
+    if (ok) {
+        glProgramBinary(program, header.binaryFormat, binary.data(),
+                        static_cast<GLsizei>(binary.size()));
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        ok = linked == GL_TRUE;
+    }
+    if (!ok) {
+        // a binary of another driver version, or corrupted; it is replaced once compiled. An
+        // unknown binary format is an error, which is expected here and must not be reported
+        // by the next error check.
+        LOG_DEBUG("Ignoring stale program binary %s", path.c_str());
+        glGetError();
+        return false;
+    }
+    return true;
+}
+
+void ProgramCache::StoreBinary(GLuint program, uint64_t sourceHash) const {
+    const std::string path = CachePath(sourceHash);
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (path.empty() || length <= 0 || uint32_t(length) > MAX_BINARY_LENGTH) {
+        return;
+    }
+
+    std::vector<uint8_t> binary(static_cast<std::size_t>(length));
+    GLenum binaryFormat = 0;
+    glGetProgramBinary(program, length, &length, &binaryFormat, binary.data());
+    if (length <= 0) {
+        return;
+    }
+    const ProgramCacheHeader header{PROGRAM_CACHE_MAGIC, PROGRAM_CACHE_VERSION, driverHash,
+                                    sourceHash, binaryFormat, static_cast<uint32_t>(length)};
+
+    // write into a temporary file first, so a partially written binary is never loaded; the
+    // compositor thread may be storing the same program at the same time, each thread writes its
+    // own file, and the last rename wins
+    std::string tempPath = path + ".XXXXXX";
+    const int fd = mkstemp(&tempPath[0]);
+    FILE *file = fd >= 0 ? fdopen(fd, "wb") : nullptr;
+    if (file == nullptr) {
+        LOG_ERROR("Cannot create program binary %s", tempPath.c_str());
+        if (fd >= 0) {
+            close(fd);
+            unlink(tempPath.c_str());
+        }
+        return;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(binary.data(), static_cast<std::size_t>(length), 1, file) == 1;
+    ok = (fclose(file) == 0) && ok;
+
+    if (!ok || rename(tempPath.c_str(), path.c_str()) != 0) {
+        LOG_ERROR("Cannot write program binary %s", path.c_str());
+        unlink(tempPath.c_str());
+    }
+}
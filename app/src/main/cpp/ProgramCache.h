@@ -0,0 +1,60 @@
+#ifndef VR_VIDEO_PLAYER_PROGRAMCACHE_H
+#define VR_VIDEO_PLAYER_PROGRAMCACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <GLES3/gl3.h>
+
+/**
+ * Sets the directory where the program binaries are kept for all the ProgramCache instances;
+ * until then, programs are always compiled.
+ */
+void SetProgramCacheDirectory(const std::string &path);
+
+/**
+ * Builds programs in the current context from the binaries stored by an earlier run with the
+ * same driver, keyed by a hash of their sources, or else by compiling the sources and storing the
+ * result. Programs are started first and finished together, so compiling them can overlap, in the
+ * background of the driver where KHR_parallel_shader_compile is supported.
+ */
+class ProgramCache {
+public:
+    ProgramCache();
+
+    /**
+     * Called in a new context, before starting any program.
+     */
+    void GlSetup();
+
+    /**
+     * Starts building the program; it can only be used after Finish.
+     */
+    GLuint Start(const std::string &vertexSource, const std::string &fragmentSource);
+
+    /**
+     * Waits for the program to link and stores the binary of a compiled one. Returns false, with
+     * the program deleted, if it failed to link; the name is then 0.
+     */
+    bool Finish(GLuint &program);
+
+private:
+    struct PendingProgram {
+        GLuint program;
+        uint64_t sourceHash;
+        // zero for programs loaded from a binary
+        GLuint vertexShader;
+        GLuint fragmentShader;
+    };
+
+    uint64_t driverHash;
+    bool binariesSupported;
+    std::vector<PendingProgram> pending;
+
+    bool LoadBinary(GLuint program, uint64_t sourceHash) const;
+
+    void StoreBinary(GLuint program, uint64_t sourceHash) const;
+};
+
+#endif //VR_VIDEO_PLAYER_PROGRAMCACHE_H
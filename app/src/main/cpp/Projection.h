@@ -0,0 +1,284 @@
+#ifndef VR_VIDEO_PLAYER_PROJECTION_H
+#define VR_VIDEO_PLAYER_PROJECTION_H
+
+#include <cmath>
+
+#include <initializer_list>
+#include <string>
+
+#include "glm/vec2.hpp"
+#include "glm/vec3.hpp"
+#include "glm/vec4.hpp"
+#include "glm/common.hpp"
+#include "glm/geometric.hpp"
+
+/*
+ * Video projections, i.e. mappings between view directions and video texture coordinates.
+ *
+ * All of them share one convention: y is up and the viewer looks along -z; the longitude θ starts
+ * at +z and grows to the right (θ = π is straight ahead); the elevation goes from -π/2 (down) to
+ * π/2 (up); the texture origin is at the top left.
+ *
+ * Every projection type provides:
+ * - ToUV: direction to texture coordinates,
+ * - ToDirection: texture coordinates to a unit direction,
+ * - FaceSurface: point for mesh vertices, on the same ray as ToDirection, but on the surface where
+ *   the projection is (nearly) linear, so that triangles interpolate the texture correctly,
+ * They are plain structs used as template arguments, so every consumer gets inlined code.
+ */
+
+static constexpr float PROJECTION_PI = 3.14159265358979f;
+
+inline glm::vec3 DirectionFromAngles(float theta, float elevation) {
+    return {
+            std::cos(elevation) * std::sin(-theta),
+            std::sin(elevation),
+            std::cos(elevation) * std::cos(-theta)
+    };
+}
+
+inline float DirectionLongitude(const glm::vec3 &direction) {
+    return -std::atan2(direction.x, direction.z);
+}
+
+inline float DirectionElevation(const glm::vec3 &direction) {
+    return std::asin(glm::clamp(direction.y / glm::length(direction), -1.0f, 1.0f));
+}
+
+/**
+ * Shifts the longitude by whole turns into [minTheta, minTheta + 2π).
+ */
+inline float WrapLongitude(float theta, float minTheta) {
+    const float turn = 2.0f * PROJECTION_PI;
+    return theta - turn * std::floor((theta - minTheta) / turn);
+}
+
+/**
+ * Equirectangular (latitude/longitude) projection of the [minTheta, maxTheta] longitude range.
+ */
+struct EquirectProjection {
+    static constexpr int FACE_COUNT = 1;
+
+    float minTheta;
+    float maxTheta;
+
+    glm::vec2 ToUV(const glm::vec3 &direction) const {
+        const float theta = WrapLongitude(DirectionLongitude(direction), minTheta);
+        return {
+                (theta - minTheta) / (maxTheta - minTheta),
+                0.5f - DirectionElevation(direction) / PROJECTION_PI
+        };
+    }
+
+    glm::vec3 ToDirection(const glm::vec2 &uv) const {
+        return DirectionFromAngles(minTheta + (maxTheta - minTheta) * uv.x,
+                                   (0.5f - uv.y) * PROJECTION_PI);
+    }
+
+    glm::vec4 FaceUVRect(int /* face */) const {
+        return {0.0f, 0.0f, 1.0f, 1.0f};
+    }
+
+    glm::vec3 FaceSurface(int /* face */, const glm::vec2 &st) const {
+        return ToDirection(st);
+    }
+
+    // FaceSurface for the procedural mesh shader, with minTheta and maxTheta in params.xy
+    static const char *Glsl() {
+        return R"glsl(
+vec3 EquirectToSurface(vec2 uv, vec4 params) {
+  float theta = -mix(params.x, params.y, uv.x);
+  float elevation = (0.5 - uv.y) * 3.14159265;
+  return vec3(cos(elevation) * sin(theta), sin(elevation), cos(elevation) * cos(theta));
+}
+)glsl";
+    }
+};
+
+/**
+ * Cylindrical panorama of the [minTheta, maxTheta] longitude range, on a cylinder of radius 1 and
+ * height 2 (i.e. 90° vertical field of view).
+ */
+struct CylindricalProjection {
+    static constexpr int FACE_COUNT = 1;
+
+    float minTheta;
+    float maxTheta;
+
+    glm::vec2 ToUV(const glm::vec3 &direction) const {
+        const float theta = WrapLongitude(DirectionLongitude(direction), minTheta);
+        const float y = direction.y / std::hypot(direction.x, direction.z);
+        return {(theta - minTheta) / (maxTheta - minTheta), 0.5f - 0.5f * y};
+    }
+
+    glm::vec3 ToDirection(const glm::vec2 &uv) const {
+        return glm::normalize(FaceSurface(0, uv));
+    }
+
+    glm::vec4 FaceUVRect(int /* face */) const {
+        return {0.0f, 0.0f, 1.0f, 1.0f};
+    }
+
+    glm::vec3 FaceSurface(int /* face */, const glm::vec2 &st) const {
+        const float theta = -(minTheta + (maxTheta - minTheta) * st.x);
+        return {std::sin(theta), 1.0f - 2.0f * st.y, std::cos(theta)};
+    }
+
+    // FaceSurface for the procedural mesh shader, with minTheta and maxTheta in params.xy
+    static const char *Glsl() {
+        return R"glsl(
+vec3 CylindricalToSurface(vec2 uv, vec4 params) {
+  float theta = -mix(params.x, params.y, uv.x);
+  return vec3(sin(theta), 1.0 - 2.0 * uv.y, cos(theta));
+}
+)glsl";
+    }
+};
+
+/**
+ * One face of the 3x2 cube layout: the top row holds the left, front and right faces, the bottom
+ * row the bottom, back and top faces rotated by 90° clockwise. The face index is the cell index.
+ */
+struct CubeFace {
+    glm::vec3 center;
+    // directions of increasing u and decreasing v within the cell
+    glm::vec3 right;
+    glm::vec3 up;
+};
+
+constexpr CubeFace CubeLayoutFace(int face) {
+    switch (face) {
+        case 0: // left
+            return {{-1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f}, {0.0f, 1.0f, 0.0f}};
+        case 1: // front
+            return {{0.0f, 0.0f, -1.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+        case 2: // right
+            return {{1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f}};
+        case 3: // bottom
+            return {{0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, -1.0f}, {-1.0f, 0.0f, 0.0f}};
+        case 4: // back
+            return {{0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}};
+        default: // top
+            return {{0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {-1.0f, 0.0f, 0.0f}};
+    }
+}
+
+/**
+ * Cube map in the 3x2 layout; the equi-angular variant (EAC) spaces the texels uniformly by angle
+ * instead of by distance on the cube face.
+ */
+template<bool EQUIANGULAR>
+struct CubeProjection {
+    static constexpr int FACE_COUNT = 6;
+
+    glm::vec2 ToUV(const glm::vec3 &direction) const {
+        const glm::vec3 a = glm::abs(direction);
+        int face;
+        if (a.x >= a.y && a.x >= a.z) {
+            face = direction.x < 0.0f ? 0 : 2;
+        } else if (a.z >= a.y) {
+            face = direction.z < 0.0f ? 1 : 4;
+        } else {
+            face = direction.y < 0.0f ? 3 : 5;
+        }
+
+        const CubeFace cubeFace = CubeLayoutFace(face);
+        const float depth = glm::dot(direction, cubeFace.center);
+        const glm::vec2 faceCoord = {
+                FromCube(glm::dot(direction, cubeFace.right) / depth),
+                FromCube(glm::dot(direction, cubeFace.up) / depth)
+        };
+        const glm::vec4 rect = FaceUVRect(face);
+        return {
+                rect.x + (rect.z - rect.x) * (0.5f + 0.5f * faceCoord.x),
+                rect.y + (rect.w - rect.y) * (0.5f - 0.5f * faceCoord.y)
+        };
+    }
+
+    glm::vec3 ToDirection(const glm::vec2 &uv) const {
+        const int cellX = glm::clamp(static_cast<int>(uv.x * 3.0f), 0, 2);
+        const int cellY = glm::clamp(static_cast<int>(uv.y * 2.0f), 0, 1);
+        const glm::vec2 st = {uv.x * 3.0f - float(cellX), uv.y * 2.0f - float(cellY)};
+        return glm::normalize(FaceSurface(cellY * 3 + cellX, st));
+    }
+
+    glm::vec4 FaceUVRect(int face) const {
+        const float cellX = float(face % 3);
+        const float cellY = float(face / 3);
+        return {cellX / 3.0f, cellY / 2.0f, (cellX + 1.0f) / 3.0f, (cellY + 1.0f) / 2.0f};
+    }
+
+    glm::vec3 FaceSurface(int face, const glm::vec2 &st) const {
+        const CubeFace cubeFace = CubeLayoutFace(face);
+        return cubeFace.center +
+               ToCube(2.0f * st.x - 1.0f) * cubeFace.right +
+               ToCube(1.0f - 2.0f * st.y) * cubeFace.up;
+    }
+
+private:
+    // face coordinates in [-1, 1] as stored in the texture to/from the position on the cube face
+    static float ToCube(float faceCoord) {
+        return EQUIANGULAR ? std::tan(faceCoord * PROJECTION_PI * 0.25f) : faceCoord;
+    }
+
+    static float FromCube(float cubeCoord) {
+        return EQUIANGULAR ? std::atan(cubeCoord) * 4.0f / PROJECTION_PI : cubeCoord;
+    }
+};
+
+using CubemapProjection = CubeProjection<false>;
+using EacProjection = CubeProjection<true>;
+
+/**
+ * Equidistant fisheye looking straight ahead, with the image circle inscribed in the texture;
+ * fov is the full angle the image circle covers.
+ */
+struct FisheyeProjection {
+    static constexpr int FACE_COUNT = 1;
+
+    float fov;
+
+    glm::vec2 ToUV(const glm::vec3 &direction) const {
+        const float planar = std::hypot(direction.x, direction.y);
+        const float r = std::atan2(planar, -direction.z) / fov;
+        if (planar <= 0.0f) {
+            return {0.5f, 0.5f + r};
+        }
+        return {0.5f + r * direction.x / planar, 0.5f - r * direction.y / planar};
+    }
+
+    glm::vec3 ToDirection(const glm::vec2 &uv) const {
+        const glm::vec2 p = {uv.x - 0.5f, 0.5f - uv.y};
+        const float r = glm::length(p);
+        if (r <= 0.0f) {
+            return {0.0f, 0.0f, -1.0f};
+        }
+        const float alpha = r * fov;
+        const float s = std::sin(alpha) / r;
+        return {s * p.x, s * p.y, -std::cos(alpha)};
+    }
+
+    glm::vec4 FaceUVRect(int /* face */) const {
+        return {0.0f, 0.0f, 1.0f, 1.0f};
+    }
+
+    glm::vec3 FaceSurface(int /* face */, const glm::vec2 &st) const {
+        return ToDirection(st);
+    }
+};
+
+/**
+ * Concatenates the shader header, the GLSL functions of the projections and the shader body; the
+ * projections used in shaders provide Glsl.
+ */
+template<typename... Projections>
+std::string BuildProjectionShader(const char *header, const char *body) {
+    std::string source = header;
+    for (const char *glsl: {Projections::Glsl()...}) {
+        source += glsl;
+    }
+    source += body;
+    return source;
+}
+
+#endif //VR_VIDEO_PLAYER_PROJECTION_H
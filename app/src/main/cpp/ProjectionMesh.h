@@ -0,0 +1,151 @@
+#ifndef VR_VIDEO_PLAYER_PROJECTIONMESH_H
+#define VR_VIDEO_PLAYER_PROJECTIONMESH_H
+
+#include <GLES2/gl2.h>
+
+#include "glm/vec2.hpp"
+#include "glm/vec3.hpp"
+#include "glm/vec4.hpp"
+
+#include "Projection.h"
+#include "TexturedMesh.h"
+
+/**
+ * Builds a mesh showing the projection from the inside, with texture coordinates mapped into
+ * uvRect (left, top, right, bottom). Triangles are counter-clockwise when seen from the inside.
+ *
+ * The generic version puts an n_u x n_v grid over every projection face.
+ */
+template<typename Projection>
+struct ProjectionMeshGenerator {
+    static void AddMesh(const Projection &projection, int n_u, int n_v, const glm::vec4 &uvRect,
+                        TexturedMesh::Builder &meshBuilder) {
+        for (int face = 0; face < Projection::FACE_COUNT; ++face) {
+            const glm::vec4 faceRect = projection.FaceUVRect(face);
+            GLushort first = 0;
+            for (int j = 0; j <= n_v; ++j) {
+                for (int i = 0; i <= n_u; ++i) {
+                    const glm::vec2 st = {float(i) / float(n_u), float(j) / float(n_v)};
+                    const glm::vec3 pos = projection.FaceSurface(face, st);
+                    const float u = faceRect.x + (faceRect.z - faceRect.x) * st.x;
+                    const float v = faceRect.y + (faceRect.w - faceRect.y) * st.y;
+                    GLushort index = meshBuilder.add_vertex(
+                            pos.x, pos.y, pos.z,
+                            uvRect.x + (uvRect.z - uvRect.x) * u,
+                            uvRect.y + (uvRect.w - uvRect.y) * v);
+                    if (i == 0 && j == 0) {
+                        first = index;
+                    }
+                }
+            }
+
+            for (int j = 0; j < n_v; ++j) {
+                auto j0 = first + j * (n_u + 1);
+                auto j1 = first + (j + 1) * (n_u + 1);
+                for (int i = 0; i < n_u; ++i) {
+                    meshBuilder.add_quad(j0 + i, j0 + i + 1, j1 + i + 1, j1 + i);
+                }
+            }
+        }
+    }
+};
+
+/**
+ * The top and bottom rows of the equirectangular grid collapse into the poles, so they are single
+ * triangles, and the pole vertex of each of them is centered on its slice of the texture.
+ */
+template<>
+struct ProjectionMeshGenerator<EquirectProjection> {
+    static void AddMesh(const EquirectProjection &projection, int n_slices, int n_stacks,
+                        const glm::vec4 &uvRect, TexturedMesh::Builder &meshBuilder) {
+        const float uvWidth = uvRect.z - uvRect.x;
+        const float uvHeight = uvRect.w - uvRect.y;
+
+        GLushort first = 0;
+        for (int j = 0; j <= n_stacks; ++j) {
+            const float vFrac = float(j) / float(n_stacks);
+            for (int i = 0; i <= n_slices; ++i) {
+                float uFrac = float(i) / float(n_slices);
+                const glm::vec3 pos = projection.FaceSurface(0, {uFrac, vFrac});
+                if (j == 0) {
+                    uFrac += 0.5f / float(n_slices);
+                } else if (j == n_stacks) {
+                    uFrac -= 0.5f / float(n_slices);
+                }
+                GLushort index = meshBuilder.add_vertex(pos.x, pos.y, pos.z,
+                                                        uvRect.x + uFrac * uvWidth,
+                                                        uvRect.y + vFrac * uvHeight);
+                if (i == 0 && j == 0) {
+                    first = index;
+                }
+            }
+        }
+
+        for (int j = 0; j < n_stacks; ++j) {
+            auto j0 = first + j * (n_slices + 1);
+            auto j1 = first + (j + 1) * (n_slices + 1);
+            for (int i = 0; i < n_slices; ++i) {
+                auto i0 = j0 + i;
+                auto i1 = j0 + (i + 1);
+                auto i2 = j1 + (i + 1);
+                auto i3 = j1 + i;
+                if (j == 0) {
+                    meshBuilder.add_triangle(i0, i3, i2);
+                } else if (j == n_stacks - 1) {
+                    meshBuilder.add_triangle(i0, i2, i1);
+                } else {
+                    meshBuilder.add_quad(i0, i1, i2, i3);
+                }
+            }
+        }
+    }
+};
+
+/**
+ * The fisheye image circle is covered by a polar grid of n_segments x n_rings around its center,
+ * so no vertices are wasted on the texture corners outside the circle.
+ */
+template<>
+struct ProjectionMeshGenerator<FisheyeProjection> {
+    static void AddMesh(const FisheyeProjection &projection, int n_segments, int n_rings,
+                        const glm::vec4 &uvRect, TexturedMesh::Builder &meshBuilder) {
+        auto addVertex = [&](const glm::vec2 &uv) {
+            const glm::vec3 pos = projection.FaceSurface(0, uv);
+            return meshBuilder.add_vertex(pos.x, pos.y, pos.z,
+                                          uvRect.x + (uvRect.z - uvRect.x) * uv.x,
+                                          uvRect.y + (uvRect.w - uvRect.y) * uv.y);
+        };
+
+        const GLushort center = addVertex({0.5f, 0.5f});
+        for (int k = 1; k <= n_rings; ++k) {
+            const float r = 0.5f * float(k) / float(n_rings);
+            for (int i = 0; i < n_segments; ++i) {
+                const float angle = 2.0f * PROJECTION_PI * float(i) / float(n_segments);
+                addVertex({0.5f + r * std::cos(angle), 0.5f - r * std::sin(angle)});
+            }
+        }
+
+        auto ringVertex = [&](int k, int i) {
+            return static_cast<GLushort>(center + 1 + (k - 1) * n_segments + i % n_segments);
+        };
+        for (int i = 0; i < n_segments; ++i) {
+            meshBuilder.add_triangle(center, ringVertex(1, i), ringVertex(1, i + 1));
+        }
+        for (int k = 1; k < n_rings; ++k) {
+            for (int i = 0; i < n_segments; ++i) {
+                meshBuilder.add_quad(ringVertex(k, i), ringVertex(k, i + 1),
+                                     ringVertex(k + 1, i + 1), ringVertex(k + 1, i));
+            }
+        }
+    }
+};
+
+template<typename Projection>
+TexturedMesh BuildProjectionMesh(const Projection &projection, int n_u, int n_v,
+                                 const glm::vec4 &uvRect) {
+    TexturedMesh::Builder meshBuilder;
+    ProjectionMeshGenerator<Projection>::AddMesh(projection, n_u, n_v, uvRect, meshBuilder);
+    return meshBuilder.build();
+}
+
+#endif //VR_VIDEO_PLAYER_PROJECTIONMESH_H
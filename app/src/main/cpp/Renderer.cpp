@@ -1,20 +1,28 @@
 #include "Renderer.h"
 
 #include <cmath>
+#include <cstring>
 
+#include <algorithm>
 #include <array>
 #include <fstream>
+#include <limits>
+#include <utility>
 
 #include <android/asset_manager.h>
 #include <android/asset_manager_jni.h>
 #include <android/log.h>
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
+#include <GLES3/gl3.h>
 
 #include <cardboard.h>
 
+#include "glm/vec2.hpp"
 #include "glm/vec3.hpp"
 #include "glm/vec4.hpp"
+#include "glm/mat2x2.hpp"
+#include "glm/mat3x3.hpp"
 #include "glm/mat4x4.hpp"
 #define GLM_ENABLE_EXPERIMENTAL // quaternion.hpp is an experimental extension in GLM
 #include "glm/gtx/quaternion.hpp"
@@ -25,82 +33,279 @@
 #include "glm/gtc/type_ptr.hpp"
 
 #include "VRGuiButton.h"
+#include "GLState.h"
 #include "GLUtils.h"
 #include "logger.h"
 #include "VRGuiProgressBar.h"
+#include "ProceduralMesh.h"
+#include "SphereMesh.h"
+#include "MeshImport.h"
+#include "MeshCache.h"
+#include "Projection.h"
+#include "ProjectionMesh.h"
+#include "GLExtensions.h"
+#include "ProgramCache.h"
+#include "VRGuiAtlas.h"
 
 #define LOG_TAG "VRVideoPlayerR"
 
-constexpr uint64_t kPredictionTimeWithoutVsyncNanos = 50'000'000UL;
+// how often the pose prediction error is logged
+constexpr unsigned long kTimingLogFrames = 1000;
+// head rotation redrawing the view, about a pixel of a 90° view on a phone screen
+constexpr float kRedrawRotationRadians = 0.1f * glm::pi<float>() / 180.0f;
 constexpr float kzNear = 0.1f;
 constexpr float kzFar = 2.0f;
 
+// The eye shaders get the VIEW_* macros defined by WithViewDefinitions; the per-view parameters
+// in u_Eyes are indexed by the view. Vertex shaders pass their positions through VIEW_POSITION
+// and fragment shaders start with CLIP_VIEW(), which keep instanced stereo views in their halves.
 constexpr const char *kVertexShader = R"glsl(#version 300 es
-uniform mat4 u_MVP;
+VIEW_DECLARATIONS
 in vec4 a_Position;
 in vec2 a_UV;
 out vec2 v_UV;
+flat out int v_View;
 
 void main() {
+  v_View = VIEW_ID;
+  v_UV = mix(u_Eyes[VIEW_ID].uvRect.xy, u_Eyes[VIEW_ID].uvRect.zw, a_UV);
+  vec4 position = u_Eyes[VIEW_ID].mvp * a_Position;
+  gl_Position = VIEW_POSITION(position);
+})glsl";
+
+// The attribute locations are fixed for the vertex array of VRGuiPanel.
+constexpr const char *kVertexShaderVRGui = R"glsl(#version 300 es
+VIEW_DECLARATIONS
+layout(location = 0) in vec4 a_Position;
+layout(location = 1) in vec2 a_UV;
+layout(location = 2) in float a_Highlight;
+out vec2 v_UV;
+out float v_Highlight;
+flat out int v_View;
+
+void main() {
+  v_View = VIEW_ID;
   v_UV = a_UV;
-  gl_Position = u_MVP * a_Position;
+  v_Highlight = a_Highlight;
+  vec4 position = u_Eyes[VIEW_ID].guiMvp * a_Position;
+  gl_Position = VIEW_POSITION(position);
+})glsl";
+
+// Generates a ProceduralMesh grid from gl_VertexID, see ProjectionMeshGenerator for the equivalent
+// CPU-side meshes. The projection functions are inserted between the header and the body.
+constexpr const char *kVertexShaderProceduralHeader = R"glsl(#version 300 es
+layout(std140) uniform MeshGrid {
+  ivec4 u_Grid;
+  vec4 u_ThetaRange;
+  vec4 u_GridUVRect;
+};
+VIEW_DECLARATIONS
+out vec2 v_UV;
+flat out int v_View;
+)glsl";
+
+constexpr const char *kVertexShaderProceduralBody = R"glsl(
+const ivec2 kCellCorners[6] = ivec2[6](
+  ivec2(0, 0), ivec2(1, 1), ivec2(1, 0),
+  ivec2(0, 0), ivec2(0, 1), ivec2(1, 1)
+);
+
+void main() {
+  int cellIndex = gl_VertexID / 6;
+  ivec2 cell = ivec2(cellIndex % u_Grid.x, cellIndex / u_Grid.x) + kCellCorners[gl_VertexID % 6];
+  vec2 frac = vec2(cell) / vec2(u_Grid.xy);
+  vec2 uv = mix(u_GridUVRect.xy, u_GridUVRect.zw, frac);
+
+  vec3 pos;
+  if (u_Grid.z == 1) {
+    pos = EquirectToSurface(frac, u_ThetaRange);
+    // texture correction for top- and bottom-layer vertices (collapsed into a point)
+    if (cell.y == 0) {
+      uv.x += 0.5 * (u_GridUVRect.z - u_GridUVRect.x) / float(u_Grid.x);
+    } else if (cell.y == u_Grid.y) {
+      uv.x -= 0.5 * (u_GridUVRect.z - u_GridUVRect.x) / float(u_Grid.x);
+    }
+  } else {
+    pos = CylindricalToSurface(frac, u_ThetaRange);
+  }
+
+  v_View = VIEW_ID;
+  v_UV = mix(u_Eyes[VIEW_ID].uvRect.xy, u_Eyes[VIEW_ID].uvRect.zw, uv);
+  vec4 position = u_Eyes[VIEW_ID].mvp * vec4(pos, 1.0);
+  gl_Position = VIEW_POSITION(position);
 })glsl";
 
+// Specialized by the definitions of WithVideoDefinitions.
 constexpr const char *kFragmentShader = R"glsl(#version 300 es
 #extension GL_OES_EGL_image_external : enable
 #extension GL_OES_EGL_image_external_essl3 : enable
-precision mediump float;
-
-uniform samplerExternalOES u_Texture;
-uniform mat4 u_ColorMap;
+precision VIDEO_PRECISION float;
+
+#ifdef VIDEO_MIPMAP
+uniform VIDEO_PRECISION sampler2D u_Texture;
+#else
+// external samplers default to lowp, too coarse for 10-bit video
+uniform VIDEO_PRECISION samplerExternalOES u_Texture;
+#endif
+#ifdef TONE_MAP_LUT_SIZE
+uniform mediump sampler3D u_ToneMap;
+#endif
+#ifdef ANAGLYPH_LUT_SIZE
+uniform mediump sampler3D u_Anaglyph;
+#endif
+VIEW_DECLARATIONS
 in vec2 v_UV;
+flat in int v_View;
 out vec4 fragColor;
 
 void main() {
-  fragColor = u_ColorMap * texture(u_Texture, v_UV);
+  CLIP_VIEW();
+  vec4 color = texture(u_Texture, v_UV);
+#ifdef ANAGLYPH_LUT_SIZE
+  // the texel centers of the LUT span the range of the video, the LUTs of the eyes take half of
+  // the slices each
+  const float anaglyphScale = (ANAGLYPH_LUT_SIZE - 1.0) / ANAGLYPH_LUT_SIZE;
+  vec3 anaglyphCoord = anaglyphScale * color.rgb + 0.5 / ANAGLYPH_LUT_SIZE;
+  anaglyphCoord.z = 0.5 * anaglyphCoord.z + u_Eyes[v_View].anaglyphLutOffset;
+  color.rgb = texture(u_Anaglyph, anaglyphCoord).rgb;
+#endif
+#ifdef TONE_MAP_LUT_SIZE
+  // the texel centers of the LUT span the range of the video
+  const float lutScale = (TONE_MAP_LUT_SIZE - 1.0) / TONE_MAP_LUT_SIZE;
+  color.rgb = texture(u_ToneMap, lutScale * color.rgb + 0.5 / TONE_MAP_LUT_SIZE).rgb;
+#endif
+  fragColor = color;
 })glsl";
 
 constexpr const char *kFragmentShaderVRGui = R"glsl(#version 300 es
 precision mediump float;
 
 uniform sampler2D u_Texture;
-in vec2 v_UV;
+VIEW_DECLARATIONS
+// enough for the derivatives across a texel of the atlas
+in highp vec2 v_UV;
+in float v_Highlight;
+flat in int v_View;
 out vec4 fragColor;
 
+#ifdef MSDF_PX_RANGE
+float Median(vec3 v) {
+  return max(min(v.r, v.g), min(max(v.r, v.g), v.b));
+}
+#endif
+
 void main() {
-  fragColor = texture(u_Texture, v_UV);
+  CLIP_VIEW();
+#ifdef MSDF_PX_RANGE
+  // the distance range of the field in screen pixels, so the edge is antialiased over one pixel
+  // at any magnification
+  vec2 unitRange = vec2(MSDF_PX_RANGE) / vec2(textureSize(u_Texture, 0));
+  vec2 screenTexSize = vec2(1.0) / fwidth(v_UV);
+  float screenPxRange = max(0.5 * dot(unitRange, screenTexSize), 1.0);
+  float distance = screenPxRange * (Median(texture(u_Texture, v_UV).rgb) - 0.5);
+  vec4 color = vec4(1.0, 1.0, 1.0, clamp(distance + 0.5, 0.0, 1.0));
+#else
+  vec4 color = texture(u_Texture, v_UV);
+#endif
+  // the button looked at is brightened
+  fragColor = vec4(color.rgb * (1.0 + 0.3 * v_Highlight), color.a);
 })glsl";
 
 constexpr const char *kVertexShader2D = R"glsl(#version 300 es
+VIEW_DECLARATIONS
 in vec4 a_Position;
+flat out int v_View;
 
 void main() {
-  gl_Position = a_Position;
+  v_View = VIEW_ID;
+  gl_Position = VIEW_POSITION(a_Position);
 })glsl";
 
 constexpr const char *kFragmentShader2D = R"glsl(#version 300 es
 precision mediump float;
 
+VIEW_DECLARATIONS
+flat in int v_View;
 out vec4 fragColor;
 
 void main() {
+  CLIP_VIEW();
   fragColor = vec4(1.0);
 })glsl";
 
+// std140 layout of the Eye struct of the eye shaders
+struct EyeParams {
+    glm::mat4 mvp;
+    glm::mat4 guiMvp;
+    glm::vec4 uvRect;
+    float anaglyphLutOffset;
+    float padding[3];
+};
+
 static constexpr float M_TWO_PI = (float) M_PI * 2.0f;
 
 static constexpr float PLAIN_FOV_Z = -1.0f;
 
+// sphere and cylinder grids are generated in the vertex shader instead of being uploaded
+static constexpr bool USE_PROCEDURAL_MESHES = true;
+static constexpr GLuint MESH_GRID_BINDING = 0;
+static constexpr GLuint VIEW_PARAMS_BINDING = 1;
+static constexpr GLuint REGION_PARAMS_BINDING = 2;
+static constexpr GLuint EYE_PARAMS_BINDING = 3;
+// the video is on the first unit, the LUT of its variant on the next one
+static constexpr GLint TONE_MAP_TEXTURE_UNIT = 1;
+static constexpr GLint ANAGLYPH_TEXTURE_UNIT = 1;
+// HDR video is rendered into 10-bit eye buffers
+static constexpr bool USE_HDR_EYE_BUFFER = true;
+// video this many times denser than the eye buffers is sampled from a mip-mapped copy, which
+// still has a texel per pixel at half the video size
+static constexpr bool USE_VIDEO_MIPMAP = true;
+static constexpr float VIDEO_MIPMAP_MIN_MINIFICATION = 2.0f;
+
+// meshes addressing their own part of the frame already contain the final texture coordinates
+static constexpr glm::vec4 FULL_UV_RECT = {0.0f, 0.0f, 1.0f, 1.0f};
+static constexpr glm::vec4 IDENTITY_REGION_TRANSFORM = {1.0f, 1.0f, 0.0f, 0.0f};
+
 static constexpr float VR_GUI_BUTTON_GRID = M_PI * 8 / 180.0f;
 static constexpr float VR_GUI_BUTTON_SIZE = M_PI * 7 / 180.0f;
 static constexpr float VR_GUI_BUTTON_PHI_0 = -0.5f * VR_GUI_BUTTON_GRID;
 static constexpr float VR_GUI_DISTANCE = kzFar * 0.4f;
+// the title line above the buttons, as wide as the button grid
+static constexpr float VR_GUI_TITLE_PHI = VR_GUI_BUTTON_PHI_0 + 0.8f * VR_GUI_BUTTON_GRID;
+static constexpr float VR_GUI_TITLE_EM = M_PI * 2.5f / 180.0f;
+static constexpr float VR_GUI_TITLE_MAX_WIDTH = 5 * VR_GUI_BUTTON_GRID;
+// the layer encloses the buttons and the title with a margin; denser than the eye buffers, so
+// drawing it into them keeps the text sharp
+static constexpr float VR_GUI_LAYER_HALF_WIDTH = 2.75f * VR_GUI_BUTTON_GRID;
+static constexpr float VR_GUI_LAYER_BOTTOM_PHI = VR_GUI_BUTTON_PHI_0 - 1.75f * VR_GUI_BUTTON_GRID;
+static constexpr float VR_GUI_LAYER_TOP_PHI = VR_GUI_TITLE_PHI + VR_GUI_TITLE_EM;
+static constexpr float VR_GUI_LAYER_PIXELS_PER_RADIAN = 1024.0f;
 
 static constexpr float HEAD_GESTURE_PITCH_LIMIT = glm::radians(60.0f);
 static constexpr float HEAD_GESTURE_PITCH_LIMIT_RETURN = glm::radians(45.0f);
 
 static constexpr int PROGRESS_BAR_SHOW_TIME = 3;
 
+static constexpr int MIN_EYE_BUFFER_SIZE = 256;
+// the GPU time of a frame, held by scaling the eye buffers, is the display period less this margin
+// for the timewarp of the compositor and the start of the next frame, but at least half the period
+static constexpr uint64_t FRAME_BUDGET_MARGIN_NANOS = 3'500'000;
+// until the display period is measured
+static constexpr uint64_t DEFAULT_VSYNC_PERIOD_NANOS = 16'666'667;
+// a compositor thread stopped by an error is restarted this many times, then the frames go to the
+// window directly again
+static constexpr int MAX_COMPOSITOR_RESTARTS = 3;
+static constexpr float MIN_EYE_BUFFER_QUALITY = 0.25f;
+static constexpr float MAX_EYE_BUFFER_QUALITY = 2.0f;
+// the foveation profile follows the lens density at this many points from its center to each edge
+static constexpr int FOVEATION_SAMPLES = 4;
+static constexpr float MIN_FOVEATION_DENSITY = 0.25f;
+// without foveation, the middle half of the view in each axis is rendered at full density
+static constexpr glm::vec4 MULTI_RESOLUTION_CENTER = {0.25f, 0.25f, 0.75f, 0.75f};
+static constexpr float MIN_PERIPHERY_DENSITY = 0.5f;
+// not worth drawing everything nine times for less savings
+static constexpr float MAX_PERIPHERY_DENSITY = 0.9f;
+
 static constexpr glm::vec3 Y_AXIS = {0.0f, 1.0f, 0.0f};
 static constexpr glm::vec4 NEG_Z_AXIS = {0.0f, 0.0f, -1.0f, 1.0f};
 
@@ -146,16 +351,74 @@ static VRGuiProgressBar vrGuiProgressBar(0, 3 * VR_GUI_BUTTON_GRID, 6 * VR_GUI_B
                                          0.5f * VR_GUI_BUTTON_GRID);
 static time_t vrGuiProgressBarHideAt;
 
+static uint64_t FrameBudgetNanos(uint64_t vsyncPeriodNanos) {
+    return std::max(vsyncPeriodNanos - std::min(vsyncPeriodNanos, FRAME_BUDGET_MARGIN_NANOS),
+                    vsyncPeriodNanos / 2);
+}
+
 Renderer::Renderer(JavaVM *vm, jobject javaContextObj, jobject javaAssetMgrObj,
                    jobject javaVideoTexturePlayerObj, jobject javaControllerObj)
         : glInitialized(false),
           screenParamsChanged(false),
           deviceParamsChanged(false),
+          videoWidth(0),
+          videoHeight(0),
+          videoAspect(1.0f),
           frameCount(0),
+          displayTiming{},
+          frameDisplayTimeNanos(0),
+          frameScheduler(kRedrawRotationRadians),
+          activityResumed(false),
+          headTrackerRunning(false),
           inputVideoMode{},
           inputVideoLayout{},
           outputMode{},
+          videoVariant(VideoVariant::PLAIN),
+          toneMap(),
+          anaglyph(),
+          videoMipmap(),
+          videoMinification(0.0f),
+          stencilRenderbuffer(0),
+          useEyeTextureArray(false),
+          eyeTextureArray(0),
+          eyeDepthStencilArray(0),
+          multiviewFramebuffer(0),
+          layerFramebuffers{},
+          distortionRenderer{},
+          compositor{},
+          compositorWindow(nullptr),
+          compositorFailures(0),
+          lensMasks{},
+          lensMaskChanged(false),
+          eyeBufferQuality(1.0f),
+          eyeBufferWidth(0),
+          eyeBufferHeight(0),
+          eyeBufferFormat(GL_RGB8),
+          gpuFrameTimer{},
+          dynamicResolution(FrameBudgetNanos(DEFAULT_VSYNC_PERIOD_NANOS)),
+          foveation(),
+          multiResolution{},
           eyeMeshes{},
+          eyeMeshUVRects{},
+          eyeMeshesShared(true),
+          meshChanged(false),
+          programCache(),
+          eyePrograms{},
+          viewParamsBuffer(0),
+          regionParamsBuffer(0),
+          regionParamsStride(0),
+          eyeParamsRing(),
+          eyeParamsRightOffset(0),
+          eyeProceduralMeshes{},
+          meshGridBuffers{},
+          meshGridChanged(false),
+          videoMeshesLoaded(false),
+          screenMeshesLoaded(false),
+          emptyVertexArray(0),
+          vrGuiLayer(VR_GUI_LAYER_HALF_WIDTH, VR_GUI_LAYER_BOTTOM_PHI, VR_GUI_LAYER_TOP_PHI,
+                     VR_GUI_DISTANCE, VR_GUI_LAYER_PIXELS_PER_RADIAN),
+          vrGuiLayerParamsBuffer(0),
+          vrGuiTitleChanged(false),
           viewMatrix{},
           cardboardHeadTracker{},
           javaInterface(vm, javaContextObj, javaAssetMgrObj, javaVideoTexturePlayerObj, javaControllerObj) {
@@ -169,12 +432,17 @@ Renderer::Renderer(JavaVM *vm, jobject javaContextObj, jobject javaAssetMgrObj,
 
 Renderer::~Renderer() {
     LOG_DEBUG("Renderer instance destroyed");
+
+    SetCompositorWindow(nullptr);
 }
 
 void Renderer::OnPause() {
-    LOG_DEBUG("OnPause after %lu frames", frameCount);
+    LOG_DEBUG("OnPause after %lu frames, pose prediction error %.1f ms", frameCount,
+              double(displayTiming.GetModel().GetPredictionErrorNanos()) * 1e-6);
 
-    CardboardHeadTracker_pause(cardboardHeadTracker.get());
+    activityResumed = false;
+    UpdateHeadTracker();
+    displayTiming.Stop();
 }
 
 void Renderer::OnResume() {
@@ -184,8 +452,56 @@ void Renderer::OnResume() {
 
     // Parameters may have changed.
     deviceParamsChanged = true;
+    frameScheduler.Invalidate();
+
+    activityResumed = true;
+    UpdateHeadTracker();
+    displayTiming.Start();
+}
+
+/**
+ * Flat video on a mono screen is shown as is, no matter where the head points.
+ */
+bool Renderer::UsesHeadTracking() const {
+    return !(inputVideoMode == InputVideoMode::PLAIN_FOV && isOutputModeMono(outputMode));
+}
+
+/**
+ * Runs the head tracker sensors only while the activity is resumed and the mode needs them.
+ */
+void Renderer::UpdateHeadTracker() {
+    std::lock_guard<std::mutex> lock(headTrackerMutex);
+    const bool track = activityResumed && UsesHeadTracking();
+    if (track == headTrackerRunning) {
+        return;
+    }
+    if (track) {
+        CardboardHeadTracker_resume(cardboardHeadTracker.get());
+    } else {
+        CardboardHeadTracker_pause(cardboardHeadTracker.get());
+    }
+    headTrackerRunning = track;
+}
+
+bool Renderer::NeedsRedraw() {
+    if (!headTrackerRunning) {
+        return frameScheduler.NeedsRedraw(nullptr);
+    }
+
+    glm::quat headOrientationQuat;
+    glm::vec3 headPosition;
+    CardboardHeadTracker_getPose(
+            cardboardHeadTracker.get(),
+            static_cast<int64_t>(GetBootTimeNano()),
+            kLandscapeLeft,
+            glm::value_ptr(headPosition),
+            glm::value_ptr(headOrientationQuat)
+    );
+    return frameScheduler.NeedsRedraw(&headOrientationQuat);
+}
 
-    CardboardHeadTracker_resume(cardboardHeadTracker.get());
+FrameTimingModel Renderer::GetFrameTiming() {
+    return displayTiming.GetModel();
 }
 
 void Renderer::SetScreenParams(int width, int height) {
@@ -195,13 +511,52 @@ void Renderer::SetScreenParams(int width, int height) {
     screenHeight = height;
     screenAspect = (float) width / (float) height;
     screenParamsChanged = true;
+    frameScheduler.Invalidate();
+}
+
+void Renderer::SetCompositorWindow(ANativeWindow *window) {
+    LOG_DEBUG("SetCompositorWindow(%s)", window != nullptr ? "window" : "none");
+
+    // restarted by the next frame
+    compositor.Stop();
+    if (compositorWindow != nullptr) {
+        ANativeWindow_release(compositorWindow);
+    }
+    compositorWindow = window;
+    compositorFailures = 0;
+}
+
+/**
+ * Starts the compositor for the window, or restarts it after an error. When that does not help,
+ * asynchronous timewarp is turned off, which gives the window back to the GL surface.
+ */
+void Renderer::UpdateCompositor(JNIEnv *env) {
+    if (compositorWindow == nullptr || compositor.IsRunning()) {
+        return;
+    }
+    if (compositor.HasFailed() && ++compositorFailures > MAX_COMPOSITOR_RESTARTS) {
+        LOG_ERROR("Compositor keeps failing, rendering to the window directly");
+        SetCompositorWindow(nullptr);
+        javaInterface.DisableAsyncTimewarp(env);
+        return;
+    }
+
+    const Compositor::Format format{
+            useEyeTextureArray ? GLenum(GL_TEXTURE_2D_ARRAY) : GLenum(GL_TEXTURE_2D),
+            eyeBufferFormat, useEyeTextureArray ? eyeBufferWidth : 2 * eyeBufferWidth,
+            eyeBufferHeight, outputMode == OutputMode::CARDBOARD_STEREO};
+    if (!compositor.Start(compositorWindow, cardboardHeadTracker.get(), format)) {
+        // nothing is shown in the window this way, so do not retry every frame
+        SetCompositorWindow(nullptr);
+        javaInterface.DisableAsyncTimewarp(env);
+    }
 }
 
 static void
 initStaticTexture(JNIEnv *env, jobject java_asset_mgr, GLuint &textureId, const std::string &path) {
     glGenTextures(1, &textureId);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textureId);
+    GetGLState().ActiveTexture(GL_TEXTURE0);
+    GetGLState().BindTexture(GL_TEXTURE_2D, textureId);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -218,8 +573,8 @@ initStaticTexture(JNIEnv *env, jobject java_asset_mgr, GLuint &textureId, const
 
 void Renderer::InitVideoTexture(JNIEnv *env, GLuint &textureId) {
     glGenTextures(1, &textureId);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_EXTERNAL_OES, textureId);
+    GetGLState().ActiveTexture(GL_TEXTURE0);
+    GetGLState().BindTexture(GL_TEXTURE_EXTERNAL_OES, textureId);
 
     glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -233,85 +588,329 @@ void Renderer::InitVideoTexture(JNIEnv *env, GLuint &textureId) {
     CHECK_GL_ERROR("Video texture init");
 }
 
-void Renderer::InitStaticTexture(JNIEnv *env, GLuint &textureId, const std::string &path) {
+void Renderer::InitStaticTexture(JNIEnv *env, GLuint &textureId, const std::string &path,
+                                 bool mipmapped) {
     glGenTextures(1, &textureId);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textureId);
+    GetGLState().ActiveTexture(GL_TEXTURE0);
+    GetGLState().BindTexture(GL_TEXTURE_2D, textureId);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    mipmapped ? GL_LINEAR_MIPMAP_NEAREST : GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     if (!javaInterface.LoadPngFromAssetManager(env, GL_TEXTURE_2D, path)) {
         LOG_ERROR("Couldn't load texture");
         return;
     }
-    glGenerateMipmap(GL_TEXTURE_2D);
+    if (mipmapped) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
 
     CHECK_GL_ERROR("Texture load");
 }
 
-void Renderer::OnSurfaceCreated(JNIEnv *env) {
-    LOG_DEBUG("OnSurfaceCreated");
+// Instanced stereo draws both eyes side by side into one viewport, as instances 0 and 1. Per view,
+// u_Eyes holds the per-frame parameters of the views, see EyeParams; uvRect is the left, top,
+// right, bottom of the texture area the mesh UVs span, anaglyphLutOffset is where the anaglyph
+// LUT of the eye starts along the blue axis.
+// u_ViewParams holds the x scale and offset in clip space placing the view into its half, and the
+// window x range of that half; fragments outside of it belong to the other eye. Other views are
+// drawn per multi-resolution region, u_Region holds the xy scale and offset in clip space
+// stretching the region over its viewport.
+constexpr const char *kViewMacros = R"glsl(#define EYE_DECLARATIONS \
+  struct Eye { \
+    highp mat4 mvp; highp mat4 guiMvp; highp vec4 uvRect; highp float anaglyphLutOffset; \
+  }; \
+  layout(std140) uniform EyeParams { Eye u_Eyes[VIEW_COUNT]; };
+#ifdef INSTANCED_STEREO
+#define VIEW_DECLARATIONS EYE_DECLARATIONS \
+  layout(std140) uniform ViewParams { highp vec4 u_ViewParams[VIEW_COUNT]; };
+#define VIEW_POSITION(p) \
+  vec4((p).x * u_ViewParams[VIEW_ID].x + (p).w * u_ViewParams[VIEW_ID].y, (p).yzw)
+#define CLIP_VIEW() \
+  if (gl_FragCoord.x < u_ViewParams[v_View].z || gl_FragCoord.x >= u_ViewParams[v_View].w) \
+    discard
+#else
+#define VIEW_DECLARATIONS EYE_DECLARATIONS \
+  layout(std140) uniform RegionParams { highp vec4 u_Region; };
+#define VIEW_POSITION(p) vec4((p).xy * u_Region.xy + (p).w * u_Region.zw, (p).zw)
+#define CLIP_VIEW()
+#endif
+)glsl";
+
+/**
+ * Defines the VIEW_* macros of an eye shader for the view mode; they are all preprocessor
+ * directives, so they can go right after the #version line.
+ */
+static std::string WithViewDefinitions(const std::string &source, GLenum type, ViewMode mode) {
+    std::string definitions;
+    switch (mode) {
+        case ViewMode::SINGLE:
+            definitions = "#define VIEW_ID 0\n"
+                          "#define VIEW_COUNT 1\n";
+            break;
+
+        case ViewMode::MULTIVIEW:
+            if (type == GL_VERTEX_SHADER) {
+                definitions = "#extension GL_OVR_multiview2 : require\n"
+                              "layout(num_views = 2) in;\n"
+                              "#define VIEW_ID int(gl_ViewID_OVR)\n";
+            }
+            definitions += "#define VIEW_COUNT 2\n";
+            break;
 
-    const GLuint vertexShader = LoadGLShader(GL_VERTEX_SHADER, kVertexShader);
-    const GLuint fragmentShader = LoadGLShader(GL_FRAGMENT_SHADER, kFragmentShader);
+        case ViewMode::INSTANCED:
+            definitions = "#define INSTANCED_STEREO 1\n"
+                          "#define VIEW_ID gl_InstanceID\n"
+                          "#define VIEW_COUNT 2\n";
+            break;
+    }
+    definitions += kViewMacros;
 
-    programVideo = glCreateProgram();
-    glAttachShader(programVideo, vertexShader);
-    glAttachShader(programVideo, fragmentShader);
-    glLinkProgram(programVideo);
-    glUseProgram(programVideo);
-    CHECK_GL_ERROR("Video program");
+    const std::size_t lineEnd = source.find('\n') + 1;
+    return source.substr(0, lineEnd) + definitions + source.substr(lineEnd);
+}
 
-    programVideoParamPosition = glGetAttribLocation(programVideo, "a_Position");
-    programVideoParamUV = glGetAttribLocation(programVideo, "a_UV");
-    programVideoParamMVPMatrix = glGetUniformLocation(programVideo, "u_MVP");
-    programVideoParamColorMapMatrix = glGetUniformLocation(programVideo, "u_ColorMap");
-    CHECK_GL_ERROR("Video program params");
+/**
+ * Defines the macros specializing the video fragment shader for the variant and the video source,
+ * after the extension directives.
+ */
+static std::string WithVideoDefinitions(const std::string &source, VideoVariant variant,
+                                        VideoSource videoSource) {
+    std::string definitions;
+    if (variant == VideoVariant::TONE_MAP) {
+        definitions = "#define VIDEO_PRECISION highp\n#define TONE_MAP_LUT_SIZE " +
+                      std::to_string(float(ToneMap::LUT_SIZE)) + "\n";
+    } else {
+        definitions = "#define VIDEO_PRECISION mediump\n";
+    }
+    if (variant == VideoVariant::ANAGLYPH) {
+        definitions += "#define ANAGLYPH_LUT_SIZE " +
+                       std::to_string(float(Anaglyph::LUT_SIZE)) + "\n";
+    }
+    if (videoSource == VideoSource::MIPMAP) {
+        definitions += "#define VIDEO_MIPMAP 1\n";
+    }
 
-    InitVideoTexture(env, videoTexture);
+    const std::size_t lineEnd = source.find("precision");
+    return source.substr(0, lineEnd) + definitions + source.substr(lineEnd);
+}
 
-    const GLuint vertexShaderVRGui = LoadGLShader(GL_VERTEX_SHADER, kVertexShader);
-    const GLuint fragmentShaderVRGui = LoadGLShader(GL_FRAGMENT_SHADER, kFragmentShaderVRGui);
+/**
+ * Makes the GUI fragment shader sample the distance fields of the GUI atlas.
+ */
+static std::string WithTextDefinitions(const std::string &source) {
+    const std::string definitions =
+            "#define MSDF_PX_RANGE " + std::to_string(VR_GUI_ATLAS_METRICS.pxRange) + "\n";
 
-    programVRGui = glCreateProgram();
-    glAttachShader(programVRGui, vertexShaderVRGui);
-    glAttachShader(programVRGui, fragmentShaderVRGui);
-    glLinkProgram(programVRGui);
-    glUseProgram(programVRGui);
-    CHECK_GL_ERROR("VR Gui program");
+    const std::size_t lineEnd = source.find("precision");
+    return source.substr(0, lineEnd) + definitions + source.substr(lineEnd);
+}
 
-    programVRGuiParamPosition = glGetAttribLocation(programVRGui, "a_Position");
-    programVRGuiParamUV = glGetAttribLocation(programVRGui, "a_UV");
-    programVRGuiParamMVPMatrix = glGetUniformLocation(programVRGui, "u_MVP");
-    CHECK_GL_ERROR("VR Gui program params");
+static GLuint StartEyeProgram(ProgramCache &programCache, const std::string &vertexSource,
+                              const std::string &fragmentSource, ViewMode mode) {
+    return programCache.Start(WithViewDefinitions(vertexSource, GL_VERTEX_SHADER, mode),
+                              WithViewDefinitions(fragmentSource, GL_FRAGMENT_SHADER, mode));
+}
 
-    InitStaticTexture(env, buttonTexture, "buttons-texture.png");
+static void FinishEyeProgram(ProgramCache &programCache, GLuint &program) {
+    if (!programCache.Finish(program)) {
+        return;
+    }
 
-    const GLuint vertexShader2D = LoadGLShader(GL_VERTEX_SHADER, kVertexShader2D);
-    const GLuint fragmentShader2D = LoadGLShader(GL_FRAGMENT_SHADER, kFragmentShader2D);
+    const GLuint viewParamsIndex = glGetUniformBlockIndex(program, "ViewParams");
+    if (viewParamsIndex != GL_INVALID_INDEX) {
+        glUniformBlockBinding(program, viewParamsIndex, VIEW_PARAMS_BINDING);
+    }
+    const GLuint regionParamsIndex = glGetUniformBlockIndex(program, "RegionParams");
+    if (regionParamsIndex != GL_INVALID_INDEX) {
+        glUniformBlockBinding(program, regionParamsIndex, REGION_PARAMS_BINDING);
+    }
+    const GLuint eyeParamsIndex = glGetUniformBlockIndex(program, "EyeParams");
+    if (eyeParamsIndex != GL_INVALID_INDEX) {
+        glUniformBlockBinding(program, eyeParamsIndex, EYE_PARAMS_BINDING);
+    }
+}
 
-    program2D = glCreateProgram();
-    glAttachShader(program2D, vertexShader2D);
-    glAttachShader(program2D, fragmentShader2D);
-    glLinkProgram(program2D);
-    glUseProgram(program2D);
+/**
+ * Starts building the programs of the view mode, see FinishEyePrograms.
+ */
+static EyePrograms StartEyePrograms(ProgramCache &programCache, ViewMode mode) {
+    EyePrograms programs{};
+
+    const std::string proceduralVertexShader =
+            BuildProjectionShader<EquirectProjection, CylindricalProjection>(
+                    kVertexShaderProceduralHeader, kVertexShaderProceduralBody);
+    for (int source = 0; source < VIDEO_SOURCE_COUNT; ++source) {
+        for (int variant = 0; variant < VIDEO_VARIANT_COUNT; ++variant) {
+            const std::string fragmentShader =
+                    WithVideoDefinitions(kFragmentShader, static_cast<VideoVariant>(variant),
+                                         static_cast<VideoSource>(source));
+            programs.video[source][variant].program =
+                    StartEyeProgram(programCache, kVertexShader, fragmentShader, mode);
+            programs.videoProcedural[source][variant] =
+                    StartEyeProgram(programCache, proceduralVertexShader, fragmentShader, mode);
+        }
+    }
+    programs.programVRGui =
+            StartEyeProgram(programCache, kVertexShaderVRGui, kFragmentShaderVRGui, mode);
+    programs.programVRText = StartEyeProgram(programCache, kVertexShaderVRGui,
+                                             WithTextDefinitions(kFragmentShaderVRGui), mode);
+    programs.program2D = StartEyeProgram(programCache, kVertexShader2D, kFragmentShader2D, mode);
+    CHECK_GL_ERROR("Start eye programs");
+    return programs;
+}
+
+/**
+ * Waits for the programs to be linked and looks up their parameters.
+ */
+static void FinishEyePrograms(ProgramCache &programCache, EyePrograms &programs) {
+    for (int source = 0; source < VIDEO_SOURCE_COUNT; ++source) {
+        for (int variant = 0; variant < VIDEO_VARIANT_COUNT; ++variant) {
+            VideoProgram &video = programs.video[source][variant];
+            FinishEyeProgram(programCache, video.program);
+            CHECK_GL_ERROR("Video program");
+
+            video.paramPosition = glGetAttribLocation(video.program, "a_Position");
+            video.paramUV = glGetAttribLocation(video.program, "a_UV");
+            CHECK_GL_ERROR("Video program params");
+
+            GLuint &procedural = programs.videoProcedural[source][variant];
+            FinishEyeProgram(programCache, procedural);
+            CHECK_GL_ERROR("Procedural video program");
+
+            glUniformBlockBinding(procedural, glGetUniformBlockIndex(procedural, "MeshGrid"),
+                                  MESH_GRID_BINDING);
+            CHECK_GL_ERROR("Procedural video program params");
+
+            if (variant == static_cast<int>(VideoVariant::TONE_MAP)) {
+                for (GLuint program: {video.program, procedural}) {
+                    GetGLState().UseProgram(program);
+                    glUniform1i(glGetUniformLocation(program, "u_ToneMap"),
+                                TONE_MAP_TEXTURE_UNIT);
+                }
+                CHECK_GL_ERROR("Tone map program params");
+            }
+            if (variant == static_cast<int>(VideoVariant::ANAGLYPH)) {
+                for (GLuint program: {video.program, procedural}) {
+                    GetGLState().UseProgram(program);
+                    glUniform1i(glGetUniformLocation(program, "u_Anaglyph"),
+                                ANAGLYPH_TEXTURE_UNIT);
+                }
+                CHECK_GL_ERROR("Anaglyph program params");
+            }
+        }
+    }
+
+    FinishEyeProgram(programCache, programs.programVRGui);
+    FinishEyeProgram(programCache, programs.programVRText);
+    CHECK_GL_ERROR("VR Gui program");
+
+    FinishEyeProgram(programCache, programs.program2D);
     CHECK_GL_ERROR("2D program");
 
-    program2DParamPosition = glGetAttribLocation(program2D, "a_Position");
+    programs.program2DParamPosition = glGetAttribLocation(programs.program2D, "a_Position");
     CHECK_GL_ERROR("2D program params");
 }
 
-void Renderer::DrawFrame(float videoPosition, JNIEnv *env) {
+void Renderer::OnSurfaceCreated(JNIEnv *env) {
+    LOG_DEBUG("OnSurfaceCreated");
+
+    LoadGLExtensions();
+    // whatever the previous context had bound is gone with it
+    GetGLState().Reset();
+    gpuFrameTimer.GlSetup();
+    compositor.GlReset();
+
+    // all the programs are started before waiting for any, so they can compile in parallel
+    programCache.GlSetup();
+    const bool multiview = GetGLExtensions().multiview;
+    for (ViewMode mode: {ViewMode::SINGLE, ViewMode::MULTIVIEW, ViewMode::INSTANCED}) {
+        if (mode != ViewMode::MULTIVIEW || multiview) {
+            eyePrograms[static_cast<int>(mode)] = StartEyePrograms(programCache, mode);
+        }
+    }
+    distortionRenderer.GlSetup();
+    for (ViewMode mode: {ViewMode::SINGLE, ViewMode::MULTIVIEW, ViewMode::INSTANCED}) {
+        if (mode != ViewMode::MULTIVIEW || multiview) {
+            FinishEyePrograms(programCache, eyePrograms[static_cast<int>(mode)]);
+        }
+    }
+
+    glGenBuffers(1, &viewParamsBuffer);
+    GLint uniformBufferAlignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformBufferAlignment);
+    regionParamsStride = std::max(uniformBufferAlignment, GLint(sizeof(glm::vec4)));
+    glGenBuffers(1, &regionParamsBuffer);
+    // both eyes for the passes drawing them together, then the right one alone at an aligned
+    // offset for the single view passes
+    const GLintptr eyeParamsAlignment = std::max(uniformBufferAlignment, 1);
+    eyeParamsRightOffset = (2 * sizeof(EyeParams) + eyeParamsAlignment - 1) /
+                           eyeParamsAlignment * eyeParamsAlignment;
+    eyeParamsRing.GlSetup(eyeParamsRightOffset + GLsizeiptr(sizeof(EyeParams)));
+
+    // attributeless draws use a vertex array object without any enabled attribute arrays, so
+    // the client arrays used by the other passes are never read
+    glGenVertexArrays(1, &emptyVertexArray);
+    vrGuiPanel.GlSetup();
+    vrGuiText.GlSetup();
+    vrGuiLayer.GlSetup();
+    // the layer is seen from the center of the GUI sphere, without any head rotation
+    const EyeParams layerParams{glm::mat4(1.0f), vrGuiLayer.GetProjection(), FULL_UV_RECT};
+    glGenBuffers(1, &vrGuiLayerParamsBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, vrGuiLayerParamsBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(layerParams), &layerParams, GL_STATIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glGenBuffers(static_cast<GLsizei>(meshGridBuffers.size()), meshGridBuffers.data());
+    meshGridChanged = true;
+    CHECK_GL_ERROR("Procedural mesh buffers");
+
+    InitVideoTexture(env, videoTexture);
+    toneMap.GlSetup();
+    anaglyph.GlSetup();
+    videoMipmap.GlSetup();
+    InitStaticTexture(env, buttonTexture, "buttons-texture.png", true);
+    // averaging distance fields would round the corners off
+    InitStaticTexture(env, guiAtlasTexture, VR_GUI_ATLAS_TEXTURE, false);
+}
+
+void Renderer::DrawFrame(float videoPosition, bool newVideoFrame, JNIEnv *env) {
     if (!UpdateDeviceParams()) {
+        // keep trying until the viewer parameters are there
+        frameScheduler.Invalidate();
         return;
     }
 
+    frameDisplayTimeNanos = displayTiming.BeginFrame();
     UpdatePose(env);
+    UpdateLoadedMeshes();
+    if (meshChanged) {
+        meshChanged = false;
+        ComputeMesh();
+    }
+
+    UpdateCompositor(env);
+
+    const uint64_t vsyncPeriodNanos = displayTiming.GetVsyncPeriodNanos();
+    if (vsyncPeriodNanos != 0) {
+        dynamicResolution.SetTargetFrameNanos(FrameBudgetNanos(vsyncPeriodNanos));
+    }
+    // without GPU timer queries nothing is measured, and the eye buffers stay at full size
+    uint64_t frameTimeNanos;
+    while (gpuFrameTimer.Poll(frameTimeNanos)) {
+        if (outputMode == OutputMode::CARDBOARD_STEREO &&
+            dynamicResolution.Update(frameTimeNanos)) {
+            // the mask covers the rendered part of the eye buffer only
+            lensMaskChanged = true;
+        }
+    }
+    gpuFrameTimer.BeginFrame();
 
     int minEye, maxEye;
     GLsizei eyeWidth;
+    GLsizei eyeHeight = screenHeight;
+    GLint eyeStride = 0;
     switch (outputMode) {
         case OutputMode::MONO_LEFT:
             minEye = 0;
@@ -323,30 +922,65 @@ void Renderer::DrawFrame(float videoPosition, JNIEnv *env) {
             maxEye = 1;
             eyeWidth = screenWidth;
             break;
-        case OutputMode::CARDBOARD_STEREO:
+        case OutputMode::CARDBOARD_STEREO: {
             minEye = 0;
             maxEye = 1;
-            eyeWidth = screenWidth / 2;
+            const float scale = dynamicResolution.GetScale();
+            eyeWidth = GLsizei(std::lround(float(eyeBufferWidth) * scale));
+            eyeHeight = GLsizei(std::lround(float(eyeBufferHeight) * scale));
+            eyeStride = useEyeTextureArray ? 0 : eyeBufferWidth;
+            UpdateEyeTextureDescriptions(eyeWidth, eyeHeight);
+            foveation.Update(eyeWidth, eyeHeight, eyeBufferWidth, eyeBufferHeight);
             break;
+        }
         default:
             assert(false);
     }
 
-    if (outputMode == OutputMode::CARDBOARD_STEREO) {
+    std::array<MultiResolution::Region, MultiResolution::REGION_COUNT> regions{};
+    const int regionCount = multiResolution.GetRegions(0, eyeWidth, eyeHeight, regions);
+    UpdateRegionParams(regions, regionCount);
+
+    // rendered into their own framebuffers, before the eye buffers are bound
+    if (vrGuiShown) {
+        UpdateVRGuiLayer();
+    }
+    if (videoMipmap.IsEnabled() && (newVideoFrame || !videoMipmap.IsValid())) {
+        videoMipmap.Update(videoTexture);
+    }
+
+    // with the eyes in texture array layers, the multiview framebuffer addresses both of them
+    const bool eyeTextureArray = outputMode == OutputMode::CARDBOARD_STEREO && useEyeTextureArray;
+    if (eyeTextureArray) {
+        glBindFramebuffer(GL_FRAMEBUFFER, multiviewFramebuffer);
+    } else if (outputMode == OutputMode::CARDBOARD_STEREO || compositor.IsRunning()) {
         glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
     } else {
         glBindFramebuffer(GL_FRAMEBUFFER, GL_NONE);
     }
     CHECK_GL_ERROR("Framebuffer");
 
-    glDisable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
-    glDisable(GL_SCISSOR_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState &glState = GetGLState();
+    glState.SetEnabled(GL_DEPTH_TEST, false);
+    glState.SetEnabled(GL_CULL_FACE, true);
+    glState.SetEnabled(GL_SCISSOR_TEST, false);
+    glState.BindVertexArray(0);
     glClear(GL_COLOR_BUFFER_BIT);
     CHECK_GL_ERROR("Params");
 
+    if (outputMode == OutputMode::CARDBOARD_STEREO) {
+        if (lensMaskChanged) {
+            RenderLensMasks(regions, regionCount);
+            lensMaskChanged = false;
+        }
+        // skip the eye buffer pixels the lenses never show
+        glState.SetEnabled(GL_STENCIL_TEST, true);
+        glStencilFunc(GL_EQUAL, 1, 0xff);
+        glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    } else {
+        glState.SetEnabled(GL_STENCIL_TEST, false);
+    }
+
     time_t now = time(nullptr);
     if (vrProgressBarShown) {
         if (now >= vrGuiProgressBarHideAt) {
@@ -357,74 +991,288 @@ void Renderer::DrawFrame(float videoPosition, JNIEnv *env) {
         }
     }
 
-    for (int eye = minEye; eye <= maxEye; ++eye) {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_EXTERNAL_OES, videoTexture);
-        glUseProgram(programVideo);
-        glViewport((eye - minEye) * eyeWidth, 0, eyeWidth, screenHeight);
-
-        auto mvpMatrix = BuildMVPMatrix(eye);
-        glUniformMatrix4fv(programVideoParamMVPMatrix, 1, GL_FALSE, glm::value_ptr(mvpMatrix));
-
-        auto colorMapMatrix = BuildColorMapMatrix(eye);
-        glUniformMatrix4fv(programVideoParamColorMapMatrix, 1, GL_FALSE,
-                           glm::value_ptr(colorMapMatrix));
-
-        eyeMeshes[eye].Render(programVideoParamPosition, programVideoParamUV);
-        CHECK_GL_ERROR("Render progress bar");
-
-        if (vrProgressBarShown) {
-            glUseProgram(program2D);
-            vrGuiProgressBar.render(program2DParamPosition);
-            CHECK_GL_ERROR("Render progress bar");
+    if (meshGridChanged) {
+        for (int eye = 0; eye < 2; ++eye) {
+            eyeProceduralMeshes[eye].Upload(meshGridBuffers[eye]);
         }
-
-        if (vrGuiShown) {
-            glUseProgram(programVRGui);
-            glBindTexture(GL_TEXTURE_2D, buttonTexture);
-            glm::mat4 guiMvpMatrix = glm::rotate(mvpMatrix, (float) M_PI - vrGuiCenterTheta,
-                                                 Y_AXIS);
-            glUniformMatrix4fv(programVRGuiParamMVPMatrix, 1, GL_FALSE,
-                               glm::value_ptr(guiMvpMatrix));
-            for (const VRGuiButton &button: vrGuiButtons) {
-                button.render(programVRGuiParamPosition, programVRGuiParamUV);
+        meshGridChanged = false;
+        CHECK_GL_ERROR("Mesh grid upload");
+    }
+    toneMap.Update();
+    anaglyph.Update();
+
+    // both eyes are submitted at once by a multiview pass, or else as two instances of every draw;
+    // the instances cannot be split into the multi-resolution regions
+    ViewMode viewMode = ViewMode::SINGLE;
+    if (outputMode == OutputMode::CARDBOARD_STEREO && eyeMeshesShared) {
+        if (eyeTextureArray) {
+            viewMode = ViewMode::MULTIVIEW;
+        } else if (!multiResolution.IsEnabled()) {
+            viewMode = ViewMode::INSTANCED;
+        }
+    }
+    UpdateEyeParams();
+    if (viewMode == ViewMode::INSTANCED) {
+        UpdateViewParams(eyeWidth);
+        glState.Viewport(0, 0, 2 * eyeBufferWidth, eyeHeight);
+        RenderEyeViews(viewMode, 0);
+    } else {
+        const int viewCount = viewMode == ViewMode::SINGLE ? 1 : 2;
+        for (int eye = minEye; eye <= maxEye; eye += viewCount) {
+            if (eyeTextureArray && viewMode == ViewMode::SINGLE) {
+                glBindFramebuffer(GL_FRAMEBUFFER, layerFramebuffers[eye]);
+            }
+            for (int region = 0; region < regionCount; ++region) {
+                const glm::ivec4 &viewport = regions[region].viewport;
+                if (viewport.z <= 0 || viewport.w <= 0) {
+                    continue;
+                }
+                BindRegionParams(region + 1);
+                glState.Viewport((eye - minEye) * eyeStride + viewport.x, viewport.y,
+                                 viewport.z, viewport.w);
+                RenderEyeViews(viewMode, eye);
             }
-
-            glUseProgram(program2D);
-            RenderPointer();
-            CHECK_GL_ERROR("Render GUI");
         }
+        BindRegionParams(0);
     }
-
-    if (outputMode == OutputMode::CARDBOARD_STEREO) {
-        CardboardDistortionRenderer_renderEyeToDisplay(
-                cardboardDistortionRenderer.get(), 0,
-                0, 0, screenWidth, screenHeight,
-                &cardboardEyeTextureDescriptions[0], &cardboardEyeTextureDescriptions[1]
+    eyeParamsRing.EndFrame();
+
+    if (compositor.IsRunning()) {
+        // the compositor reprojects and distorts the copies at display rate
+        glState.SetEnabled(GL_STENCIL_TEST, false);
+        const Compositor::Frame frame{cardboardEyeTextureDescriptions, multiResolution,
+                                      viewMatrix};
+        const std::array<GLuint, 2> sourceFramebuffers =
+                eyeTextureArray ? layerFramebuffers : std::array<GLuint, 2>{framebuffer, 0};
+        compositor.Submit(sourceFramebuffers,
+                          std::min((maxEye - minEye) * eyeStride + eyeWidth, 2 * eyeBufferWidth),
+                          eyeHeight, frame);
+    } else if (outputMode == OutputMode::CARDBOARD_STEREO) {
+        glState.SetEnabled(GL_STENCIL_TEST, false);
+        distortionRenderer.RenderEyeToDisplay(
+                eyeTextureArray ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D, multiResolution,
+                LatchReprojection(), 0, 0, 0, screenWidth, screenHeight,
+                cardboardEyeTextureDescriptions[0], cardboardEyeTextureDescriptions[1]
         );
         CHECK_GL_ERROR("Render cardboard");
 
         glBindFramebuffer(GL_FRAMEBUFFER, GL_NONE);
-        glViewport(0, 0, screenWidth, screenHeight);
-        glUseProgram(program2D);
-        RenderCardboardAlignLine();
+        glState.Viewport(0, 0, screenWidth, screenHeight);
+        const EyePrograms &programs = eyePrograms[static_cast<int>(ViewMode::SINGLE)];
+        glState.UseProgram(programs.program2D);
+        RenderCardboardAlignLine(programs.program2DParamPosition);
         CHECK_GL_ERROR("Align line");
     }
 
+    gpuFrameTimer.EndFrame();
     ++frameCount;
+    frameScheduler.OnFrameDrawn(glm::quat_cast(glm::mat3(viewMatrix)),
+                                vrGuiShown || vrProgressBarShown);
+    if (frameCount % kTimingLogFrames == 0) {
+        LOG_DEBUG("Pose prediction error %.1f ms",
+                  double(displayTiming.GetModel().GetPredictionErrorNanos()) * 1e-6);
+    }
+
+    // the swap of the offscreen surface does not wait for the display
+    if (compositor.IsRunning()) {
+        compositor.WaitForDisplay();
+    }
 }
 
-void Renderer::RenderPointer() {
+/**
+ * Renders the video and the GUI for the views of the mode starting with firstEye, into the bound
+ * framebuffer and viewport.
+ */
+void Renderer::RenderEyeViews(ViewMode mode, int firstEye) {
+    const EyePrograms &programs = eyePrograms[static_cast<int>(mode)];
+    const GLsizei instanceCount = mode == ViewMode::INSTANCED ? 2 : 1;
+    const int viewCount = mode == ViewMode::SINGLE ? 1 : 2;
+    eyeParamsRing.BindRange(EYE_PARAMS_BINDING, firstEye == 0 ? 0 : eyeParamsRightOffset,
+                            viewCount * GLsizeiptr(sizeof(EyeParams)));
+
+    // the video is opaque, only the GUI drawn over it blends
+    GLState &glState = GetGLState();
+    glState.SetEnabled(GL_BLEND, false);
+    if (videoVariant == VideoVariant::TONE_MAP) {
+        glState.ActiveTexture(GL_TEXTURE0 + TONE_MAP_TEXTURE_UNIT);
+        glState.BindTexture(GL_TEXTURE_3D, toneMap.GetTexture());
+    } else if (videoVariant == VideoVariant::ANAGLYPH) {
+        glState.ActiveTexture(GL_TEXTURE0 + ANAGLYPH_TEXTURE_UNIT);
+        glState.BindTexture(GL_TEXTURE_3D, anaglyph.GetTexture());
+    }
+    glState.ActiveTexture(GL_TEXTURE0);
+    const VideoSource source = videoMipmap.IsEnabled() ? VideoSource::MIPMAP
+                                                       : VideoSource::EXTERNAL;
+    if (source == VideoSource::MIPMAP) {
+        glState.BindTexture(GL_TEXTURE_2D, videoMipmap.GetTexture());
+    } else {
+        glState.BindTexture(GL_TEXTURE_EXTERNAL_OES, videoTexture);
+    }
+
+    const ProceduralMesh &proceduralMesh = eyeProceduralMeshes[firstEye];
+    if (proceduralMesh.IsEmpty()) {
+        const VideoProgram &video =
+                programs.video[static_cast<int>(source)][static_cast<int>(videoVariant)];
+        glState.UseProgram(video.program);
+        const TexturedMesh &mesh = eyeMeshes[firstEye];
+        if (inputVideoMode == InputVideoMode::CUSTOM_MESH) {
+            // imported meshes do not have any consistent winding
+            glState.SetEnabled(GL_CULL_FACE, false);
+            mesh.Render(video.paramPosition, video.paramUV, instanceCount);
+            glState.SetEnabled(GL_CULL_FACE, true);
+        } else {
+            mesh.Render(video.paramPosition, video.paramUV, instanceCount);
+        }
+    } else {
+        glState.UseProgram(
+                programs.videoProcedural[static_cast<int>(source)][static_cast<int>(videoVariant)]);
+        glBindBufferBase(GL_UNIFORM_BUFFER, MESH_GRID_BINDING, meshGridBuffers[firstEye]);
+        glState.BindVertexArray(emptyVertexArray);
+        proceduralMesh.Render(instanceCount);
+        glState.BindVertexArray(0);
+    }
+    CHECK_GL_ERROR("Render video");
+
+    if (vrProgressBarShown || vrGuiShown) {
+        glState.SetEnabled(GL_BLEND, true);
+        glState.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+
+    if (vrProgressBarShown) {
+        glState.UseProgram(programs.program2D);
+        vrGuiProgressBar.render(programs.program2DParamPosition, instanceCount);
+        CHECK_GL_ERROR("Render progress bar");
+    }
+
+    if (vrGuiShown) {
+        // the layer is premultiplied
+        glState.BlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        glState.UseProgram(programs.programVRGui);
+        glState.BindTexture(GL_TEXTURE_2D, vrGuiLayer.GetTexture());
+        vrGuiLayer.Render(instanceCount);
+
+        glState.UseProgram(programs.program2D);
+        RenderPointer(programs.program2DParamPosition, instanceCount);
+        CHECK_GL_ERROR("Render GUI");
+    }
+}
+
+/**
+ * Uploads the clip transforms of the regions after the identity one, which is left bound.
+ */
+void Renderer::UpdateRegionParams(
+        const std::array<MultiResolution::Region, MultiResolution::REGION_COUNT> &regions,
+        int regionCount) {
+    glBindBuffer(GL_UNIFORM_BUFFER, regionParamsBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, (regionCount + 1) * regionParamsStride, nullptr,
+                 GL_STREAM_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::vec4),
+                    glm::value_ptr(IDENTITY_REGION_TRANSFORM));
+    for (int region = 0; region < regionCount; ++region) {
+        glBufferSubData(GL_UNIFORM_BUFFER, (region + 1) * regionParamsStride, sizeof(glm::vec4),
+                        glm::value_ptr(regions[region].transform));
+    }
+    BindRegionParams(0);
+    CHECK_GL_ERROR("Region params");
+}
+
+void Renderer::BindRegionParams(int index) {
+    glBindBufferRange(GL_UNIFORM_BUFFER, REGION_PARAMS_BINDING, regionParamsBuffer,
+                      index * regionParamsStride, sizeof(glm::vec4));
+}
+
+void Renderer::RenderLensMasks(
+        const std::array<MultiResolution::Region, MultiResolution::REGION_COUNT> &regions,
+        int regionCount) {
+    GLState &glState = GetGLState();
+    glState.SetEnabled(GL_STENCIL_TEST, true);
+    glStencilFunc(GL_ALWAYS, 1, 0xff);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glState.SetEnabled(GL_CULL_FACE, false);
+
+    const EyePrograms &programs = eyePrograms[static_cast<int>(ViewMode::SINGLE)];
+    glState.UseProgram(programs.program2D);
+    auto renderMask = [&](int eye, GLint x) {
+        for (int region = 0; region < regionCount; ++region) {
+            const glm::ivec4 &viewport = regions[region].viewport;
+            BindRegionParams(region + 1);
+            glState.Viewport(x + viewport.x, viewport.y, viewport.z, viewport.w);
+            lensMasks[eye].Render(programs.program2DParamPosition);
+        }
+    };
+    if (useEyeTextureArray) {
+        // the masks differ per eye, so each layer gets its own single-view pass
+        for (int eye = 0; eye < 2; ++eye) {
+            glBindFramebuffer(GL_FRAMEBUFFER, layerFramebuffers[eye]);
+            glClear(GL_STENCIL_BUFFER_BIT);
+            renderMask(eye, 0);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, multiviewFramebuffer);
+    } else {
+        glClear(GL_STENCIL_BUFFER_BIT);
+        for (int eye = 0; eye < 2; ++eye) {
+            renderMask(eye, eye * eyeBufferWidth);
+        }
+    }
+    BindRegionParams(0);
+
+    glState.SetEnabled(GL_CULL_FACE, true);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    CHECK_GL_ERROR("Render lens mask");
+}
+
+void Renderer::RenderPointer(GLint programParamPosition, GLsizei instanceCount) {
     // TODO: Pointer size? gl_PointSize?
-    glEnableVertexAttribArray(program2DParamPosition);
-    glVertexAttribPointer(program2DParamPosition, 3, GL_FLOAT, GL_FALSE, 0, pointerCoords.data());
+    GetGLState().EnableVertexAttribArray(programParamPosition);
+    glVertexAttribPointer(programParamPosition, 3, GL_FLOAT, GL_FALSE, 0, pointerCoords.data());
+
+    glDrawElementsInstanced(GL_POINTS, 1, GL_UNSIGNED_BYTE, trivial2DData, instanceCount);
+}
+
+/**
+ * Writes the parameters of both eyes for the frame, read by every eye program.
+ */
+void Renderer::UpdateEyeParams() {
+    std::array<EyeParams, 2> eyeParams{};
+    for (int eye = 0; eye < 2; ++eye) {
+        EyeParams &params = eyeParams[eye];
+        params.mvp = BuildMVPMatrix(eye);
+        params.guiMvp = glm::rotate(params.mvp, (float) M_PI - vrGuiCenterTheta, Y_AXIS);
+        params.uvRect = eyeMeshUVRects[eye];
+        params.anaglyphLutOffset = Anaglyph::LutOffset(eye);
+    }
+
+    auto *data = static_cast<uint8_t *>(eyeParamsRing.MapNextFrame());
+    if (data == nullptr) {
+        return;
+    }
+    std::memcpy(data, eyeParams.data(), sizeof(eyeParams));
+    std::memcpy(data + eyeParamsRightOffset, &eyeParams[1], sizeof(EyeParams));
+    eyeParamsRing.Unmap();
+    CHECK_GL_ERROR("Eye params");
+}
 
-    glDrawElements(GL_POINTS, 1, GL_UNSIGNED_BYTE, trivial2DData);
+/**
+ * Places the instanced stereo views side by side: eye e goes into the eyeWidth wide part of its
+ * eyeBufferWidth wide half of the viewport spanning both eyes.
+ */
+void Renderer::UpdateViewParams(GLsizei eyeWidth) {
+    const float scale = float(eyeWidth) / float(eyeBufferWidth);
+    std::array<glm::vec4, 2> viewParams{};
+    for (int eye = 0; eye < 2; ++eye) {
+        viewParams[eye] = glm::vec4(0.5f * scale, float(eye) - 1.0f + 0.5f * scale,
+                                    float(eye * eyeBufferWidth),
+                                    float(eye * eyeBufferWidth + eyeWidth));
+    }
+    glBindBufferBase(GL_UNIFORM_BUFFER, VIEW_PARAMS_BINDING, viewParamsBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(viewParams), viewParams.data(), GL_STREAM_DRAW);
+    CHECK_GL_ERROR("View params");
 }
 
-void Renderer::RenderCardboardAlignLine() {
-    glEnableVertexAttribArray(program2DParamPosition);
-    glVertexAttribPointer(program2DParamPosition, 3, GL_FLOAT, GL_FALSE, 0,
+void Renderer::RenderCardboardAlignLine(GLint programParamPosition) {
+    GetGLState().EnableVertexAttribArray(programParamPosition);
+    glVertexAttribPointer(programParamPosition, 3, GL_FLOAT, GL_FALSE, 0,
                           cardboardAlignLineCoords.data());
 
     glDrawElements(GL_LINES, 2, GL_UNSIGNED_BYTE, trivial2DData);
@@ -455,29 +1303,41 @@ bool Renderer::UpdateDeviceParams() {
         CardboardQrCode_destroy(cardboardQrCode);
     }
 
+    UpdateEyeBufferSize();
+    dynamicResolution.Reset();
     GlSetup();
 
     if (outputMode == OutputMode::CARDBOARD_STEREO) {
-        const CardboardOpenGlEsDistortionRendererConfig config{kGlTexture2D};
-        cardboardDistortionRenderer = CardboardDistortionRendererPointer(
-                CardboardOpenGlEs2DistortionRenderer_create(&config)
-        );
-
         CardboardMesh leftMesh;
         CardboardMesh rightMesh;
         CardboardLensDistortion_getDistortionMesh(cardboardLensDistortion.get(), kLeft, &leftMesh);
         CardboardLensDistortion_getDistortionMesh(cardboardLensDistortion.get(), kRight,
                                                   &rightMesh);
 
-        CardboardDistortionRenderer_setMesh(cardboardDistortionRenderer.get(), &leftMesh, kLeft);
-        CardboardDistortionRenderer_setMesh(cardboardDistortionRenderer.get(), &rightMesh, kRight);
+        lensMasks[0].SetDistortionMesh(leftMesh);
+        lensMasks[1].SetDistortionMesh(rightMesh);
+        lensMaskChanged = true;
+        distortionRenderer.SetMesh(0, leftMesh);
+        distortionRenderer.SetMesh(1, rightMesh);
+
+        std::array<float, 4> fieldOfView{};
+        CardboardLensDistortion_getFieldOfView(cardboardLensDistortion.get(), kLeft,
+                                               fieldOfView.data());
+        foveation.SetLens(0, fieldOfView);
+        distortionRenderer.SetFieldOfView(0, fieldOfView);
+        compositor.SetLens(0, leftMesh, fieldOfView);
+        CardboardLensDistortion_getFieldOfView(cardboardLensDistortion.get(), kRight,
+                                               fieldOfView.data());
+        foveation.SetLens(1, fieldOfView);
+        distortionRenderer.SetFieldOfView(1, fieldOfView);
+        compositor.SetLens(1, rightMesh, fieldOfView);
 
         // Get eye matrices
         CardboardLensDistortion_getEyeFromHeadMatrix(cardboardLensDistortion.get(), kLeft,
                                                      glm::value_ptr(cardboardEyeMatrices[0]));
         CardboardLensDistortion_getEyeFromHeadMatrix(cardboardLensDistortion.get(), kRight,
                                                      glm::value_ptr(cardboardEyeMatrices[1]));
-        CardboardLensDistortion_getProjectionMatrix(cardboardLensDistortion.get(), kRight, kzNear,
+        CardboardLensDistortion_getProjectionMatrix(cardboardLensDistortion.get(), kLeft, kzNear,
                                                     kzFar,
                                                     glm::value_ptr(cardboardProjectionMatrices[0]));
         CardboardLensDistortion_getProjectionMatrix(cardboardLensDistortion.get(), kRight, kzNear,
@@ -493,24 +1353,241 @@ bool Renderer::UpdateDeviceParams() {
     return true;
 }
 
+/**
+ * Eye texture coordinates per normalized device coordinate of the eye viewport, at the part of
+ * the distortion mesh closest to the given point in texture coordinates.
+ */
+static glm::vec2 DistortionMagnification(const CardboardMesh &mesh, const glm::vec2 &center) {
+    auto position = [&](int index) {
+        return glm::vec2(mesh.vertices[2 * index], mesh.vertices[2 * index + 1]);
+    };
+    auto uv = [&](int index) {
+        return glm::vec2(mesh.uvs[2 * index], mesh.uvs[2 * index + 1]);
+    };
+
+    glm::vec2 result{1.0f, 1.0f};
+    float bestDistance = std::numeric_limits<float>::max();
+    // every three consecutive indices of the strip form a triangle, some of them degenerate
+    for (int i = 0; i + 2 < mesh.n_indices; ++i) {
+        const int a = mesh.indices[i];
+        const int b = mesh.indices[i + 1];
+        const int c = mesh.indices[i + 2];
+        const glm::mat2 positions{position(b) - position(a), position(c) - position(a)};
+        const float det = glm::determinant(positions);
+        if (std::abs(det) < 1e-9f) {
+            continue;
+        }
+        const float distance = glm::length((uv(a) + uv(b) + uv(c)) / 3.0f - center);
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            // the triangle maps positions to texture coordinates affinely
+            const glm::mat2 uvs{uv(b) - uv(a), uv(c) - uv(a)};
+            const glm::mat2 jacobian = uvs * glm::inverse(positions);
+            result = {std::abs(jacobian[0][0]), std::abs(jacobian[1][1])};
+        }
+    }
+    return result;
+}
+
+/**
+ * Eye buffer density the lens needs outside of the center bounds, relative to the lens center: the
+ * magnification of the periphery bands at their middles, on both sides. The lenses mirror each
+ * other, so the inner and outer sides of one of them cover both.
+ */
+static glm::vec2 PeripheryDensity(const CardboardMesh &mesh, const glm::vec2 &lensCenter,
+                                  const glm::vec4 &centerBounds) {
+    const glm::vec2 center = DistortionMagnification(mesh, lensCenter);
+    const std::array<glm::vec2, 2> bandsX{
+            DistortionMagnification(mesh, {0.5f * centerBounds.x, lensCenter.y}),
+            DistortionMagnification(mesh, {0.5f * (centerBounds.z + 1.0f), lensCenter.y})
+    };
+    const std::array<glm::vec2, 2> bandsY{
+            DistortionMagnification(mesh, {lensCenter.x, 0.5f * centerBounds.y}),
+            DistortionMagnification(mesh, {lensCenter.x, 0.5f * (centerBounds.w + 1.0f)})
+    };
+    return {center.x / std::min(bandsX[0].x, bandsX[1].x),
+            center.y / std::min(bandsY[0].y, bandsY[1].y)};
+}
+
+/**
+ * Foveation profile shading at least the density the lens needs relative to its center, at the
+ * sample points along both axes from the lens center to the edges of the view: the gain is the
+ * largest one whose density stays above all of them, the minimum density is the lowest of them.
+ */
+static FoveationProfile LensFoveationProfile(const CardboardMesh &mesh, const glm::vec2 &lensCenter,
+                                             const glm::vec2 &tangentSpan) {
+    const glm::vec2 center = DistortionMagnification(mesh, lensCenter);
+    float gain = std::numeric_limits<float>::max();
+    float minDensity = 1.0f;
+    for (int axis = 0; axis < 2; ++axis) {
+        for (float edge: {0.0f, 1.0f}) {
+            for (int sample = 1; sample <= FOVEATION_SAMPLES; ++sample) {
+                glm::vec2 point = lensCenter;
+                point[axis] += (edge - lensCenter[axis]) * float(sample) / float(FOVEATION_SAMPLES);
+                const float density = glm::clamp(
+                        center[axis] / DistortionMagnification(mesh, point)[axis],
+                        MIN_FOVEATION_DENSITY, 1.0f);
+                const float tangent = std::abs(point[axis] - lensCenter[axis]) * tangentSpan[axis];
+                // 1 / (gain * tangent)^2 >= density
+                if (density < 1.0f && tangent > 0.0f) {
+                    gain = std::min(gain, 1.0f / (tangent * std::sqrt(density)));
+                }
+                minDensity = std::min(minDensity, density);
+            }
+        }
+    }
+    if (minDensity >= 1.0f) {
+        return {0.0f, 0.0f, 1.0f};
+    }
+    return {gain, 0.0f, minDensity};
+}
+
+/**
+ * Video pixels per radian at the center of the view, or 0 if the mode does not say.
+ */
+static float VideoPixelDensity(InputVideoLayout layout, InputVideoMode mode, int videoWidth,
+                               int videoHeight) {
+    const float viewWidth = layout == InputVideoLayout::STEREO_HORIZ ? 0.5f * float(videoWidth)
+                                                                     : float(videoWidth);
+    const float viewHeight = layout == InputVideoLayout::STEREO_VERT ? 0.5f * float(videoHeight)
+                                                                     : float(videoHeight);
+    switch (mode) {
+        case InputVideoMode::PLAIN_FOV:
+            // the longer side spans 90 degrees at distance 1
+            return 0.5f * std::max(viewWidth, viewHeight);
+        case InputVideoMode::EQUIRECT_180:
+        case InputVideoMode::PANORAMA_180:
+            return viewWidth / float(M_PI);
+        case InputVideoMode::EQUIRECT_360:
+        case InputVideoMode::PANORAMA_360:
+            return viewWidth / float(2.0 * M_PI);
+        case InputVideoMode::CUBE_MAP:
+            // a face is a third of the width and spans tangents -1..1
+            return viewWidth / 6.0f;
+        case InputVideoMode::EQUIANG_CUBE_MAP:
+            return viewWidth / 3.0f / float(M_PI_2);
+        case InputVideoMode::FISHEYE_180:
+            // the image circle is inscribed in the view
+            return std::min(viewWidth, viewHeight) / float(M_PI);
+        default:
+            return 0.0f;
+    }
+}
+
+/**
+ * Sizes the eye buffer so that at the lens center one texel covers about one screen pixel, unless
+ * the video has less detail than that, scaled by the quality setting.
+ */
+void Renderer::UpdateEyeBufferSize() {
+    eyeBufferWidth = screenWidth / 2;
+    eyeBufferHeight = screenHeight;
+    multiResolution.Disable();
+    const float videoDensity = VideoPixelDensity(inputVideoLayout, inputVideoMode, videoWidth,
+                                                 videoHeight);
+    if (outputMode != OutputMode::CARDBOARD_STEREO) {
+        // the screen height spans the vertical field of view of BuildMVPMatrix
+        const float tangentSpan = inputVideoMode == InputVideoMode::PLAIN_FOV
+                                  ? 2.0f / screenAspect
+                                  : 2.0f * std::tan(glm::radians(45.0f) / screenAspect);
+        videoMinification = videoDensity * tangentSpan / float(screenHeight);
+        return;
+    }
+
+    // left, right, bottom, top half-angles
+    std::array<float, 4> fov{};
+    CardboardLensDistortion_getFieldOfView(cardboardLensDistortion.get(), kLeft, fov.data());
+    const glm::vec2 tangentsLow{std::tan(fov[0]), std::tan(fov[2])};
+    const glm::vec2 tangentSpan = tangentsLow + glm::vec2(std::tan(fov[1]), std::tan(fov[3]));
+
+    CardboardMesh mesh;
+    CardboardLensDistortion_getDistortionMesh(cardboardLensDistortion.get(), kLeft, &mesh);
+    const glm::vec2 lensCenter = tangentsLow / tangentSpan;
+    const glm::vec2 magnification = DistortionMagnification(mesh, lensCenter);
+    glm::vec2 size = glm::vec2(0.5f * float(screenWidth), float(screenHeight)) /
+                     (2.0f * magnification);
+
+    if (videoDensity > 0.0f) {
+        size = glm::min(size, videoDensity * tangentSpan);
+    }
+    size *= eyeBufferQuality;
+    videoMinification = videoDensity * tangentSpan.x / size.x;
+
+    if (GetGLExtensions().textureFoveated) {
+        const FoveationProfile profile = LensFoveationProfile(mesh, lensCenter, tangentSpan);
+        foveation.SetProfile(profile);
+        LOG_DEBUG("Foveation gain %.2f, min density %.2f", profile.gain, profile.minDensity);
+    } else {
+        // lens-matched multi-resolution shading takes over where the GPU cannot foveate
+        const glm::vec2 density = glm::clamp(
+                PeripheryDensity(mesh, lensCenter, MULTI_RESOLUTION_CENTER),
+                MIN_PERIPHERY_DENSITY, 1.0f);
+        if (std::min(density.x, density.y) <= MAX_PERIPHERY_DENSITY) {
+            multiResolution.SetLayout(MULTI_RESOLUTION_CENTER, density);
+            size *= multiResolution.GetPackedScale();
+        }
+        LOG_DEBUG("Periphery density %.2f x %.2f", density.x, density.y);
+    }
+
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    eyeBufferWidth = glm::clamp(int(std::lround(size.x)), MIN_EYE_BUFFER_SIZE, maxTextureSize / 2);
+    eyeBufferHeight = glm::clamp(int(std::lround(size.y)), MIN_EYE_BUFFER_SIZE, maxTextureSize);
+    LOG_DEBUG("Eye buffer %d x %d (lens magnification %.2f x %.2f, video %.1f px/rad, "
+              "minified %.2f)", eyeBufferWidth, eyeBufferHeight, magnification.x, magnification.y,
+              videoDensity, videoMinification);
+}
+
 void Renderer::GlSetup() {
     LOG_DEBUG("GLSetup");
 
+    // the compositor copies of the eye buffers are recreated with them
+    compositor.Stop();
     if (glInitialized) {
         GlTeardown();
     }
     glInitialized = true;
 
+    useEyeTextureArray = outputMode == OutputMode::CARDBOARD_STEREO &&
+                         GetGLExtensions().multiview;
+    eyeBufferFormat = USE_HDR_EYE_BUFFER && toneMap.GetTransfer() != VideoTransfer::SDR
+                      ? GLenum(GL_RGB10_A2) : GLenum(GL_RGB8);
+    if (useEyeTextureArray) {
+        GlSetupEyeTextureArray();
+    } else {
+        GlSetupEyeTexture();
+    }
+    lensMaskChanged = true;
+
+    if (USE_VIDEO_MIPMAP && videoMinification >= VIDEO_MIPMAP_MIN_MINIFICATION) {
+        // the seam of 360° video joins up, unless the views are side by side
+        const bool wrapAround = (inputVideoMode == InputVideoMode::EQUIRECT_360 ||
+                                 inputVideoMode == InputVideoMode::PANORAMA_360) &&
+                                inputVideoLayout != InputVideoLayout::STEREO_HORIZ;
+        videoMipmap.Resize(videoWidth, videoHeight, eyeBufferFormat, wrapAround);
+    } else {
+        videoMipmap.Resize(0, 0, eyeBufferFormat, false);
+    }
+
+    CHECK_GL_ERROR("GlSetup");
+}
+
+/**
+ * Both eyes side by side in a single texture, with a stencil buffer for the lens mask.
+ */
+void Renderer::GlSetupEyeTexture() {
     // Create render texture.
     glGenTextures(1, &renderTexture);
-    glBindTexture(GL_TEXTURE_2D, renderTexture);
+    GetGLState().BindTexture(GL_TEXTURE_2D, renderTexture);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, screenWidth, screenHeight, 0, GL_RGB, GL_UNSIGNED_BYTE,
-                 nullptr);
+    glTexStorage2D(GL_TEXTURE_2D, 1, eyeBufferFormat, 2 * eyeBufferWidth, eyeBufferHeight);
+    // the lenses blur the periphery of the eye buffer anyway
+    if (outputMode == OutputMode::CARDBOARD_STEREO) {
+        foveation.GlSetup(GL_TEXTURE_2D, renderTexture, false);
+    }
 
     // Create render target.
     glGenFramebuffers(1, &framebuffer);
@@ -518,6 +1595,14 @@ void Renderer::GlSetup() {
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, renderTexture, 0);
     CHECK_GL_ERROR("Create render buffer");
 
+    // Stencil for the lens mask, filled on the next frame.
+    glGenRenderbuffers(1, &stencilRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, stencilRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_STENCIL_INDEX8, 2 * eyeBufferWidth, eyeBufferHeight);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
+                              stencilRenderbuffer);
+    CHECK_GL_ERROR("Create stencil buffer");
+
     cardboardEyeTextureDescriptions[0] = {
             .texture = renderTexture,
             .left_u = 0.0f,
@@ -532,8 +1617,78 @@ void Renderer::GlSetup() {
             .top_v = 1.0f,
             .bottom_v = 0.0f
     };
+}
 
-    CHECK_GL_ERROR("GlSetup");
+/**
+ * Each eye in a layer of a texture array, rendered into through a multiview framebuffer covering
+ * both layers, or a framebuffer per layer for the passes that differ per eye.
+ */
+void Renderer::GlSetupEyeTextureArray() {
+    GLState &glState = GetGLState();
+    glGenTextures(1, &eyeTextureArray);
+    glState.BindTexture(GL_TEXTURE_2D_ARRAY, eyeTextureArray);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, eyeBufferFormat, eyeBufferWidth, eyeBufferHeight, 2);
+    foveation.GlSetup(GL_TEXTURE_2D_ARRAY, eyeTextureArray, true);
+
+    // multiview attachments must all be layered, so the lens mask stencil is a texture array too
+    glGenTextures(1, &eyeDepthStencilArray);
+    glState.BindTexture(GL_TEXTURE_2D_ARRAY, eyeDepthStencilArray);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH24_STENCIL8, eyeBufferWidth, eyeBufferHeight,
+                   2);
+    glState.BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    CHECK_GL_ERROR("Create eye texture array");
+
+    const auto glFramebufferTextureMultiviewOVR =
+            GetGLExtensions().glFramebufferTextureMultiviewOVR;
+    glGenFramebuffers(1, &multiviewFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, multiviewFramebuffer);
+    glFramebufferTextureMultiviewOVR(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, eyeTextureArray, 0, 0,
+                                     2);
+    glFramebufferTextureMultiviewOVR(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                                     eyeDepthStencilArray, 0, 0, 2);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        LOG_ERROR("Multiview framebuffer incomplete");
+    }
+
+    glGenFramebuffers(static_cast<GLsizei>(layerFramebuffers.size()), layerFramebuffers.data());
+    for (int eye = 0; eye < 2; ++eye) {
+        glBindFramebuffer(GL_FRAMEBUFFER, layerFramebuffers[eye]);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, eyeTextureArray, 0, eye);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                                  eyeDepthStencilArray, 0, eye);
+    }
+    CHECK_GL_ERROR("Create multiview framebuffer");
+
+    for (int eye = 0; eye < 2; ++eye) {
+        cardboardEyeTextureDescriptions[eye] = {
+                .texture = eyeTextureArray,
+                .left_u = 0.0f,
+                .right_u = 1.0f,
+                .top_v = 1.0f,
+                .bottom_v = 0.0f
+        };
+    }
+}
+
+/**
+ * Points the distortion pass to the part of each eye buffer rendered into this frame.
+ */
+void Renderer::UpdateEyeTextureDescriptions(GLsizei eyeWidth, GLsizei eyeHeight) {
+    // side by side eyes take half of the texture each, texture array layers the whole layer
+    const float eyeUSize = useEyeTextureArray ? 1.0f : 0.5f;
+    const float uSize = eyeUSize * float(eyeWidth) / float(eyeBufferWidth);
+    const float vSize = float(eyeHeight) / float(eyeBufferHeight);
+    for (int eye = 0; eye < 2; ++eye) {
+        const float left = useEyeTextureArray ? 0.0f : eyeUSize * float(eye);
+        cardboardEyeTextureDescriptions[eye].left_u = left;
+        cardboardEyeTextureDescriptions[eye].right_u = left + uSize;
+        cardboardEyeTextureDescriptions[eye].top_v = vSize;
+        cardboardEyeTextureDescriptions[eye].bottom_v = 0.0f;
+    }
 }
 
 void Renderer::GlTeardown() {
@@ -544,8 +1699,20 @@ void Renderer::GlTeardown() {
 
     glDeleteFramebuffers(1, &framebuffer);
     framebuffer = 0;
+    glDeleteRenderbuffers(1, &stencilRenderbuffer);
+    stencilRenderbuffer = 0;
+    glDeleteFramebuffers(1, &multiviewFramebuffer);
+    multiviewFramebuffer = 0;
+    glDeleteFramebuffers(static_cast<GLsizei>(layerFramebuffers.size()), layerFramebuffers.data());
+    layerFramebuffers = {};
+    glDeleteTextures(1, &eyeTextureArray);
+    eyeTextureArray = 0;
+    glDeleteTextures(1, &eyeDepthStencilArray);
+    eyeDepthStencilArray = 0;
     glDeleteTextures(1, &renderTexture);
+    foveation.GlTeardown();
     renderTexture = 0;
+    GetGLState().Reset();
 
     CHECK_GL_ERROR("GlTeardown");
 }
@@ -586,33 +1753,18 @@ glm::mat4 Renderer::BuildMVPMatrix(int eye) {
     return projection * view;
 }
 
-glm::mat4 Renderer::BuildColorMapMatrix(int eye) {
-    if (inputVideoLayout != InputVideoLayout::ANAGLYPH_RED_CYAN) {
-        return glm::mat4(1.0f);
-    }
-
-    assert(eye >= 0 && eye <= 1);
-    switch (eye) {
-        case 0:
-            // red
-            return {
-                    1.0f, 1.0f, 1.0f, 0.0f,
-                    0.0f, 0.0f, 0.0f, 0.0f,
-                    0.0f, 0.0f, 0.0f, 0.0f,
-                    0.0f, 0.0f, 0.0f, 1.0f,
-            };
-
-        case 1:
-            // cyan
-            return {
-                    0.0f, 0.0f, 0.0f, 0.0f,
-                    0.0f, 1.0f, 0.0f, 0.0f,
-                    0.0f, 0.0f, 1.0f, 0.0f,
-                    0.0f, 0.0f, 0.0f, 1.0f,
-            };
-
+static AnaglyphMethod LayoutAnaglyphMethod(InputVideoLayout layout) {
+    switch (layout) {
+        case InputVideoLayout::ANAGLYPH_RED_CYAN:
+            return AnaglyphMethod::DUBOIS_RED_CYAN;
+        case InputVideoLayout::ANAGLYPH_RED_CYAN_HALF_COLOR:
+            return AnaglyphMethod::HALF_COLOR_RED_CYAN;
+        case InputVideoLayout::ANAGLYPH_GREEN_MAGENTA:
+            return AnaglyphMethod::DUBOIS_GREEN_MAGENTA;
+        case InputVideoLayout::ANAGLYPH_AMBER_BLUE:
+            return AnaglyphMethod::DUBOIS_AMBER_BLUE;
         default:
-            std::abort();
+            return AnaglyphMethod::NONE;
     }
 }
 
@@ -621,11 +1773,48 @@ void Renderer::SetOptions(InputVideoLayout requestedInputLayout, InputVideoMode
     LOG_DEBUG("SetOptions(%d, %d, %d)", requestedInputLayout, requestedInputMode,
               requestedOutputMode);
     deviceParamsChanged |= requestedOutputMode != this->outputMode;
+    // the eye buffer size depends on the video pixel density
+    screenParamsChanged |= requestedInputLayout != this->inputVideoLayout ||
+                           requestedInputMode != this->inputVideoMode;
 
     this->inputVideoLayout = requestedInputLayout;
     this->inputVideoMode = requestedInputMode;
     this->outputMode = requestedOutputMode;
-    ComputeMesh();
+    anaglyph.SetMethod(LayoutAnaglyphMethod(requestedInputLayout));
+    UpdateVideoVariant();
+    meshChanged = true;
+    UpdateHeadTracker();
+    frameScheduler.Invalidate();
+}
+
+void Renderer::SetVideoTransfer(VideoTransfer transfer) {
+    LOG_DEBUG("SetVideoTransfer(%d)", transfer);
+    // the eye buffers are recreated in the format for the video
+    screenParamsChanged |= (transfer != VideoTransfer::SDR) !=
+                           (toneMap.GetTransfer() != VideoTransfer::SDR);
+    toneMap.SetTransfer(transfer);
+    UpdateVideoVariant();
+    frameScheduler.Invalidate();
+}
+
+/**
+ * Anaglyph video is never HDR, so the tone map takes precedence over the anaglyph LUTs.
+ */
+void Renderer::UpdateVideoVariant() {
+    if (toneMap.GetTransfer() != VideoTransfer::SDR) {
+        videoVariant = VideoVariant::TONE_MAP;
+    } else if (anaglyph.GetMethod() != AnaglyphMethod::NONE) {
+        videoVariant = VideoVariant::ANAGLYPH;
+    } else {
+        videoVariant = VideoVariant::PLAIN;
+    }
+}
+
+void Renderer::SetEyeBufferQuality(float quality) {
+    LOG_DEBUG("SetEyeBufferQuality(%.2f)", quality);
+    eyeBufferQuality = glm::clamp(quality, MIN_EYE_BUFFER_QUALITY, MAX_EYE_BUFFER_QUALITY);
+    screenParamsChanged = true;
+    frameScheduler.Invalidate();
 }
 
 void Renderer::ScanCardboardQr() {
@@ -633,228 +1822,298 @@ void Renderer::ScanCardboardQr() {
     CardboardQrCode_scanQrCodeAndSaveDeviceParams();
 }
 
-void Renderer::ShowProgressBar() {
-    LOG_DEBUG("ShowProgressBar");
-    vrProgressBarShown = true;
-    vrGuiProgressBarHideAt = time(nullptr) + PROGRESS_BAR_SHOW_TIME;
+void Renderer::SetVRGuiTitle(const std::string &title) {
+    std::lock_guard<std::mutex> lock(vrGuiTitleMutex);
+    vrGuiTitle = title;
+    vrGuiTitleChanged = true;
+    frameScheduler.Invalidate();
 }
 
-static TexturedMesh
-BuildUvSphereMesh(int n_slices, int n_stacks, float minTheta, float maxTheta, float uvLeft,
-                  float uvTop, float uvRight, float uvBottom) {
-    TexturedMesh::Builder meshBuilder;
-
-    float uvWidth = uvRight - uvLeft;
-    float uvHeight = uvBottom - uvTop;
-    float thetaRange = maxTheta - minTheta;
-
-    // generate vertices per stack / slice
-    for (int i = 0; i <= n_stacks; i++) {
-        auto vFrac = float(i) / float(n_stacks);
-        auto phi = float(M_PI) * vFrac;
-        auto v = vFrac * uvHeight + uvTop;
-
-        for (int j = 0; j <= n_slices; j++) {
-            auto uFrac = float(j) / float(n_slices);
-            auto theta = -(minTheta + thetaRange * uFrac);
-            auto u = uFrac * uvWidth + uvLeft;
-            auto x = std::sinf(phi) * std::sinf(theta);
-            auto y = std::cosf(phi);
-            auto z = std::sinf(phi) * std::cosf(theta);
-
-            // texture correction for top- and bottom-layer vertices (collapsed into a point)
-            if ((i == 0) || (i == n_stacks)) {
-                u += 1.0f / float(n_slices);
-                if (u > 1.0f) u -= 1.0f;
-            }
-
-            meshBuilder.add_vertex(x, y, z, u, v);
+bool Renderer::UpdateVRGuiText() {
+    {
+        std::lock_guard<std::mutex> lock(vrGuiTitleMutex);
+        if (vrGuiTitleChanged) {
+            vrGuiText.Clear();
+            vrGuiText.AddLine(vrGuiTitle, M_PI, VR_GUI_TITLE_PHI, VR_GUI_DISTANCE, VR_GUI_TITLE_EM,
+                              VR_GUI_TITLE_MAX_WIDTH);
+            vrGuiTitleChanged = false;
         }
     }
+    return vrGuiText.Update();
+}
 
-    // add quads per stack / slice
-    for (int j = 0; j < n_stacks; j++) {
-        auto j0 = j * (n_slices + 1);
-        auto j1 = (j + 1) * (n_slices + 1);
-        for (int i = 0; i < n_slices; i++) {
-            auto i0 = j0 + i;
-            auto i1 = j0 + (i + 1);
-            auto i2 = j1 + (i + 1);
-            auto i3 = j1 + i;
-            // top- or bottom-layer are just triangles
-            if (j == 0) {
-                meshBuilder.add_triangle(i0, i2, i3);
-            } else if (j == (n_stacks - 1)) {
-                meshBuilder.add_triangle(i0, i2, i1);
-            } else {
-                // otherwise, quads
-                meshBuilder.add_quad(i0, i1, i2, i3);
-            }
-        }
+/**
+ * Renders the panel and the text into the layer, if anything changed since it was last rendered.
+ */
+void Renderer::UpdateVRGuiLayer() {
+    const bool panelChanged = vrGuiPanel.Update(vrGuiButtons.data(), vrGuiButtons.size());
+    const bool textChanged = UpdateVRGuiText();
+    if (!panelChanged && !textChanged && vrGuiLayer.IsValid()) {
+        return;
     }
 
-    return meshBuilder.build();
+    vrGuiLayer.BeginRender();
+    GLState &glState = GetGLState();
+    glState.SetEnabled(GL_DEPTH_TEST, false);
+    glState.SetEnabled(GL_CULL_FACE, true);
+    glState.SetEnabled(GL_SCISSOR_TEST, false);
+    glState.SetEnabled(GL_STENCIL_TEST, false);
+    // blended over the transparent layer, the colors end up premultiplied by the coverage
+    glState.SetEnabled(GL_BLEND, true);
+    glState.BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
+                              GL_ONE_MINUS_SRC_ALPHA);
+    glBindBufferBase(GL_UNIFORM_BUFFER, EYE_PARAMS_BINDING, vrGuiLayerParamsBuffer);
+    glState.ActiveTexture(GL_TEXTURE0);
+
+    const EyePrograms &programs = eyePrograms[static_cast<int>(ViewMode::SINGLE)];
+    glState.UseProgram(programs.programVRGui);
+    glState.BindTexture(GL_TEXTURE_2D, buttonTexture);
+    vrGuiPanel.Render();
+
+    glState.UseProgram(programs.programVRText);
+    glState.BindTexture(GL_TEXTURE_2D, guiAtlasTexture);
+    vrGuiText.Render();
+    CHECK_GL_ERROR("Render GUI layer");
 }
 
-static TexturedMesh
-BuildCylindricalMesh(int n_slices, float minTheta, float maxTheta, float uvLeft, float uvTop,
-                     float uvRight, float uvBottom) {
-    TexturedMesh::Builder meshBuilder;
+void Renderer::ShowProgressBar() {
+    LOG_DEBUG("ShowProgressBar");
+    vrProgressBarShown = true;
+    vrGuiProgressBarHideAt = time(nullptr) + PROGRESS_BAR_SHOW_TIME;
+    frameScheduler.Invalidate();
+}
 
-    float uvWidth = uvRight - uvLeft;
-    float thetaRange = maxTheta - minTheta;
+static void
+BuildEquirectMesh(int n_slices, int n_stacks, float minTheta, float maxTheta, float uvLeft,
+                  float uvTop, float uvRight, float uvBottom, TexturedMesh &mesh,
+                  ProceduralMesh &proceduralMesh) {
+    if (USE_PROCEDURAL_MESHES) {
+        proceduralMesh = ProceduralMesh::UvSphere(n_slices, n_stacks, minTheta, maxTheta, uvLeft,
+                                                  uvTop, uvRight, uvBottom);
+    } else {
+        mesh = BuildUvSphereMesh(n_slices, n_stacks, minTheta, maxTheta, uvLeft, uvTop, uvRight,
+                                 uvBottom);
+    }
+}
 
-    for (int i = 0; i <= n_slices; i++) {
-        auto uFrac = float(i) / float(n_slices);
-        auto theta = -(minTheta + thetaRange * uFrac);
-        auto u = uFrac * uvWidth + uvLeft;
-        auto x = std::sinf(theta);
-        auto z = std::cosf(theta);
+/**
+ * The part of the video frame showing the view for the eye.
+ */
+static glm::vec4 LayoutUVRect(InputVideoLayout layout, int eye) {
+    switch (layout) {
+        case InputVideoLayout::MONO:
+        case InputVideoLayout::ANAGLYPH_RED_CYAN:
+        case InputVideoLayout::ANAGLYPH_RED_CYAN_HALF_COLOR:
+        case InputVideoLayout::ANAGLYPH_GREEN_MAGENTA:
+        case InputVideoLayout::ANAGLYPH_AMBER_BLUE:
+            return FULL_UV_RECT;
 
-        auto i1 = meshBuilder.add_vertex(x, 1, z, u, uvTop);
-        auto i2 = meshBuilder.add_vertex(x, -1, z, u, uvBottom);
-        if (i > 0) {
-            meshBuilder.add_quad(i1 - 2, i1, i2, i2 - 2);
-        }
-    }
+        case InputVideoLayout::STEREO_HORIZ:
+            return {0.5f * static_cast<float>(eye), 0.0f, 0.5f * static_cast<float>(eye + 1), 1.0f};
 
-    return meshBuilder.build();
+        case InputVideoLayout::STEREO_VERT:
+            return {0.0f, 0.5f * static_cast<float>(eye), 1.0f, 0.5f * static_cast<float>(eye + 1)};
+
+        default:
+            assert(false);
+            return FULL_UV_RECT;
+    }
 }
 
 void Renderer::ComputeMesh() {
+    // Both eyes share one mesh spanning the whole texture, each eye's part of the frame is then
+    // selected by its UV rect. Only stereo custom meshes differ per eye.
     for (int eye = 0; eye < 2; ++eye) {
-        float uvLeft, uvTop, uvRight, uvBottom;
-        switch (inputVideoLayout) {
-            case InputVideoLayout::MONO:
-            case InputVideoLayout::ANAGLYPH_RED_CYAN:
-                uvLeft = 0.0f;
-                uvRight = 1.0f;
-                uvTop = 0.0f;
-                uvBottom = 1.0f;
-                break;
-
-            case InputVideoLayout::STEREO_HORIZ:
-                uvLeft = 0.5f * static_cast<float>(eye);
-                uvRight = 0.5f * static_cast<float>(eye + 1);
-                uvTop = 0.0f;
-                uvBottom = 1.0f;
-                break;
-
-            case InputVideoLayout::STEREO_VERT:
-                uvLeft = 0.0f;
-                uvRight = 1.0f;
-                uvTop = 0.5f * static_cast<float>(eye);
-                uvBottom = 0.5f * static_cast<float>(eye + 1);
-                break;
-
-            default:
-                assert(false);
+        eyeMeshes[eye] = TexturedMesh();
+        eyeMeshUVRects[eye] = LayoutUVRect(inputVideoLayout, eye);
+        eyeProceduralMeshes[eye] = ProceduralMesh();
+    }
+    eyeMeshesShared = true;
+
+    const float uvLeft = FULL_UV_RECT.x;
+    const float uvTop = FULL_UV_RECT.y;
+    const float uvRight = FULL_UV_RECT.z;
+    const float uvBottom = FULL_UV_RECT.w;
+    TexturedMesh &mesh = eyeMeshes[0];
+    ProceduralMesh &proceduralMesh = eyeProceduralMeshes[0];
+
+    switch (inputVideoMode) {
+        case InputVideoMode::PLAIN_FOV: {
+            // plain rectangle
+            const float xScale = videoAspect > 1.0f ? 1.0f : (1.0f / videoAspect);
+            const float yScale = videoAspect > 1.0f ? (1.0f / videoAspect) : 1.0f;
+
+            std::unique_ptr<GLfloat[]> pos{new GLfloat[12]{
+                    -xScale, +yScale, PLAIN_FOV_Z,
+                    +xScale, +yScale, PLAIN_FOV_Z,
+                    +xScale, -yScale, PLAIN_FOV_Z,
+                    -xScale, -yScale, PLAIN_FOV_Z
+            }};
+            std::unique_ptr<GLfloat[]> uv{new GLfloat[8]{
+                    uvLeft, uvTop,
+                    uvRight, uvTop,
+                    uvRight, uvBottom,
+                    uvLeft, uvBottom
+            }};
+            std::unique_ptr<GLushort[]> indices{new GLushort[6]{
+                    0, 2, 1,
+                    0, 3, 2
+            }};
+
+            mesh =
+                    TexturedMesh(
+                            GL_TRIANGLES,
+                            6,
+                            std::move(pos),
+                            std::move(uv),
+                            std::move(indices)
+                    );
+
+            break;
         }
 
-        switch (inputVideoMode) {
-            case InputVideoMode::PLAIN_FOV: {
-                // plain rectangle
-                const float xScale = videoAspect > 1.0f ? 1.0f : (1.0f / videoAspect);
-                const float yScale = videoAspect > 1.0f ? (1.0f / videoAspect) : 1.0f;
-
-                std::unique_ptr<GLfloat[]> pos{new GLfloat[12]{
-                        -xScale, +yScale, PLAIN_FOV_Z,
-                        +xScale, +yScale, PLAIN_FOV_Z,
-                        +xScale, -yScale, PLAIN_FOV_Z,
-                        -xScale, -yScale, PLAIN_FOV_Z
-                }};
-                std::unique_ptr<GLfloat[]> uv{new GLfloat[8]{
-                        uvLeft, uvTop,
-                        uvRight, uvTop,
-                        uvRight, uvBottom,
-                        uvLeft, uvBottom
-                }};
-                std::unique_ptr<GLushort[]> indices{new GLushort[6]{
-                        0, 2, 1,
-                        0, 3, 2
-                }};
-
-                eyeMeshes[eye] =
-                        TexturedMesh(
-                                GL_TRIANGLES,
-                                6,
-                                std::move(pos),
-                                std::move(uv),
-                                std::move(indices)
-                        );
-
-                break;
+        case InputVideoMode::EQUIRECT_180:
+            BuildEquirectMesh(20, 20, M_PI_2, M_PI * 1.5f, uvLeft, uvTop, uvRight, uvBottom,
+                              mesh, proceduralMesh);
+            break;
+
+        case InputVideoMode::EQUIRECT_360:
+            BuildEquirectMesh(40, 20, 0, M_PI * 2.0f, uvLeft, uvTop, uvRight, uvBottom,
+                              mesh, proceduralMesh);
+            break;
+
+        case InputVideoMode::PANORAMA_180:
+            if (USE_PROCEDURAL_MESHES) {
+                proceduralMesh = ProceduralMesh::Cylinder(20, M_PI_2, M_PI * 1.5f,
+                                                          uvLeft, uvTop, uvRight, uvBottom);
+            } else {
+                const CylindricalProjection projection{float(M_PI_2), float(M_PI) * 1.5f};
+                mesh = BuildProjectionMesh(projection, 20, 1, FULL_UV_RECT);
+            }
+            break;
+
+        case InputVideoMode::PANORAMA_360:
+            if (USE_PROCEDURAL_MESHES) {
+                proceduralMesh = ProceduralMesh::Cylinder(40, 0, M_PI * 2.0f,
+                                                          uvLeft, uvTop, uvRight, uvBottom);
+            } else {
+                const CylindricalProjection projection{0.0f, float(M_PI) * 2.0f};
+                mesh = BuildProjectionMesh(projection, 40, 1, FULL_UV_RECT);
             }
+            break;
 
-            case InputVideoMode::EQUIRECT_180:
-                eyeMeshes[eye] = BuildUvSphereMesh(20, 20, M_PI_2, M_PI * 1.5f, uvLeft, uvTop,
-                                                   uvRight, uvBottom);
-                break;
-
-            case InputVideoMode::EQUIRECT_360:
-                eyeMeshes[eye] = BuildUvSphereMesh(40, 20, 0, M_PI * 2.0f, uvLeft, uvTop,
-                                                   uvRight, uvBottom);
-                break;
-
-            case InputVideoMode::PANORAMA_180:
-                eyeMeshes[eye] = BuildCylindricalMesh(20, M_PI_2, M_PI * 1.5f, uvLeft, uvTop,
-                                                      uvRight, uvBottom);
-                break;
-
-            case InputVideoMode::PANORAMA_360:
-                eyeMeshes[eye] = BuildCylindricalMesh(40, 0, M_PI * 2.0f, uvLeft, uvTop, uvRight,
-                                                      uvBottom);
-                break;
-
-            default:
-                std::unique_ptr<GLfloat[]> pos{new GLfloat[]{
-                        -1.0, -1.0, -1.0,
-                        +1.0, -1.0, -1.0,
-                        +1.0, +1.0, -1.0,
-                        -1.0, +1.0, -1.0,
-                        -1.0, -1.0, +1.0,
-                        +1.0, -1.0, +1.0,
-                        +1.0, +1.0, +1.0,
-                        -1.0, +1.0, +1.0
-                }};
-                std::unique_ptr<GLfloat[]> uv{new GLfloat[]{
-                        0.0f, 0.0f,
-                        1.0f, 0.0f,
-                        1.0f, 1.0f,
-                        0.0f, 1.0f,
-                        0.0f, 0.0f,
-                        1.0f, 0.0f,
-                        1.0f, 1.0f,
-                        0.0f, 1.0f,
-                }};
-                std::unique_ptr<GLushort[]> indices{new GLushort[]{
-                        0, 5, 4, 0, 1, 5,
-                        1, 6, 5, 1, 2, 6,
-                        2, 7, 6, 2, 3, 7,
-                        3, 4, 7, 3, 0, 4,
-                        4, 6, 7, 4, 5, 6,
-                        3, 1, 0, 3, 2, 1,
-                }};
-
-                eyeMeshes[eye] =
-                        TexturedMesh(
-                                GL_TRIANGLES,
-                                36,
-                                std::move(pos),
-                                std::move(uv),
-                                std::move(indices)
-                        );
-                break;
+        case InputVideoMode::CUBE_MAP:
+            // flat cube faces interpolate the texture exactly
+            mesh = BuildProjectionMesh(CubemapProjection{}, 1, 1, FULL_UV_RECT);
+            break;
+
+        case InputVideoMode::EQUIANG_CUBE_MAP:
+            mesh = BuildProjectionMesh(EacProjection{}, 8, 8, FULL_UV_RECT);
+            break;
+
+        case InputVideoMode::FISHEYE_180:
+            mesh = BuildProjectionMesh(FisheyeProjection{float(M_PI)}, 32, 16, FULL_UV_RECT);
+            break;
+
+        case InputVideoMode::CUSTOM_MESH: {
+            const std::vector<TexturedMesh> &customMeshes =
+                    videoMeshes.empty() ? screenMeshes : videoMeshes;
+            if (customMeshes.size() >= 2) {
+                // stereo projection mesh, one per eye, addressing its own part of the frame
+                for (int eye = 0; eye < 2; ++eye) {
+                    eyeMeshes[eye] = customMeshes[eye];
+                    eyeMeshUVRects[eye] = FULL_UV_RECT;
+                }
+                eyeMeshesShared = false;
+            } else if (!customMeshes.empty()) {
+                mesh = customMeshes[0];
+            } else {
+                LOG_ERROR("No custom mesh loaded");
+            }
+            break;
         }
+
+        default:
+            std::unique_ptr<GLfloat[]> pos{new GLfloat[]{
+                    -1.0, -1.0, -1.0,
+                    +1.0, -1.0, -1.0,
+                    +1.0, +1.0, -1.0,
+                    -1.0, +1.0, -1.0,
+                    -1.0, -1.0, +1.0,
+                    +1.0, -1.0, +1.0,
+                    +1.0, +1.0, +1.0,
+                    -1.0, +1.0, +1.0
+            }};
+            std::unique_ptr<GLfloat[]> uv{new GLfloat[]{
+                    0.0f, 0.0f,
+                    1.0f, 0.0f,
+                    1.0f, 1.0f,
+                    0.0f, 1.0f,
+                    0.0f, 0.0f,
+                    1.0f, 0.0f,
+                    1.0f, 1.0f,
+                    0.0f, 1.0f,
+            }};
+            std::unique_ptr<GLushort[]> indices{new GLushort[]{
+                    0, 5, 4, 0, 1, 5,
+                    1, 6, 5, 1, 2, 6,
+                    2, 7, 6, 2, 3, 7,
+                    3, 4, 7, 3, 0, 4,
+                    4, 6, 7, 4, 5, 6,
+                    3, 1, 0, 3, 2, 1,
+            }};
+
+            mesh =
+                    TexturedMesh(
+                            GL_TRIANGLES,
+                            36,
+                            std::move(pos),
+                            std::move(uv),
+                            std::move(indices)
+                    );
+            break;
+    }
+
+    if (eyeMeshesShared) {
+        // TexturedMesh copies share the vertex data
+        eyeMeshes[1] = eyeMeshes[0];
+        eyeProceduralMeshes[1] = eyeProceduralMeshes[0];
     }
+    meshGridChanged = true;
+}
+
+/**
+ * Samples the head pose again for the distortion pass, predicted for the same display time but
+ * from newer sensor data; returns the rotation of view directions at that pose into the pose the
+ * eye buffers were rendered with.
+ */
+glm::mat3 Renderer::LatchReprojection() {
+    glm::quat headOrientationQuat;
+    glm::vec3 headPosition;
+    CardboardHeadTracker_getPose(
+            cardboardHeadTracker.get(),
+            static_cast<int64_t>(frameDisplayTimeNanos),
+            kLandscapeLeft,
+            glm::value_ptr(headPosition),
+            glm::value_ptr(headOrientationQuat)
+    );
+    return glm::mat3(viewMatrix) * glm::transpose(glm::toMat3(headOrientationQuat));
 }
 
 void Renderer::UpdatePose(JNIEnv *env) {
+    if (!UsesHeadTracking()) {
+        // without the tracker, the VR GUI cannot be operated either
+        viewMatrix = glm::mat4(1.0f);
+        vrGuiShown = false;
+        isHeadGesturingUp = false;
+        return;
+    }
+
     glm::quat headOrientationQuat;
     glm::vec3 headPosition;
     CardboardHeadTracker_getPose(
             cardboardHeadTracker.get(),
-            static_cast<int64_t>(GetBootTimeNano() + kPredictionTimeWithoutVsyncNanos),
+            static_cast<int64_t>(frameDisplayTimeNanos),
             kLandscapeLeft,
             glm::value_ptr(headPosition),
             glm::value_ptr(headOrientationQuat)
@@ -903,6 +2162,98 @@ void Renderer::OnVideoSizeChanged(int width, int height) {
     videoHeight = height;
     videoAspect = (float) videoWidth / (float) videoHeight;
     screenParamsChanged = true;
+    frameScheduler.Invalidate();
+}
+
+/**
+ * Loads the meshes from the cache file, or imports them and writes the cache for the next time.
+ * A source without any mesh is cached too, so it is not searched again.
+ */
+template<typename Importer>
+static bool LoadCachedMeshes(const std::string &cachePath, Importer importer,
+                             std::vector<TexturedMesh> &meshes) {
+    if (LoadMeshCache(cachePath, meshes)) {
+        return !meshes.empty();
+    }
+
+    std::vector<TexturedMesh::Builder> builders;
+    if (!importer(builders)) {
+        builders.clear();
+    }
+    if (WriteMeshCache(cachePath, builders) && LoadMeshCache(cachePath, meshes)) {
+        return !meshes.empty();
+    }
+
+    // cache not writable, use the imported meshes directly
+    meshes.clear();
+    for (TexturedMesh::Builder &builder: builders) {
+        meshes.push_back(builder.build());
+    }
+    return !meshes.empty();
+}
+
+bool Renderer::LoadVideoMesh(int videoFd, const std::string &cachePath) {
+    LOG_DEBUG("LoadVideoMesh(%s)", cachePath.c_str());
+    auto importer = [videoFd](std::vector<TexturedMesh::Builder> &meshes) {
+        return ImportSv3dMeshes(videoFd, meshes);
+    };
+    std::vector<TexturedMesh> meshes;
+    bool loaded = LoadCachedMeshes(cachePath, importer, meshes);
+
+    std::lock_guard<std::mutex> lock(loadedMeshesMutex);
+    loadedVideoMeshes = std::move(meshes);
+    videoMeshesLoaded = true;
+    frameScheduler.Invalidate();
+    return loaded;
+}
+
+bool Renderer::LoadScreenMesh(const std::string &objPath, const std::string &cachePath) {
+    LOG_DEBUG("LoadScreenMesh(%s)", objPath.c_str());
+    auto importer = [&objPath](std::vector<TexturedMesh::Builder> &meshes) {
+        meshes.emplace_back();
+        return ImportObjMesh(objPath, meshes.back());
+    };
+    std::vector<TexturedMesh> meshes;
+    bool loaded = LoadCachedMeshes(cachePath, importer, meshes);
+
+    std::lock_guard<std::mutex> lock(loadedMeshesMutex);
+    loadedScreenMeshes = std::move(meshes);
+    screenMeshesLoaded = true;
+    frameScheduler.Invalidate();
+    return loaded;
+}
+
+/**
+ * Takes over the meshes loaded since the last frame. A projection mesh embedded in the video says
+ * how to show it, so the video is switched to it.
+ */
+void Renderer::UpdateLoadedMeshes() {
+    bool videoMeshArrived = false;
+    {
+        std::lock_guard<std::mutex> lock(loadedMeshesMutex);
+        if (!videoMeshesLoaded && !screenMeshesLoaded) {
+            return;
+        }
+        if (videoMeshesLoaded) {
+            videoMeshes = std::move(loadedVideoMeshes);
+            loadedVideoMeshes.clear();
+            videoMeshesLoaded = false;
+            videoMeshArrived = !videoMeshes.empty();
+        }
+        if (screenMeshesLoaded) {
+            screenMeshes = std::move(loadedScreenMeshes);
+            loadedScreenMeshes.clear();
+            screenMeshesLoaded = false;
+        }
+    }
+    if (videoMeshArrived && inputVideoMode != InputVideoMode::CUSTOM_MESH) {
+        inputVideoMode = InputVideoMode::CUSTOM_MESH;
+        // the eye buffers are sized for the new mode in the next frame
+        screenParamsChanged = true;
+        frameScheduler.Invalidate();
+        UpdateHeadTracker();
+    }
+    meshChanged |= inputVideoMode == InputVideoMode::CUSTOM_MESH;
 }
 
 void Renderer::ExecuteButtonAction(const ButtonAction action, JNIEnv *env) {
@@ -2,18 +2,41 @@
 #define VRVIDEOPLAYER_RENDERER_H
 
 #include <array>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include <EGL/egl.h>
 #include <GLES/gl.h>
 
 #include <cardboard.h>
 
+#include "glm/vec4.hpp"
+#include "glm/mat3x3.hpp"
 #include "glm/mat4x4.hpp"
 
 #include "TexturedMesh.h"
+#include "ProceduralMesh.h"
 #include "GLUtils.h"
 #include "VRGuiButton.h"
+#include "VRGuiLayer.h"
+#include "VRGuiPanel.h"
+#include "VRGuiText.h"
 #include "JavaInterface.h"
+#include "LensMask.h"
+#include "GpuFrameTimer.h"
+#include "DynamicResolution.h"
+#include "Foveation.h"
+#include "MultiResolution.h"
+#include "DistortionRenderer.h"
+#include "Compositor.h"
+#include "DisplayTiming.h"
+#include "FrameScheduler.h"
+#include "UniformBufferRing.h"
+#include "ProgramCache.h"
+#include "ToneMap.h"
+#include "Anaglyph.h"
+#include "VideoMipmap.h"
 
 /**
  * Is the input video monoscopic or stereoscopic, and if stereoscopic, how are the views stored?
@@ -22,7 +45,11 @@ enum class InputVideoLayout {
     MONO = 1,
     STEREO_HORIZ = 2,
     STEREO_VERT = 3,
+    // both views in one frame, to be seen through glasses of the colours, see AnaglyphMethod
     ANAGLYPH_RED_CYAN = 4,
+    ANAGLYPH_RED_CYAN_HALF_COLOR = 5,
+    ANAGLYPH_GREEN_MAGENTA = 6,
+    ANAGLYPH_AMBER_BLUE = 7,
 };
 
 /**
@@ -37,6 +64,8 @@ enum class InputVideoMode {
     PYRAMID = 6,
     PANORAMA_180 = 7,
     PANORAMA_360 = 8,
+    CUSTOM_MESH = 9,
+    FISHEYE_180 = 10,
 };
 
 /**
@@ -52,6 +81,66 @@ inline bool isOutputModeMono(const OutputMode mode) {
     return mode == OutputMode::MONO_LEFT || mode == OutputMode::MONO_RIGHT;
 }
 
+/**
+ * How the eye buffer passes address the views; the values index Renderer::eyePrograms.
+ */
+enum class ViewMode {
+    // one eye per pass
+    SINGLE = 0,
+    // both eyes at once into the layers of the eye texture array (OVR_multiview2)
+    MULTIVIEW = 1,
+    // both eyes at once side by side, as two instances of every draw
+    INSTANCED = 2,
+};
+
+/**
+ * Specializations of the video programs by what they do with the sampled colour, so the common
+ * case does no more than sample; the values index the video programs of EyePrograms.
+ */
+enum class VideoVariant {
+    // the texels as they are
+    PLAIN = 0,
+    // decoded into the view of the eye by its Anaglyph LUT
+    ANAGLYPH = 1,
+    // HDR video sampled at full precision, then mapped to the display by the ToneMap LUT
+    TONE_MAP = 2,
+};
+
+constexpr int VIDEO_VARIANT_COUNT = 3;
+
+/**
+ * Where the video programs sample the frame; the values index the video programs of EyePrograms.
+ */
+enum class VideoSource {
+    // the external texture of the decoder
+    EXTERNAL = 0,
+    // the copy of VideoMipmap, for video much denser than the eye buffers
+    MIPMAP = 1,
+};
+
+constexpr int VIDEO_SOURCE_COUNT = 2;
+
+struct VideoProgram {
+    GLuint program;
+    GLint paramPosition;
+    GLint paramUV;
+};
+
+/**
+ * The programs rendering into the eye buffers, with their attribute locations. The per-view
+ * parameters come from the EyeParams uniform block.
+ */
+struct EyePrograms {
+    std::array<std::array<VideoProgram, VIDEO_VARIANT_COUNT>, VIDEO_SOURCE_COUNT> video;
+    std::array<std::array<GLuint, VIDEO_VARIANT_COUNT>, VIDEO_SOURCE_COUNT> videoProcedural;
+    // with the attribute locations of VRGuiBatch
+    GLuint programVRGui;
+    // the same for the distance fields of the GUI atlas
+    GLuint programVRText;
+    GLuint program2D;
+    GLint program2DParamPosition;
+};
+
 class Renderer {
 public:
     Renderer(JavaVM *vm, jobject javaContextObj, jobject javaAssetMgrObj,
@@ -64,13 +153,41 @@ public:
     void SetOptions(InputVideoLayout requestedInputLayout, InputVideoMode requestedInputMode,
                     OutputMode requestedOutputMode);
 
+    void SetEyeBufferQuality(float quality);
+
     void ScanCardboardQr();
 
     void ShowProgressBar();
 
+    /**
+     * Sets the line shown above the VR GUI buttons, e.g. the name of the video.
+     */
+    void SetVRGuiTitle(const std::string &title);
+
+    /**
+     * Sets the transfer function of the video from its metadata; HDR video is tone mapped.
+     */
+    void SetVideoTransfer(VideoTransfer transfer);
+
     void SetScreenParams(int width, int height);
 
-    void DrawFrame(float videoPosition, JNIEnv *env);
+    /**
+     * Hands the window over to the asynchronous timewarp compositor, while the frames are rendered
+     * into an offscreen surface; null takes it back. Takes over the window reference.
+     */
+    void SetCompositorWindow(ANativeWindow *window);
+
+    void DrawFrame(float videoPosition, bool newVideoFrame, JNIEnv *env);
+
+    /**
+     * Called on every vsync on the UI thread; returns whether a frame should be drawn for it.
+     */
+    bool NeedsRedraw();
+
+    /**
+     * The display timing learned so far, for the frame timing metrics; callable on any thread.
+     */
+    FrameTimingModel GetFrameTiming();
 
     void OnPause();
 
@@ -78,12 +195,22 @@ public:
 
     void OnVideoSizeChanged(int width, int height);
 
+    /**
+     * Loads the projection meshes embedded in the video, on any thread; the GL thread takes them
+     * over for the next frame.
+     */
+    bool LoadVideoMesh(int videoFd, const std::string &cachePath);
+
+    /**
+     * Loads the user's screen mesh, on any thread like LoadVideoMesh.
+     */
+    bool LoadScreenMesh(const std::string &objPath, const std::string &cachePath);
+
 private:
     JavaInterface javaInterface;
 
     CardboardHeadTrackerPointer cardboardHeadTracker;
     CardboardLensDistortionPointer cardboardLensDistortion;
-    CardboardDistortionRendererPointer cardboardDistortionRenderer;
 
     bool screenParamsChanged;
     bool deviceParamsChanged;
@@ -98,31 +225,101 @@ private:
     InputVideoLayout inputVideoLayout;
     InputVideoMode inputVideoMode;
     OutputMode outputMode;
+    VideoVariant videoVariant;
+    ToneMap toneMap;
+    Anaglyph anaglyph;
+    VideoMipmap videoMipmap;
+    // video texels per eye buffer pixel at the view center
+    float videoMinification;
 
     unsigned long frameCount;
-    GLuint programVideo;
-    GLint programVideoParamPosition;
-    GLint programVideoParamUV;
-    GLint programVideoParamMVPMatrix;
-    GLint programVideoParamColorMapMatrix;
-    GLuint programVRGui;
-    GLint programVRGuiParamPosition;
-    GLint programVRGuiParamUV;
-    GLint programVRGuiParamMVPMatrix;
-    GLuint program2D;
-    GLint program2DParamPosition;
+    DisplayTiming displayTiming;
+    // when the frame being drawn is predicted to be displayed, on the head tracker clock
+    uint64_t frameDisplayTimeNanos;
+    FrameScheduler frameScheduler;
+    bool activityResumed;
+    // the GL thread switches the mode too, when a projection mesh arrives
+    std::mutex headTrackerMutex;
+    bool headTrackerRunning;
+    ProgramCache programCache;
+    // programs for every ViewMode, the multiview ones only if supported
+    std::array<EyePrograms, 3> eyePrograms;
+    // per-view placement of instanced stereo views
+    GLuint viewParamsBuffer;
+    // clip transforms of the multi-resolution regions, each at an aligned offset after an
+    // identity one
+    GLuint regionParamsBuffer;
+    GLint regionParamsStride;
+    // the matrices and UV rects of the eyes, written once per frame
+    UniformBufferRing eyeParamsRing;
+    GLintptr eyeParamsRightOffset;
 
     GLuint videoTexture;
     GLuint renderTexture;
     GLuint buttonTexture;
+    GLuint guiAtlasTexture;
 
     GLuint framebuffer;
+    // with multiview, the eyes are rendered into the layers of a texture array instead
+    bool useEyeTextureArray;
+    GLuint eyeTextureArray;
+    GLuint eyeDepthStencilArray;
+    GLuint multiviewFramebuffer;
+    std::array<GLuint, 2> layerFramebuffers;
+    DistortionRenderer distortionRenderer;
+    Compositor compositor;
+    ANativeWindow *compositorWindow;
+    // compositor threads that stopped on an error for the window so far
+    int compositorFailures;
+    GLuint stencilRenderbuffer;
 
     std::array<glm::mat4, 2> cardboardEyeMatrices;
     std::array<glm::mat4, 2> cardboardProjectionMatrices;
     std::array<CardboardEyeTextureDescription, 2> cardboardEyeTextureDescriptions;
+    std::array<LensMask, 2> lensMasks;
+    bool lensMaskChanged;
+    // resolution multiplier over the size the lens and the video can resolve
+    float eyeBufferQuality;
+    int eyeBufferWidth;
+    int eyeBufferHeight;
+    // 10 bits per channel for HDR video, so the tone mapped gradients do not band
+    GLenum eyeBufferFormat;
+    GpuFrameTimer gpuFrameTimer;
+    DynamicResolution dynamicResolution;
+    Foveation foveation;
+    // used without foveation
+    MultiResolution multiResolution;
 
     std::array<TexturedMesh, 2> eyeMeshes;
+    std::array<glm::vec4, 2> eyeMeshUVRects;
+    // both eyes use the same mesh, so they can be rendered in a single multiview pass
+    bool eyeMeshesShared;
+    // the eye meshes and the custom meshes below belong to the GL thread, the options set from
+    // other threads only request a new mesh
+    bool meshChanged;
+    // projection meshes embedded in the video, used in preference to the screen mesh
+    std::vector<TexturedMesh> videoMeshes;
+    std::vector<TexturedMesh> screenMeshes;
+    // set by the mesh loading thread
+    std::mutex loadedMeshesMutex;
+    std::vector<TexturedMesh> loadedVideoMeshes;
+    std::vector<TexturedMesh> loadedScreenMeshes;
+    bool videoMeshesLoaded;
+    bool screenMeshesLoaded;
+    std::array<ProceduralMesh, 2> eyeProceduralMeshes;
+    std::array<GLuint, 2> meshGridBuffers;
+    bool meshGridChanged;
+    GLuint emptyVertexArray;
+    VRGuiPanel vrGuiPanel;
+    VRGuiText vrGuiText;
+    // the panel and the text, rendered only when they change
+    VRGuiLayer vrGuiLayer;
+    // the eye parameters of the pass rendering the layer
+    GLuint vrGuiLayerParamsBuffer;
+    // set by the UI thread
+    std::mutex vrGuiTitleMutex;
+    std::string vrGuiTitle;
+    bool vrGuiTitleChanged;
 
     glm::mat4 viewMatrix;
     float yaw;
@@ -133,29 +330,66 @@ private:
     bool isHeadGesturingUp = false;
     float vrGuiCenterTheta = 0.0f;
 
+    bool UsesHeadTracking() const;
+
+    void UpdateHeadTracker();
+
+    void UpdateVideoVariant();
+
     bool UpdateDeviceParams();
 
+    void UpdateEyeBufferSize();
+
     void GlSetup();
 
+    void GlSetupEyeTexture();
+
+    void GlSetupEyeTextureArray();
+
     void GlTeardown();
 
+    void UpdateEyeTextureDescriptions(GLsizei eyeWidth, GLsizei eyeHeight);
+
     void ComputeMesh();
 
+    void UpdateLoadedMeshes();
+
+    void UpdateCompositor(JNIEnv *env);
+
     void UpdatePose(JNIEnv *env);
 
-    void RenderPointer();
+    glm::mat3 LatchReprojection();
+
+    void UpdateRegionParams(const std::array<MultiResolution::Region,
+            MultiResolution::REGION_COUNT> &regions, int regionCount);
+
+    void BindRegionParams(int index);
+
+    void RenderLensMasks(const std::array<MultiResolution::Region,
+            MultiResolution::REGION_COUNT> &regions, int regionCount);
+
+    void UpdateEyeParams();
 
-    void RenderCardboardAlignLine();
+    void UpdateViewParams(GLsizei eyeWidth);
+
+    void RenderEyeViews(ViewMode mode, int firstEye);
+
+    void RenderPointer(GLint programParamPosition, GLsizei instanceCount);
+
+    void RenderCardboardAlignLine(GLint programParamPosition);
 
     void ExecuteButtonAction(const ButtonAction action, JNIEnv *env);
 
     void InitVideoTexture(JNIEnv *env, GLuint &textureId);
 
-    void InitStaticTexture(JNIEnv *env, GLuint &textureId, const std::string &path);
+    void
+    InitStaticTexture(JNIEnv *env, GLuint &textureId, const std::string &path, bool mipmapped);
 
-    glm::mat4 BuildMVPMatrix(int eye);
+    bool UpdateVRGuiText();
+
+    void UpdateVRGuiLayer();
 
-    glm::mat4 BuildColorMapMatrix(int eye);
+    glm::mat4 BuildMVPMatrix(int eye);
 };
 
 #endif //VRVIDEOPLAYER_RENDERER_H
@@ -0,0 +1,10 @@
+#include "SphereMesh.h"
+
+#include "ProjectionMesh.h"
+
+TexturedMesh
+BuildUvSphereMesh(int n_slices, int n_stacks, float minTheta, float maxTheta, float uvLeft,
+                  float uvTop, float uvRight, float uvBottom) {
+    return BuildProjectionMesh(EquirectProjection{minTheta, maxTheta}, n_slices, n_stacks,
+                               {uvLeft, uvTop, uvRight, uvBottom});
+}
@@ -0,0 +1,15 @@
+#ifndef VR_VIDEO_PLAYER_SPHEREMESH_H
+#define VR_VIDEO_PLAYER_SPHEREMESH_H
+
+#include <GLES2/gl2.h>
+
+#include "TexturedMesh.h"
+
+/**
+ * A latitude/longitude grid for equirectangular video, its edges follow the texture axes.
+ */
+TexturedMesh
+BuildUvSphereMesh(int n_slices, int n_stacks, float minTheta, float maxTheta, float uvLeft,
+                  float uvTop, float uvRight, float uvBottom);
+
+#endif //VR_VIDEO_PLAYER_SPHEREMESH_H
@@ -1,10 +1,14 @@
 #include "TexturedMesh.h"
 
 #include <cassert>
+#include <cstring>
 
+#include <limits>
 #include <utility>
 
-#include <GLES2/gl2.h>
+#include <GLES3/gl3.h>
+
+#include "GLState.h"
 
 TexturedMesh::TexturedMesh() :
         vertexCount(0),
@@ -21,23 +25,38 @@ TexturedMesh::TexturedMesh(GLenum mode,
                            std::unique_ptr<GLushort[]> vertexIndex) :
         mode(mode),
         vertexCount(vertexCount),
+        vertexPos(vertexPos.release(), std::default_delete<GLfloat[]>()),
+        vertexUV(vertexUV.release(), std::default_delete<GLfloat[]>()),
+        vertexIndex(vertexIndex.release(), std::default_delete<GLushort[]>()) {
+}
+
+TexturedMesh::TexturedMesh(GLenum mode,
+                           GLsizei vertexCount,
+                           std::shared_ptr<const GLfloat> vertexPos,
+                           std::shared_ptr<const GLfloat> vertexUV,
+                           std::shared_ptr<const GLushort> vertexIndex) :
+        mode(mode),
+        vertexCount(vertexCount),
         vertexPos(std::move(vertexPos)),
         vertexUV(std::move(vertexUV)),
         vertexIndex(std::move(vertexIndex)) {
 }
 
-void TexturedMesh::Render(GLint programParamPosition, GLint programParamUV) const {
+void TexturedMesh::Render(GLint programParamPosition, GLint programParamUV,
+                          GLsizei instanceCount) const {
     if (vertexCount == 0) {
         // uninitialized/empty mesh
         return;
     }
 
-    glEnableVertexAttribArray(programParamPosition);
+    GLState &glState = GetGLState();
+    glState.EnableVertexAttribArray(programParamPosition);
     glVertexAttribPointer(programParamPosition, 3, GL_FLOAT, GL_FALSE, 0, vertexPos.get());
-    glEnableVertexAttribArray(programParamUV);
+    glState.EnableVertexAttribArray(programParamUV);
     glVertexAttribPointer(programParamUV, 2, GL_FLOAT, GL_FALSE, 0, vertexUV.get());
 
-    glDrawElements(mode, vertexCount, GL_UNSIGNED_SHORT, vertexIndex.get());
+    glDrawElementsInstanced(mode, vertexCount, GL_UNSIGNED_SHORT, vertexIndex.get(),
+                            instanceCount);
     //CHECK_GL_ERROR("Render");
 }
 
@@ -92,3 +111,15 @@ TexturedMesh TexturedMesh::Builder::build() {
             std::move(indPtr)
     };
 }
+
+const std::vector<GLfloat> &TexturedMesh::Builder::positions() const {
+    return vertexPos;
+}
+
+const std::vector<GLfloat> &TexturedMesh::Builder::uvs() const {
+    return vertexUV;
+}
+
+const std::vector<GLushort> &TexturedMesh::Builder::indices() const {
+    return vertexIndex;
+}
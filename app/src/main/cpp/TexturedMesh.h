@@ -16,7 +16,20 @@ public:
                  std::unique_ptr<GLfloat[]> vertexUV,
                  std::unique_ptr<GLushort[]> vertexIndex);
 
-    void Render(GLint programParamPosition, GLint programParamUV) const;
+    /**
+     * Mesh with shared vertex data, e.g. pointing into a memory-mapped file kept alive by the
+     * pointers' shared owner.
+     */
+    TexturedMesh(GLenum mode,
+                 GLsizei vertexCount,
+                 std::shared_ptr<const GLfloat> vertexPos,
+                 std::shared_ptr<const GLfloat> vertexUV,
+                 std::shared_ptr<const GLushort> vertexIndex);
+
+    /**
+     * Draws instanceCount instances of the mesh, see the instanced stereo eye programs.
+     */
+    void Render(GLint programParamPosition, GLint programParamUV, GLsizei instanceCount = 1) const;
 
     class Builder {
     public:
@@ -26,6 +39,10 @@ public:
 
         TexturedMesh build();
 
+        const std::vector<GLfloat> &positions() const;
+        const std::vector<GLfloat> &uvs() const;
+        const std::vector<GLushort> &indices() const;
+
     private:
         std::vector<GLfloat> vertexPos;
         std::vector<GLfloat> vertexUV;
@@ -35,9 +52,9 @@ public:
 private:
     GLenum mode;
     GLsizei vertexCount;
-    std::unique_ptr<GLfloat[]> vertexPos;
-    std::unique_ptr<GLfloat[]> vertexUV;
-    std::unique_ptr<GLushort[]> vertexIndex;
+    std::shared_ptr<const GLfloat> vertexPos;
+    std::shared_ptr<const GLfloat> vertexUV;
+    std::shared_ptr<const GLushort> vertexIndex;
 };
 
 #endif //VR_VIDEO_PLAYER_TEXTUREDMESH_H
@@ -0,0 +1,157 @@
+#include "ToneMap.h"
+
+#include <cmath>
+#include <cstdint>
+
+#include <algorithm>
+#include <vector>
+
+#include "glm/vec3.hpp"
+#include "glm/common.hpp"
+#include "glm/exponential.hpp"
+
+#include "GLState.h"
+#include "GLUtils.h"
+#include "logger.h"
+
+#define LOG_TAG "VRVideoPlayerT"
+
+// BT.2408 HDR reference white, shown as the SDR white
+static constexpr float REFERENCE_WHITE_NITS = 203.0f;
+// the display luminance HLG is rendered for, BT.2100
+static constexpr float HLG_PEAK_NITS = 1000.0f;
+static constexpr float HLG_SYSTEM_GAMMA = 1.2f;
+// above this fraction of the SDR white, highlights roll off towards it
+static constexpr float ROLL_OFF_KNEE = 0.75f;
+static constexpr float DISPLAY_GAMMA = 2.2f;
+
+/**
+ * The ST 2084 EOTF, to nits.
+ */
+static float PqToNits(float encoded) {
+    constexpr float m1 = 0.1593017578125f;
+    constexpr float m2 = 78.84375f;
+    constexpr float c1 = 0.8359375f;
+    constexpr float c2 = 18.8515625f;
+    constexpr float c3 = 18.6875f;
+    const float p = std::pow(encoded, 1.0f / m2);
+    return 10000.0f * std::pow(std::max(p - c1, 0.0f) / (c2 - c3 * p), 1.0f / m1);
+}
+
+/**
+ * The inverse of the STD-B67 OETF, to scene light in [0, 1].
+ */
+static float HlgToScene(float encoded) {
+    constexpr float a = 0.17883277f;
+    constexpr float b = 0.28466892f;
+    constexpr float c = 0.55991073f;
+    return encoded <= 0.5f ? encoded * encoded / 3.0f : (std::exp((encoded - c) / a) + b) / 12.0f;
+}
+
+static glm::vec3 ToNits(VideoTransfer transfer, const glm::vec3 &encoded) {
+    if (transfer == VideoTransfer::PQ) {
+        return {PqToNits(encoded.r), PqToNits(encoded.g), PqToNits(encoded.b)};
+    }
+    const glm::vec3 scene(HlgToScene(encoded.r), HlgToScene(encoded.g), HlgToScene(encoded.b));
+    // the BT.2100 OOTF, by the BT.2020 luminance
+    const float luminance = 0.2627f * scene.r + 0.6780f * scene.g + 0.0593f * scene.b;
+    return HLG_PEAK_NITS * std::pow(luminance, HLG_SYSTEM_GAMMA - 1.0f) * scene;
+}
+
+static glm::vec3 Bt2020ToBt709(const glm::vec3 &c) {
+    return {
+            1.6605f * c.r - 0.5876f * c.g - 0.0728f * c.b,
+            -0.1246f * c.r + 1.1329f * c.g - 0.0083f * c.b,
+            -0.0182f * c.r - 0.1006f * c.g + 1.1187f * c.b
+    };
+}
+
+/**
+ * Linear up to the knee, then approaches 1 with the same slope there.
+ */
+static float RollOff(float value) {
+    if (value <= ROLL_OFF_KNEE) {
+        return value;
+    }
+    const float range = 1.0f - ROLL_OFF_KNEE;
+    return ROLL_OFF_KNEE + range * (1.0f - std::exp(-(value - ROLL_OFF_KNEE) / range));
+}
+
+/**
+ * The display colour of an encoded video colour, in [0, 1].
+ */
+static glm::vec3 MapColor(VideoTransfer transfer, const glm::vec3 &encoded) {
+    // the colours outside the BT.709 gamut are clipped
+    glm::vec3 color = glm::max(Bt2020ToBt709(ToNits(transfer, encoded)), 0.0f) /
+                      REFERENCE_WHITE_NITS;
+    // scaled by the brightest channel, so the highlights keep their hue
+    const float maxChannel = std::max(color.r, std::max(color.g, color.b));
+    if (maxChannel > ROLL_OFF_KNEE) {
+        color *= RollOff(maxChannel) / maxChannel;
+    }
+    return glm::pow(glm::clamp(color, 0.0f, 1.0f), glm::vec3(1.0f / DISPLAY_GAMMA));
+}
+
+static uint32_t Pack1010102(const glm::vec3 &color) {
+    const auto channel = [](float value) {
+        return static_cast<uint32_t>(std::lround(value * 1023.0f));
+    };
+    return channel(color.r) | channel(color.g) << 10 | channel(color.b) << 20 | 3u << 30;
+}
+
+ToneMap::ToneMap() :
+        transfer(VideoTransfer::SDR),
+        texture(0),
+        changed(false) {
+}
+
+void ToneMap::GlSetup() {
+    glGenTextures(1, &texture);
+    GetGLState().BindTexture(GL_TEXTURE_3D, texture);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    CHECK_GL_ERROR("Tone map setup");
+    changed = true;
+}
+
+void ToneMap::SetTransfer(VideoTransfer newTransfer) {
+    changed |= newTransfer != transfer;
+    transfer = newTransfer;
+}
+
+VideoTransfer ToneMap::GetTransfer() const {
+    return transfer;
+}
+
+void ToneMap::Update() {
+    if (!changed || transfer == VideoTransfer::SDR) {
+        return;
+    }
+    changed = false;
+
+    LOG_DEBUG("Building tone map for transfer %d", transfer);
+    // red along the rows, green along the columns, blue along the slices
+    std::vector<uint32_t> lut(LUT_SIZE * LUT_SIZE * LUT_SIZE);
+    const float step = 1.0f / float(LUT_SIZE - 1);
+    auto texel = lut.begin();
+    for (int b = 0; b < LUT_SIZE; ++b) {
+        for (int g = 0; g < LUT_SIZE; ++g) {
+            for (int r = 0; r < LUT_SIZE; ++r) {
+                const glm::vec3 encoded(float(r) * step, float(g) * step, float(b) * step);
+                *texel++ = Pack1010102(MapColor(transfer, encoded));
+            }
+        }
+    }
+
+    GetGLState().BindTexture(GL_TEXTURE_3D, texture);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB10_A2, LUT_SIZE, LUT_SIZE, LUT_SIZE, 0, GL_RGBA,
+                 GL_UNSIGNED_INT_2_10_10_10_REV, lut.data());
+    CHECK_GL_ERROR("Tone map upload");
+}
+
+GLuint ToneMap::GetTexture() const {
+    return texture;
+}
@@ -0,0 +1,52 @@
+#ifndef VR_VIDEO_PLAYER_TONEMAP_H
+#define VR_VIDEO_PLAYER_TONEMAP_H
+
+#include <GLES3/gl3.h>
+
+/**
+ * The transfer function the video is encoded with, from the stream metadata.
+ */
+enum class VideoTransfer {
+    SDR = 0,
+    // SMPTE ST 2084
+    PQ = 1,
+    // ARIB STD-B67
+    HLG = 2,
+};
+
+/**
+ * Tone mapping of HDR video into the SDR eye buffers, by a 3D LUT the tone mapping video programs
+ * sample right after the video texture. The LUT takes the BT.2020 colours the external sampler
+ * returns, still encoded by the transfer function, to BT.709 for a display gamma of 2.2; it is
+ * built on the CPU whenever the transfer changes.
+ */
+class ToneMap {
+public:
+    // texels along each axis, the input colours in between are interpolated
+    static constexpr int LUT_SIZE = 33;
+
+    ToneMap();
+
+    /**
+     * Creates the texture in a new context; the LUT is uploaded by the next Update.
+     */
+    void GlSetup();
+
+    void SetTransfer(VideoTransfer transfer);
+
+    VideoTransfer GetTransfer() const;
+
+    /**
+     * Builds and uploads the LUT of an HDR transfer, if it changed since the last call.
+     */
+    void Update();
+
+    GLuint GetTexture() const;
+
+private:
+    VideoTransfer transfer;
+    GLuint texture;
+    bool changed;
+};
+
+#endif //VR_VIDEO_PLAYER_TONEMAP_H
@@ -0,0 +1,65 @@
+#include "UniformBufferRing.h"
+
+#include <algorithm>
+
+#include "GLUtils.h"
+
+// a GPU this late is hung or lost its context, overwriting the slot cannot make it worse
+static constexpr GLuint64 FENCE_TIMEOUT_NANOS = 100'000'000;
+
+UniformBufferRing::UniformBufferRing() :
+        buffer(0),
+        slotSize(0),
+        fences{},
+        current(FRAMES_IN_FLIGHT - 1) {
+}
+
+void UniformBufferRing::GlSetup(GLsizeiptr frameSize) {
+    // called for a new context, the objects of the previous one are gone with it
+    fences = {};
+    current = FRAMES_IN_FLIGHT - 1;
+
+    GLint uniformBufferAlignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformBufferAlignment);
+    const GLsizeiptr alignment = std::max(uniformBufferAlignment, 1);
+    slotSize = (frameSize + alignment - 1) / alignment * alignment;
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferData(GL_UNIFORM_BUFFER, FRAMES_IN_FLIGHT * slotSize, nullptr, GL_DYNAMIC_DRAW);
+    CHECK_GL_ERROR("Uniform buffer ring setup");
+}
+
+void *UniformBufferRing::MapNextFrame() {
+    current = (current + 1) % FRAMES_IN_FLIGHT;
+    GLsync &fence = fences[current];
+    if (fence != nullptr) {
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NANOS);
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    // the fence has already ordered the write after the reads, the driver need not track them
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    void *slot = glMapBufferRange(
+            GL_UNIFORM_BUFFER, current * slotSize, slotSize,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    CHECK_GL_ERROR("Uniform buffer ring map");
+    return slot;
+}
+
+void UniformBufferRing::Unmap() {
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glUnmapBuffer(GL_UNIFORM_BUFFER);
+}
+
+void UniformBufferRing::BindRange(GLuint binding, GLintptr offset, GLsizeiptr size) const {
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, current * slotSize + offset, size);
+}
+
+void UniformBufferRing::EndFrame() {
+    GLsync &fence = fences[current];
+    if (fence == nullptr) {
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef VR_VIDEO_PLAYER_UNIFORMBUFFERRING_H
+#define VR_VIDEO_PLAYER_UNIFORMBUFFERRING_H
+
+#include <array>
+
+#include <GLES3/gl3.h>
+
+/**
+ * A uniform buffer written once per frame, into the next of a few slots: the slots of the frames
+ * the GPU may still be reading are left alone, so writing does not wait for them. A fence per slot
+ * covers the GPU falling behind by more frames than there are slots.
+ */
+class UniformBufferRing {
+public:
+    UniformBufferRing();
+
+    /**
+     * Creates the buffer for frames of up to frameSize bytes, in a new context.
+     */
+    void GlSetup(GLsizeiptr frameSize);
+
+    /**
+     * Maps the slot of the next frame for writing, nullptr if that failed.
+     */
+    void *MapNextFrame();
+
+    void Unmap();
+
+    /**
+     * Binds a range of the slot last mapped; offset must be a multiple of
+     * GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+     */
+    void BindRange(GLuint binding, GLintptr offset, GLsizeiptr size) const;
+
+    /**
+     * Called after the last draw reading the slot last mapped.
+     */
+    void EndFrame();
+
+private:
+    static constexpr int FRAMES_IN_FLIGHT = 3;
+
+    GLuint buffer;
+    GLsizeiptr slotSize;
+    std::array<GLsync, FRAMES_IN_FLIGHT> fences;
+    int current;
+};
+
+#endif //VR_VIDEO_PLAYER_UNIFORMBUFFERRING_H
@@ -0,0 +1,247 @@
+// Generated by tools/gui_atlas.py from Lato-Regular.ttf; do not edit.
+
+#include "VRGuiAtlas.h"
+
+const char *const VR_GUI_ATLAS_TEXTURE = "gui-atlas.png";
+
+const VRGuiAtlasMetrics VR_GUI_ATLAS_METRICS = {
+        512, 380, 4.0f,
+        0.987f, -0.213f, 1.2f
+};
+
+const VRGuiGlyph VR_GUI_ATLAS_GLYPHS[] = {
+        {0x0020, 0.193f, {0.0f, 0.0f, 0.0f, 0.0f}, {0, 0, 0, 0}},
+        {0x0021, 0.343f, {0.0f, -0.125f, 0.34375f, 0.8125f}, {0, 215, 11, 245}},
+        {0x0022, 0.397f, {-0.03125f, 0.34375f, 0.4375f, 0.8125f}, {470, 337, 485, 352}},
+        {0x0023, 0.58f, {-0.09375f, -0.09375f, 0.65625f, 0.8125f}, {130, 246, 154, 275}},
+        {0x0024, 0.58f, {-0.0625f, -0.21875f, 0.625f, 0.9375f}, {81, 55, 103, 92}},
+        {0x0025, 0.786f, {-0.0625f, -0.125f, 0.84375f, 0.84375f}, {380, 147, 409, 178}},
+        {0x0026, 0.703f, {-0.0625f, -0.125f, 0.8125f, 0.84375f}, {410, 147, 438, 178}},
+        {0x0027, 0.23f, {-0.03125f, 0.34375f, 0.25f, 0.8125f}, {486, 337, 495, 352}},
+        {0x0028, 0.3f, {-0.03125f, -0.25f, 0.375f, 0.875f}, {151, 55, 164, 91}},
+        {0x0029, 0.3f, {-0.0625f, -0.25f, 0.34375f, 0.875f}, {165, 55, 178, 91}},
+        {0x002a, 0.4f, {-0.0625f, 0.3125f, 0.46875f, 0.875f}, {350, 337, 367, 355}},
+        {0x002b, 0.58f, {-0.0625f, -0.03125f, 0.625f, 0.6875f}, {433, 307, 455, 330}},
+        {0x002c, 0.212f, {-0.0625f, -0.25f, 0.28125f, 0.21875f}, {496, 337, 507, 352}},
+        {0x002d, 0.347f, {-0.0625f, 0.15625f, 0.40625f, 0.4375f}, {236, 361, 251, 370}},
+        {0x002e, 0.212f, {-0.0625f, -0.125f, 0.28125f, 0.21875f}, {166, 361, 177, 372}},
+        {0x002f, 0.373f, {-0.125f, -0.15625f, 0.5f, 0.84375f}, {211, 147, 231, 179}},
+        {0x0030, 0.58f, {-0.09375f, -0.125f, 0.65625f, 0.84375f}, {439, 147, 463, 178}},
+        {0x0031, 0.58f, {0.0f, -0.09375f, 0.625f, 0.8125f}, {155, 246, 175, 275}},
+        {0x0032, 0.58f, {-0.0625f, -0.09375f, 0.625f, 0.84375f}, {12, 215, 34, 245}},
+        {0x0033, 0.58f, {-0.0625f, -0.125f, 0.65625f, 0.84375f}, {464, 147, 487, 178}},
+        {0x0034, 0.58f, {-0.09375f, -0.09375f, 0.65625f, 0.8125f}, {176, 246, 200, 275}},
+        {0x0035, 0.58f, {-0.0625f, -0.125f, 0.625f, 0.8125f}, {35, 215, 57, 245}},
+        {0x0036, 0.58f, {-0.0625f, -0.125f, 0.65625f, 0.8125f}, {58, 215, 81, 245}},
+        {0x0037, 0.58f, {-0.0625f, -0.09375f, 0.65625f, 0.8125f}, {201, 246, 224, 275}},
+        {0x0038, 0.58f, {-0.0625f, -0.125f, 0.625f, 0.84375f}, {488, 147, 510, 178}},
+        {0x0039, 0.58f, {-0.03125f, -0.09375f, 0.65625f, 0.84375f}, {82, 215, 104, 245}},
+        {0x003a, 0.252f, {-0.03125f, -0.125f, 0.3125f, 0.59375f}, {456, 307, 467, 330}},
+        {0x003b, 0.252f, {-0.03125f, -0.25f, 0.3125f, 0.59375f}, {214, 307, 225, 334}},
+        {0x003c, 0.58f, {-0.03125f, 0.0f, 0.5625f, 0.65625f}, {161, 337, 180, 358}},
+        {0x003d, 0.58f, {-0.03125f, 0.125f, 0.625f, 0.5625f}, {58, 361, 79, 375}},
+        {0x003e, 0.58f, {0.0f, 0.0f, 0.625f, 0.65625f}, {181, 337, 201, 358}},
+        {0x003f, 0.398f, {-0.09375f, -0.125f, 0.5f, 0.84375f}, {0, 183, 19, 214}},
+        {0x0040, 0.822f, {-0.0625f, -0.21875f, 0.90625f, 0.78125f}, {232, 147, 263, 179}},
+        {0x0041, 0.68f, {-0.09375f, -0.09375f, 0.78125f, 0.8125f}, {225, 246, 253, 275}},
+        {0x0042, 0.647f, {-0.03125f, -0.09375f, 0.6875f, 0.8125f}, {254, 246, 277, 275}},
+        {0x0043, 0.685f, {-0.0625f, -0.125f, 0.75f, 0.84375f}, {20, 183, 46, 214}},
+        {0x0044, 0.753f, {-0.03125f, -0.09375f, 0.8125f, 0.8125f}, {278, 246, 305, 275}},
+        {0x0045, 0.581f, {-0.03125f, -0.09375f, 0.625f, 0.8125f}, {306, 246, 327, 275}},
+        {0x0046, 0.566f, {-0.03125f, -0.09375f, 0.625f, 0.8125f}, {328, 246, 349, 275}},
+        {0x0047, 0.734f, {-0.0625f, -0.125f, 0.78125f, 0.84375f}, {47, 183, 74, 214}},
+        {0x0048, 0.756f, {-0.03125f, -0.09375f, 0.78125f, 0.8125f}, {350, 246, 376, 275}},
+        {0x0049, 0.307f, {0.0f, -0.09375f, 0.3125f, 0.8125f}, {377, 246, 387, 275}},
+        {0x004a, 0.444f, {-0.09375f, -0.125f, 0.46875f, 0.8125f}, {105, 215, 123, 245}},
+        {0x004b, 0.681f, {0.0f, -0.09375f, 0.78125f, 0.8125f}, {388, 246, 413, 275}},
+        {0x004c, 0.514f, {-0.03125f, -0.09375f, 0.59375f, 0.8125f}, {414, 246, 434, 275}},
+        {0x004d, 0.92f, {-0.03125f, -0.09375f, 0.9375f, 0.8125f}, {435, 246, 466, 275}},
+        {0x004e, 0.756f, {-0.03125f, -0.09375f, 0.78125f, 0.8125f}, {467, 246, 493, 275}},
+        {0x004f, 0.798f, {-0.0625f, -0.125f, 0.875f, 0.84375f}, {75, 183, 105, 214}},
+        {0x0050, 0.611f, {0.0f, -0.09375f, 0.6875f, 0.8125f}, {0, 277, 22, 306}},
+        {0x0051, 0.798f, {-0.0625f, -0.25f, 0.90625f, 0.84375f}, {223, 110, 254, 145}},
+        {0x0052, 0.644f, {0.0f, -0.09375f, 0.75f, 0.8125f}, {23, 277, 47, 306}},
+        {0x0053, 0.53f, {-0.09375f, -0.125f, 0.59375f, 0.84375f}, {106, 183, 128, 214}},
+        {0x0054, 0.59f, {-0.09375f, -0.09375f, 0.6875f, 0.8125f}, {48, 277, 73, 306}},
+        {0x0055, 0.73f, {-0.03125f, -0.125f, 0.75f, 0.8125f}, {124, 215, 149, 245}},
+        {0x0056, 0.68f, {-0.09375f, -0.09375f, 0.78125f, 0.8125f}, {74, 277, 102, 306}},
+        {0x0057, 1.019f, {-0.09375f, -0.09375f, 1.125f, 0.8125f}, {103, 277, 142, 306}},
+        {0x0058, 0.643f, {-0.09375f, -0.09375f, 0.75f, 0.8125f}, {143, 277, 170, 306}},
+        {0x0059, 0.629f, {-0.09375f, -0.09375f, 0.75f, 0.8125f}, {171, 277, 198, 306}},
+        {0x005a, 0.624f, {-0.0625f, -0.09375f, 0.6875f, 0.8125f}, {199, 277, 223, 306}},
+        {0x005b, 0.3f, {-0.03125f, -0.25f, 0.375f, 0.875f}, {179, 55, 192, 91}},
+        {0x005c, 0.375f, {-0.125f, -0.15625f, 0.5f, 0.84375f}, {264, 147, 284, 179}},
+        {0x005d, 0.3f, {-0.0625f, -0.25f, 0.34375f, 0.875f}, {193, 55, 206, 91}},
+        {0x005e, 0.58f, {-0.03125f, 0.28125f, 0.59375f, 0.8125f}, {386, 337, 406, 354}},
+        {0x005f, 0.394f, {-0.09375f, -0.25f, 0.5f, 0.03125f}, {252, 361, 271, 370}},
+        {0x0060, 0.307f, {-0.09375f, 0.46875f, 0.3125f, 0.84375f}, {138, 361, 151, 373}},
+        {0x0061, 0.507f, {-0.0625f, -0.125f, 0.5625f, 0.625f}, {273, 307, 293, 331}},
+        {0x0062, 0.559f, {-0.03125f, -0.125f, 0.625f, 0.84375f}, {129, 183, 150, 214}},
+        {0x0063, 0.467f, {-0.0625f, -0.125f, 0.5625f, 0.625f}, {294, 307, 314, 331}},
+        {0x0064, 0.559f, {-0.0625f, -0.125f, 0.59375f, 0.84375f}, {151, 183, 172, 214}},
+        {0x0065, 0.524f, {-0.0625f, -0.125f, 0.59375f, 0.625f}, {315, 307, 336, 331}},
+        {0x0066, 0.337f, {-0.09375f, -0.09375f, 0.4375f, 0.84375f}, {150, 215, 167, 245}},
+        {0x0067, 0.511f, {-0.09375f, -0.28125f, 0.59375f, 0.625f}, {224, 277, 246, 306}},
+        {0x0068, 0.556f, {-0.03125f, -0.09375f, 0.59375f, 0.84375f}, {168, 215, 188, 245}},
+        {0x0069, 0.256f, {-0.03125f, -0.09375f, 0.3125f, 0.84375f}, {189, 215, 200, 245}},
+        {0x006a, 0.254f, {-0.125f, -0.28125f, 0.3125f, 0.84375f}, {207, 55, 221, 91}},
+        {0x006b, 0.524f, {-0.03125f, -0.09375f, 0.625f, 0.84375f}, {201, 215, 222, 245}},
+        {0x006c, 0.256f, {-0.03125f, -0.09375f, 0.28125f, 0.84375f}, {223, 215, 233, 245}},
+        {0x006d, 0.821f, {-0.03125f, -0.09375f, 0.875f, 0.625f}, {468, 307, 497, 330}},
+        {0x006e, 0.556f, {-0.03125f, -0.09375f, 0.59375f, 0.625f}, {0, 337, 20, 360}},
+        {0x006f, 0.556f, {-0.0625f, -0.125f, 0.625f, 0.625f}, {337, 307, 359, 331}},
+        {0x0070, 0.552f, {-0.03125f, -0.28125f, 0.625f, 0.625f}, {247, 277, 268, 306}},
+        {0x0071, 0.559f, {-0.0625f, -0.28125f, 0.59375f, 0.625f}, {269, 277, 290, 306}},
+        {0x0072, 0.403f, {-0.03125f, -0.09375f, 0.5f, 0.625f}, {21, 337, 38, 360}},
+        {0x0073, 0.434f, {-0.09375f, -0.125f, 0.5f, 0.625f}, {360, 307, 379, 331}},
+        {0x0074, 0.373f, {-0.09375f, -0.125f, 0.46875f, 0.78125f}, {291, 277, 309, 306}},
+        {0x0075, 0.556f, {-0.0625f, -0.125f, 0.59375f, 0.625f}, {380, 307, 401, 331}},
+        {0x0076, 0.512f, {-0.09375f, -0.09375f, 0.625f, 0.625f}, {39, 337, 62, 360}},
+        {0x0077, 0.766f, {-0.09375f, -0.09375f, 0.875f, 0.625f}, {63, 337, 94, 360}},
+        {0x0078, 0.504f, {-0.09375f, -0.09375f, 0.59375f, 0.625f}, {95, 337, 117, 360}},
+        {0x0079, 0.512f, {-0.09375f, -0.28125f, 0.625f, 0.625f}, {310, 277, 333, 306}},
+        {0x007a, 0.462f, {-0.0625f, -0.09375f, 0.53125f, 0.625f}, {118, 337, 137, 360}},
+        {0x007b, 0.3f, {-0.09375f, -0.25f, 0.375f, 0.875f}, {222, 55, 237, 91}},
+        {0x007c, 0.3f, {0.0f, -0.28125f, 0.28125f, 0.875f}, {104, 55, 113, 92}},
+        {0x007d, 0.3f, {-0.0625f, -0.25f, 0.375f, 0.875f}, {238, 55, 252, 91}},
+        {0x007e, 0.58f, {-0.0625f, 0.09375f, 0.625f, 0.5f}, {80, 361, 102, 374}},
+        {0x00a0, 0.193f, {0.0f, 0.0f, 0.0f, 0.0f}, {0, 0, 0, 0}},
+        {0x00a1, 0.343f, {0.0f, -0.28125f, 0.34375f, 0.625f}, {334, 277, 345, 306}},
+        {0x00a2, 0.58f, {-0.03125f, -0.21875f, 0.625f, 0.75f}, {173, 183, 194, 214}},
+        {0x00a3, 0.58f, {-0.09375f, -0.09375f, 0.65625f, 0.84375f}, {234, 215, 258, 245}},
+        {0x00a4, 0.58f, {-0.03125f, 0.0f, 0.625f, 0.65625f}, {202, 337, 223, 358}},
+        {0x00a5, 0.58f, {-0.09375f, -0.09375f, 0.65625f, 0.8125f}, {346, 277, 370, 306}},
+        {0x00a6, 0.3f, {0.0f, -0.28125f, 0.28125f, 0.875f}, {114, 55, 123, 92}},
+        {0x00a7, 0.503f, {-0.0625f, -0.15625f, 0.5625f, 0.84375f}, {285, 147, 305, 179}},
+        {0x00a8, 0.307f, {-0.09375f, 0.46875f, 0.40625f, 0.8125f}, {178, 361, 194, 372}},
+        {0x00a9, 0.798f, {-0.0625f, -0.125f, 0.875f, 0.84375f}, {195, 183, 225, 214}},
+        {0x00aa, 0.342f, {-0.0625f, 0.3125f, 0.40625f, 0.84375f}, {407, 337, 422, 354}},
+        {0x00ab, 0.463f, {-0.03125f, -0.03125f, 0.5f, 0.5625f}, {246, 337, 263, 356}},
+        {0x00ac, 0.58f, {-0.03125f, 0.0625f, 0.625f, 0.46875f}, {103, 361, 124, 374}},
+        {0x00ad, 0.347f, {-0.0625f, 0.15625f, 0.40625f, 0.4375f}, {272, 361, 287, 370}},
+        {0x00ae, 0.798f, {-0.0625f, -0.125f, 0.875f, 0.84375f}, {226, 183, 256, 214}},
+        {0x00af, 0.307f, {-0.09375f, 0.5f, 0.40625f, 0.78125f}, {288, 361, 304, 370}},
+        {0x00b0, 0.397f, {-0.0625f, 0.28125f, 0.46875f, 0.84375f}, {368, 337, 385, 355}},
+        {0x00b1, 0.58f, {-0.0625f, -0.0625f, 0.625f, 0.71875f}, {250, 307, 272, 332}},
+        {0x00b2, 0.332f, {-0.0625f, 0.34375f, 0.40625f, 0.9375f}, {264, 337, 279, 356}},
+        {0x00b3, 0.332f, {-0.0625f, 0.34375f, 0.40625f, 0.9375f}, {280, 337, 295, 356}},
+        {0x00b4, 0.307f, {0.0f, 0.46875f, 0.40625f, 0.84375f}, {152, 361, 165, 373}},
+        {0x00b5, 0.556f, {-0.0625f, -0.28125f, 0.59375f, 0.625f}, {371, 277, 392, 306}},
+        {0x00b6, 0.669f, {-0.09375f, -0.21875f, 0.75f, 0.8125f}, {183, 147, 210, 180}},
+        {0x00b7, 0.273f, {-0.0625f, 0.125f, 0.3125f, 0.46875f}, {195, 361, 207, 372}},
+        {0x00b8, 0.307f, {-0.03125f, -0.28125f, 0.34375f, 0.125f}, {125, 361, 137, 374}},
+        {0x00b9, 0.332f, {-0.0625f, 0.34375f, 0.40625f, 0.9375f}, {296, 337, 311, 356}},
+        {0x00ba, 0.381f, {-0.0625f, 0.3125f, 0.46875f, 0.84375f}, {423, 337, 440, 354}},
+        {0x00bb, 0.463f, {-0.03125f, -0.03125f, 0.5f, 0.5625f}, {312, 337, 329, 356}},
+        {0x00bc, 0.712f, {-0.0625f, -0.09375f, 0.8125f, 0.8125f}, {393, 277, 421, 306}},
+        {0x00bd, 0.712f, {-0.0625f, -0.09375f, 0.78125f, 0.8125f}, {422, 277, 449, 306}},
+        {0x00be, 0.713f, {-0.0625f, -0.09375f, 0.8125f, 0.84375f}, {259, 215, 287, 245}},
+        {0x00bf, 0.398f, {-0.09375f, -0.28125f, 0.5f, 0.625f}, {450, 277, 469, 306}},
+        {0x00c0, 0.68f, {-0.09375f, -0.09375f, 0.78125f, 1.0f}, {255, 110, 283, 145}},
+        {0x00c1, 0.68f, {-0.09375f, -0.09375f, 0.78125f, 1.0f}, {284, 110, 312, 145}},
+        {0x00c2, 0.68f, {-0.09375f, -0.09375f, 0.78125f, 1.0f}, {313, 110, 341, 145}},
+        {0x00c3, 0.68f, {-0.09375f, -0.09375f, 0.78125f, 0.96875f}, {127, 147, 155, 181}},
+        {0x00c4, 0.68f, {-0.09375f, -0.09375f, 0.78125f, 1.0f}, {342, 110, 370, 145}},
+        {0x00c5, 0.68f, {-0.09375f, -0.09375f, 0.78125f, 1.03125f}, {253, 55, 281, 91}},
+        {0x00c6, 0.929f, {-0.125f, -0.09375f, 1.0f, 0.8125f}, {470, 277, 506, 306}},
+        {0x00c7, 0.685f, {-0.0625f, -0.28125f, 0.75f, 0.84375f}, {282, 55, 308, 91}},
+        {0x00c8, 0.581f, {-0.03125f, -0.09375f, 0.625f, 1.0f}, {371, 110, 392, 145}},
+        {0x00c9, 0.581f, {-0.03125f, -0.09375f, 0.625f, 1.0f}, {393, 110, 414, 145}},
+        {0x00ca, 0.581f, {-0.03125f, -0.09375f, 0.625f, 1.0f}, {415, 110, 436, 145}},
+        {0x00cb, 0.581f, {-0.03125f, -0.09375f, 0.625f, 1.0f}, {437, 110, 458, 145}},
+        {0x00cc, 0.307f, {-0.125f, -0.09375f, 0.34375f, 1.0f}, {459, 110, 474, 145}},
+        {0x00cd, 0.307f, {-0.03125f, -0.09375f, 0.4375f, 1.0f}, {475, 110, 490, 145}},
+        {0x00ce, 0.307f, {-0.125f, -0.09375f, 0.4375f, 1.0f}, {491, 110, 509, 145}},
+        {0x00cf, 0.307f, {-0.125f, -0.09375f, 0.4375f, 1.0f}, {0, 147, 18, 182}},
+        {0x00d0, 0.789f, {-0.09375f, -0.09375f, 0.84375f, 0.8125f}, {0, 307, 30, 336}},
+        {0x00d1, 0.756f, {-0.03125f, -0.09375f, 0.78125f, 0.96875f}, {156, 147, 182, 181}},
+        {0x00d2, 0.798f, {-0.0625f, -0.125f, 0.875f, 1.0f}, {309, 55, 339, 91}},
+        {0x00d3, 0.798f, {-0.0625f, -0.125f, 0.875f, 1.0f}, {340, 55, 370, 91}},
+        {0x00d4, 0.798f, {-0.0625f, -0.125f, 0.875f, 1.0f}, {371, 55, 401, 91}},
+        {0x00d5, 0.798f, {-0.0625f, -0.125f, 0.875f, 0.96875f}, {19, 147, 49, 182}},
+        {0x00d6, 0.798f, {-0.0625f, -0.125f, 0.875f, 1.0f}, {402, 55, 432, 91}},
+        {0x00d7, 0.58f, {-0.03125f, 0.0f, 0.625f, 0.65625f}, {224, 337, 245, 358}},
+        {0x00d8, 0.798f, {-0.0625f, -0.15625f, 0.875f, 0.84375f}, {306, 147, 336, 179}},
+        {0x00d9, 0.73f, {-0.03125f, -0.125f, 0.75f, 1.0f}, {433, 55, 458, 91}},
+        {0x00da, 0.73f, {-0.03125f, -0.125f, 0.75f, 1.0f}, {459, 55, 484, 91}},
+        {0x00db, 0.73f, {-0.03125f, -0.125f, 0.75f, 1.0f}, {485, 55, 510, 91}},
+        {0x00dc, 0.73f, {-0.03125f, -0.125f, 0.75f, 1.0f}, {0, 110, 25, 146}},
+        {0x00dd, 0.629f, {-0.09375f, -0.09375f, 0.75f, 1.0f}, {50, 147, 77, 182}},
+        {0x00de, 0.611f, {0.0f, -0.09375f, 0.6875f, 0.8125f}, {31, 307, 53, 336}},
+        {0x00df, 0.609f, {-0.03125f, -0.125f, 0.6875f, 0.84375f}, {257, 183, 280, 214}},
+        {0x00e0, 0.507f, {-0.0625f, -0.125f, 0.5625f, 0.84375f}, {281, 183, 301, 214}},
+        {0x00e1, 0.507f, {-0.0625f, -0.125f, 0.5625f, 0.84375f}, {302, 183, 322, 214}},
+        {0x00e2, 0.507f, {-0.0625f, -0.125f, 0.5625f, 0.8125f}, {288, 215, 308, 245}},
+        {0x00e3, 0.507f, {-0.0625f, -0.125f, 0.5625f, 0.8125f}, {309, 215, 329, 245}},
+        {0x00e4, 0.507f, {-0.0625f, -0.125f, 0.5625f, 0.8125f}, {330, 215, 350, 245}},
+        {0x00e5, 0.507f, {-0.0625f, -0.125f, 0.5625f, 0.875f}, {337, 147, 357, 179}},
+        {0x00e6, 0.816f, {-0.0625f, -0.125f, 0.875f, 0.625f}, {402, 307, 432, 331}},
+        {0x00e7, 0.467f, {-0.0625f, -0.28125f, 0.5625f, 0.625f}, {54, 307, 74, 336}},
+        {0x00e8, 0.524f, {-0.0625f, -0.125f, 0.59375f, 0.84375f}, {323, 183, 344, 214}},
+        {0x00e9, 0.524f, {-0.0625f, -0.125f, 0.59375f, 0.84375f}, {345, 183, 366, 214}},
+        {0x00ea, 0.524f, {-0.0625f, -0.125f, 0.59375f, 0.8125f}, {351, 215, 372, 245}},
+        {0x00eb, 0.524f, {-0.0625f, -0.125f, 0.59375f, 0.8125f}, {373, 215, 394, 245}},
+        {0x00ec, 0.256f, {-0.125f, -0.09375f, 0.3125f, 0.84375f}, {395, 215, 409, 245}},
+        {0x00ed, 0.256f, {-0.03125f, -0.09375f, 0.375f, 0.84375f}, {410, 215, 423, 245}},
+        {0x00ee, 0.256f, {-0.125f, -0.09375f, 0.40625f, 0.8125f}, {75, 307, 92, 336}},
+        {0x00ef, 0.256f, {-0.125f, -0.09375f, 0.375f, 0.8125f}, {93, 307, 109, 336}},
+        {0x00f0, 0.553f, {-0.0625f, -0.125f, 0.625f, 0.8125f}, {424, 215, 446, 245}},
+        {0x00f1, 0.556f, {-0.03125f, -0.09375f, 0.59375f, 0.8125f}, {110, 307, 130, 336}},
+        {0x00f2, 0.556f, {-0.0625f, -0.125f, 0.625f, 0.84375f}, {367, 183, 389, 214}},
+        {0x00f3, 0.556f, {-0.0625f, -0.125f, 0.625f, 0.84375f}, {390, 183, 412, 214}},
+        {0x00f4, 0.556f, {-0.0625f, -0.125f, 0.625f, 0.8125f}, {447, 215, 469, 245}},
+        {0x00f5, 0.556f, {-0.0625f, -0.125f, 0.625f, 0.8125f}, {470, 215, 492, 245}},
+        {0x00f6, 0.556f, {-0.0625f, -0.125f, 0.625f, 0.8125f}, {0, 246, 22, 276}},
+        {0x00f7, 0.58f, {-0.0625f, 0.0f, 0.625f, 0.6875f}, {138, 337, 160, 359}},
+        {0x00f8, 0.556f, {-0.0625f, -0.15625f, 0.65625f, 0.65625f}, {226, 307, 249, 333}},
+        {0x00f9, 0.556f, {-0.0625f, -0.125f, 0.59375f, 0.84375f}, {413, 183, 434, 214}},
+        {0x00fa, 0.556f, {-0.0625f, -0.125f, 0.59375f, 0.84375f}, {435, 183, 456, 214}},
+        {0x00fb, 0.556f, {-0.0625f, -0.125f, 0.59375f, 0.8125f}, {23, 246, 44, 276}},
+        {0x00fc, 0.556f, {-0.0625f, -0.125f, 0.59375f, 0.8125f}, {45, 246, 66, 276}},
+        {0x00fd, 0.512f, {-0.09375f, -0.28125f, 0.625f, 0.84375f}, {26, 110, 49, 146}},
+        {0x00fe, 0.552f, {-0.03125f, -0.28125f, 0.625f, 0.84375f}, {50, 110, 71, 146}},
+        {0x00ff, 0.512f, {-0.09375f, -0.28125f, 0.625f, 0.8125f}, {78, 147, 101, 182}},
+        {0x010c, 0.685f, {-0.0625f, -0.125f, 0.75f, 1.03125f}, {124, 55, 150, 92}},
+        {0x010d, 0.467f, {-0.0625f, -0.125f, 0.5625f, 0.8125f}, {67, 246, 87, 276}},
+        {0x010e, 0.753f, {-0.03125f, -0.09375f, 0.8125f, 1.03125f}, {72, 110, 99, 146}},
+        {0x010f, 0.677f, {-0.0625f, -0.125f, 0.75f, 0.84375f}, {457, 183, 483, 214}},
+        {0x011a, 0.581f, {-0.03125f, -0.09375f, 0.625f, 1.03125f}, {100, 110, 121, 146}},
+        {0x011b, 0.524f, {-0.0625f, -0.125f, 0.59375f, 0.8125f}, {88, 246, 109, 276}},
+        {0x0147, 0.756f, {-0.03125f, -0.09375f, 0.78125f, 1.03125f}, {122, 110, 148, 146}},
+        {0x0148, 0.556f, {-0.03125f, -0.09375f, 0.59375f, 0.8125f}, {131, 307, 151, 336}},
+        {0x0158, 0.644f, {0.0f, -0.09375f, 0.75f, 1.03125f}, {149, 110, 173, 146}},
+        {0x0159, 0.403f, {-0.03125f, -0.09375f, 0.5f, 0.8125f}, {152, 307, 169, 336}},
+        {0x0160, 0.53f, {-0.09375f, -0.125f, 0.59375f, 1.0f}, {174, 110, 196, 146}},
+        {0x0161, 0.434f, {-0.09375f, -0.125f, 0.5f, 0.8125f}, {110, 246, 129, 276}},
+        {0x0164, 0.59f, {-0.09375f, -0.09375f, 0.6875f, 1.03125f}, {197, 110, 222, 146}},
+        {0x0165, 0.491f, {-0.09375f, -0.125f, 0.625f, 0.78125f}, {170, 307, 193, 336}},
+        {0x016e, 0.73f, {-0.03125f, -0.125f, 0.75f, 1.0625f}, {55, 55, 80, 93}},
+        {0x016f, 0.556f, {-0.0625f, -0.125f, 0.59375f, 0.875f}, {358, 147, 379, 179}},
+        {0x017d, 0.624f, {-0.0625f, -0.09375f, 0.6875f, 1.0f}, {102, 147, 126, 182}},
+        {0x017e, 0.462f, {-0.0625f, -0.09375f, 0.53125f, 0.8125f}, {194, 307, 213, 336}},
+        {0x2013, 0.556f, {-0.03125f, 0.15625f, 0.59375f, 0.4375f}, {305, 361, 325, 370}},
+        {0x2014, 0.821f, {-0.03125f, 0.15625f, 0.84375f, 0.4375f}, {326, 361, 354, 370}},
+        {0x2018, 0.212f, {-0.09375f, 0.40625f, 0.25f, 0.875f}, {0, 361, 11, 376}},
+        {0x2019, 0.212f, {-0.0625f, 0.375f, 0.28125f, 0.875f}, {441, 337, 452, 353}},
+        {0x201a, 0.212f, {-0.0625f, -0.25f, 0.28125f, 0.21875f}, {12, 361, 23, 376}},
+        {0x201c, 0.364f, {-0.09375f, 0.40625f, 0.40625f, 0.875f}, {24, 361, 40, 376}},
+        {0x201d, 0.364f, {-0.0625f, 0.375f, 0.4375f, 0.875f}, {453, 337, 469, 353}},
+        {0x201e, 0.364f, {-0.0625f, -0.25f, 0.4375f, 0.21875f}, {41, 361, 57, 376}},
+        {0x2022, 0.58f, {0.0f, 0.0f, 0.59375f, 0.59375f}, {330, 337, 349, 356}},
+        {0x2026, 0.727f, {-0.0625f, -0.125f, 0.78125f, 0.21875f}, {208, 361, 235, 372}},
+        {0x20ac, 0.58f, {-0.09375f, -0.125f, 0.6875f, 0.84375f}, {484, 183, 509, 214}},
+        {0x2212, 0.58f, {-0.03125f, 0.1875f, 0.625f, 0.46875f}, {355, 361, 376, 370}},
+        {0xe000, 1.0f, {-0.0625f, -0.2025f, 1.0625f, 0.9225f}, {0, 0, 54, 54}},
+        {0xe001, 1.0f, {-0.0625f, -0.2025f, 1.0625f, 0.9225f}, {55, 0, 109, 54}},
+        {0xe002, 1.0f, {-0.0625f, -0.2025f, 1.0625f, 0.9225f}, {110, 0, 164, 54}},
+        {0xe003, 1.0f, {-0.0625f, -0.2025f, 1.0625f, 0.9225f}, {165, 0, 219, 54}},
+        {0xe004, 1.0f, {-0.0625f, -0.2025f, 1.0625f, 0.9225f}, {220, 0, 274, 54}},
+        {0xe005, 1.0f, {-0.0625f, -0.2025f, 1.0625f, 0.9225f}, {275, 0, 329, 54}},
+        {0xe006, 1.0f, {-0.0625f, -0.2025f, 1.0625f, 0.9225f}, {330, 0, 384, 54}},
+        {0xe007, 1.0f, {-0.0625f, -0.2025f, 1.0625f, 0.9225f}, {385, 0, 439, 54}},
+        {0xe008, 1.0f, {-0.0625f, -0.2025f, 1.0625f, 0.9225f}, {440, 0, 494, 54}},
+        {0xe009, 1.0f, {-0.0625f, -0.2025f, 1.0625f, 0.9225f}, {0, 55, 54, 109}},
+};
+
+const std::size_t VR_GUI_ATLAS_GLYPH_COUNT =
+        sizeof(VR_GUI_ATLAS_GLYPHS) / sizeof(VR_GUI_ATLAS_GLYPHS[0]);
@@ -0,0 +1,42 @@
+#ifndef VR_VIDEO_PLAYER_VRGUIATLAS_H
+#define VR_VIDEO_PLAYER_VRGUIATLAS_H
+
+#include <cstddef>
+
+/*
+ * The atlas of the GUI text: multi-channel signed distance fields of the glyphs, which keep their
+ * edges sharp at any magnification, and distance fields of the button icons, in one texture.
+ * Both the texture asset and the tables in VRGuiAtlas.cpp are generated by tools/gui_atlas.py.
+ */
+
+// the icon cells of buttons-texture.png are at U+E000 + row * 4 + column
+static constexpr char32_t VR_GUI_ICON_FIRST_CODEPOINT = 0xe000;
+
+struct VRGuiGlyph {
+    char32_t codepoint;
+    // pen advance, in ems
+    float advance;
+    // left, bottom, right, top of the quad, relative to the pen on the baseline, in ems
+    float plane[4];
+    // left, top, right, bottom of the quad in the texture, in pixels from its top left corner
+    int atlas[4];
+};
+
+struct VRGuiAtlasMetrics {
+    int width;
+    int height;
+    // the distance range of the fields, in texture pixels
+    float pxRange;
+    // font metrics, in ems
+    float ascender;
+    float descender;
+    float lineHeight;
+};
+
+extern const char *const VR_GUI_ATLAS_TEXTURE;
+extern const VRGuiAtlasMetrics VR_GUI_ATLAS_METRICS;
+// sorted by code point
+extern const VRGuiGlyph VR_GUI_ATLAS_GLYPHS[];
+extern const std::size_t VR_GUI_ATLAS_GLYPH_COUNT;
+
+#endif //VR_VIDEO_PLAYER_VRGUIATLAS_H
@@ -0,0 +1,71 @@
+#include "VRGuiBatch.h"
+
+#include <cstddef>
+
+#include <array>
+
+#include "GLState.h"
+#include "GLUtils.h"
+
+// the corners of a quad, in its fan order, as two triangles
+static constexpr std::array<int, 6> QUAD_TRIANGLE_CORNERS = {0, 1, 2, 0, 2, 3};
+
+VRGuiBatch::VRGuiBatch() :
+        vertexBuffer(0),
+        vertexArray(0),
+        vertexCount(0) {
+}
+
+void VRGuiBatch::GlSetup() {
+    // called for a new context, the objects of the previous one are gone with it
+    vertexCount = 0;
+
+    glGenBuffers(1, &vertexBuffer);
+    glGenVertexArrays(1, &vertexArray);
+    GLState &glState = GetGLState();
+    glState.BindVertexArray(vertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glEnableVertexAttribArray(POSITION_LOCATION);
+    glVertexAttribPointer(POSITION_LOCATION, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          reinterpret_cast<const void *>(offsetof(Vertex, position)));
+    glEnableVertexAttribArray(UV_LOCATION);
+    glVertexAttribPointer(UV_LOCATION, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          reinterpret_cast<const void *>(offsetof(Vertex, uv)));
+    glEnableVertexAttribArray(HIGHLIGHT_LOCATION);
+    glVertexAttribPointer(HIGHLIGHT_LOCATION, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          reinterpret_cast<const void *>(offsetof(Vertex, highlight)));
+    glState.BindVertexArray(0);
+    // the other passes draw from client arrays
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    CHECK_GL_ERROR("GUI batch setup");
+}
+
+void VRGuiBatch::Upload(const std::vector<Vertex> &vertices) {
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(vertices.size() * sizeof(Vertex)), vertices.data(),
+                 GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    CHECK_GL_ERROR("GUI batch upload");
+    vertexCount = static_cast<GLsizei>(vertices.size());
+}
+
+void VRGuiBatch::Render(GLsizei instanceCount) const {
+    if (vertexCount == 0) {
+        return;
+    }
+
+    GLState &glState = GetGLState();
+    glState.BindVertexArray(vertexArray);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, instanceCount);
+    glState.BindVertexArray(0);
+}
+
+void VRGuiBatch::AddQuad(std::vector<Vertex> &vertices, const GLfloat *positions,
+                         const GLfloat *uvs, GLfloat highlight) {
+    for (int corner: QUAD_TRIANGLE_CORNERS) {
+        vertices.push_back({{positions[3 * corner], positions[3 * corner + 1],
+                             positions[3 * corner + 2]},
+                            {uvs[2 * corner], uvs[2 * corner + 1]},
+                            highlight});
+    }
+}
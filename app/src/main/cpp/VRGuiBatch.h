@@ -0,0 +1,50 @@
+#ifndef VR_VIDEO_PLAYER_VRGUIBATCH_H
+#define VR_VIDEO_PLAYER_VRGUIBATCH_H
+
+#include <vector>
+
+#include <GLES3/gl3.h>
+
+/**
+ * GUI quads in one vertex buffer, in the attribute layout the GUI programs declare, drawn by a
+ * single call.
+ */
+class VRGuiBatch {
+public:
+    // the attribute locations the GUI vertex shader declares
+    static constexpr GLuint POSITION_LOCATION = 0;
+    static constexpr GLuint UV_LOCATION = 1;
+    static constexpr GLuint HIGHLIGHT_LOCATION = 2;
+
+    struct Vertex {
+        GLfloat position[3];
+        GLfloat uv[2];
+        GLfloat highlight;
+    };
+
+    VRGuiBatch();
+
+    /**
+     * Creates the buffer in a new context; it is empty until the next Upload.
+     */
+    void GlSetup();
+
+    void Upload(const std::vector<Vertex> &vertices);
+
+    void Render(GLsizei instanceCount = 1) const;
+
+    /**
+     * Appends the two triangles of a quad given by its corners in fan order: top left, bottom
+     * left, bottom right, top right; three position and two UV coordinates each.
+     */
+    static void
+    AddQuad(std::vector<Vertex> &vertices, const GLfloat *positions, const GLfloat *uvs,
+            GLfloat highlight);
+
+private:
+    GLuint vertexBuffer;
+    GLuint vertexArray;
+    GLsizei vertexCount;
+};
+
+#endif //VR_VIDEO_PLAYER_VRGUIBATCH_H
@@ -3,23 +3,19 @@
 #include <cmath>
 #include <array>
 
-#include <GLES2/gl2.h>
+#include <GLES3/gl3.h>
 
 #include "logger.h"
+#include "Projection.h"
 
 #define LOG_TAG "VRVideoPlayerB"
 
 constexpr float BUTTON_TEXTURE_SIZE = 1024.0f;
 constexpr int ACTIVATION_DELAY = 2;
 
-constexpr std::array<GLubyte, 4> quadFanIndices = {0, 1, 2, 3};
-
 static std::array<GLfloat, 3> sphericalToCartesian(float theta, float phi, float r) {
-    return {
-            r * cosf(phi) * sinf(-theta),
-            r * sinf(phi),
-            r * cosf(phi) * cosf(-theta)
-    };
+    const glm::vec3 pos = r * DirectionFromAngles(theta, phi);
+    return {pos.x, pos.y, pos.z};
 }
 
 static std::array<GLfloat, 12>
@@ -68,18 +64,6 @@ VRGuiButton::VRGuiButton(float centerTheta, float centerPhi, float centerDistanc
           visible(visible) {
 }
 
-void VRGuiButton::render(GLint programParamPosition, GLint programParamUV) const {
-    if (!visible) return;
-
-    glEnableVertexAttribArray(programParamPosition);
-    glVertexAttribPointer(programParamPosition, 3, GL_FLOAT, GL_FALSE, 0, vertexPos.data());
-    glEnableVertexAttribArray(programParamUV);
-    glVertexAttribPointer(programParamUV, 2, GL_FLOAT, GL_FALSE, 0, vertexUV.data());
-
-    glDrawElements(GL_TRIANGLE_FAN, 4, GL_UNSIGNED_BYTE, quadFanIndices.data());
-    //CHECK_GL_ERROR("Render button");
-}
-
 ButtonAction VRGuiButton::evaluatePossibleHit(float viewTheta, float viewPhi) {
     if (!visible) return ButtonAction::NONE;
 
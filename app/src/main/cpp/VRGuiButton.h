@@ -30,12 +30,27 @@ public:
     VRGuiButton(float centerTheta, float centerPhi, float centerDistance, float sizeAlpha, int textureXPos,
                 int textureYPos, ButtonAction action, ButtonBehavior behavior, bool visible);
 
-    void render(GLint programParamPosition, GLint programParamUV) const;
-
     ButtonAction evaluatePossibleHit(float viewTheta, float viewPhi);
 
     void setVisible(bool newVisible);
 
+    bool isVisible() const {
+        return visible;
+    }
+
+    // looked at, waiting to trigger or to repeat
+    bool isHighlighted() const {
+        return visible && waitingForActivation;
+    }
+
+    const std::array<GLfloat, 12> &getVertexPos() const {
+        return vertexPos;
+    }
+
+    const std::array<GLfloat, 8> &getVertexUV() const {
+        return vertexUV;
+    }
+
 private:
     float centerTheta;
     float centerPhi;
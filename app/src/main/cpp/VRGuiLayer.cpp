@@ -0,0 +1,93 @@
+#include "VRGuiLayer.h"
+
+#include <cmath>
+
+#include <vector>
+
+#include "glm/ext/matrix_clip_space.hpp"
+
+#include "GLState.h"
+#include "GLUtils.h"
+
+VRGuiLayer::VRGuiLayer(float halfWidthAlpha, float bottomPhi, float topPhi, float distance,
+                       float pixelsPerRadian) :
+        left(-std::tan(halfWidthAlpha)),
+        right(std::tan(halfWidthAlpha)),
+        // off to the sides, the points of a latitude are further from the horizon on the plane
+        bottom(std::tan(bottomPhi) / (bottomPhi < 0.0f ? std::cos(halfWidthAlpha) : 1.0f)),
+        top(std::tan(topPhi) / (topPhi > 0.0f ? std::cos(halfWidthAlpha) : 1.0f)),
+        distance(distance),
+        // the plane is a radian per unit straight ahead
+        width(GLsizei(std::ceil((right - left) * pixelsPerRadian))),
+        height(GLsizei(std::ceil((top - bottom) * pixelsPerRadian))),
+        // nothing is depth tested, the planes just enclose the GUI
+        projection(glm::frustum(0.5f * distance * left, 0.5f * distance * right,
+                                0.5f * distance * bottom, 0.5f * distance * top,
+                                0.5f * distance, 2.0f * distance)),
+        texture(0),
+        framebuffer(0),
+        quad(),
+        valid(false) {
+}
+
+void VRGuiLayer::GlSetup() {
+    // called for a new context, the objects of the previous one are gone with it
+    valid = false;
+
+    glGenTextures(1, &texture);
+    GetGLState().BindTexture(GL_TEXTURE_2D, texture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, GL_NONE);
+    CHECK_GL_ERROR("GUI layer setup");
+
+    const GLfloat positions[] = {
+            left * distance, top * distance, -distance,
+            left * distance, bottom * distance, -distance,
+            right * distance, bottom * distance, -distance,
+            right * distance, top * distance, -distance
+    };
+    // the bottom row of the framebuffer comes first in the texture
+    const GLfloat uvs[] = {
+            0.0f, 1.0f,
+            0.0f, 0.0f,
+            1.0f, 0.0f,
+            1.0f, 1.0f
+    };
+    std::vector<VRGuiBatch::Vertex> vertices;
+    VRGuiBatch::AddQuad(vertices, positions, uvs, 0.0f);
+    quad.GlSetup();
+    quad.Upload(vertices);
+}
+
+bool VRGuiLayer::IsValid() const {
+    return valid;
+}
+
+const glm::mat4 &VRGuiLayer::GetProjection() const {
+    return projection;
+}
+
+void VRGuiLayer::BeginRender() {
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    GetGLState().Viewport(0, 0, width, height);
+    // leaves the clear color of the other passes alone
+    static constexpr GLfloat transparent[] = {0.0f, 0.0f, 0.0f, 0.0f};
+    glClearBufferfv(GL_COLOR, 0, transparent);
+    valid = true;
+}
+
+GLuint VRGuiLayer::GetTexture() const {
+    return texture;
+}
+
+void VRGuiLayer::Render(GLsizei instanceCount) const {
+    quad.Render(instanceCount);
+}
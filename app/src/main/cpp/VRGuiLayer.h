@@ -0,0 +1,70 @@
+#ifndef VR_VIDEO_PLAYER_VRGUILAYER_H
+#define VR_VIDEO_PLAYER_VRGUILAYER_H
+
+#include <GLES3/gl3.h>
+
+#include "glm/mat4x4.hpp"
+
+#include "VRGuiBatch.h"
+
+/**
+ * The GUI rendered into a texture once, then drawn into the eyes as a single quad. The texture is
+ * a view from the center of the GUI sphere, straight ahead (θ = π), covering a patch of the
+ * sphere; the quad spans the same view on a plane in front of it, so the texture maps onto it
+ * exactly. The texels are premultiplied by their alpha.
+ */
+class VRGuiLayer {
+public:
+    /**
+     * A layer reaching halfWidthAlpha to both sides and from bottomPhi to topPhi, with the quad at
+     * the distance and about pixelsPerRadian texels per radian straight ahead.
+     */
+    VRGuiLayer(float halfWidthAlpha, float bottomPhi, float topPhi, float distance,
+               float pixelsPerRadian);
+
+    /**
+     * Creates the texture and the quad in a new context; the layer has to be rendered again.
+     */
+    void GlSetup();
+
+    /**
+     * Whether the texture holds the layer, rendered since the last GlSetup.
+     */
+    bool IsValid() const;
+
+    /**
+     * The projection of the GUI space into the texture, for the programs rendering the layer.
+     */
+    const glm::mat4 &GetProjection() const;
+
+    /**
+     * Binds the framebuffer of the texture, sets the viewport to it and clears it, to render
+     * the layer with GetProjection.
+     */
+    void BeginRender();
+
+    GLuint GetTexture() const;
+
+    /**
+     * Draws the quad in the GUI space, for a GUI program with the texture bound.
+     */
+    void Render(GLsizei instanceCount = 1) const;
+
+private:
+    // bounds of the view on the plane one unit ahead
+    float left;
+    float right;
+    float bottom;
+    float top;
+    float distance;
+    GLsizei width;
+    GLsizei height;
+    glm::mat4 projection;
+
+    GLuint texture;
+    GLuint framebuffer;
+    VRGuiBatch quad;
+    bool valid;
+};
+
+#endif //VR_VIDEO_PLAYER_VRGUILAYER_H
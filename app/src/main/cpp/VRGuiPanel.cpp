@@ -0,0 +1,40 @@
+#include "VRGuiPanel.h"
+
+#include <utility>
+
+VRGuiPanel::VRGuiPanel() :
+        batch(),
+        bufferedState{} {
+}
+
+void VRGuiPanel::GlSetup() {
+    bufferedState.clear();
+    batch.GlSetup();
+}
+
+bool VRGuiPanel::Update(const VRGuiButton *buttons, std::size_t buttonCount) {
+    std::vector<bool> state(2 * buttonCount);
+    for (std::size_t i = 0; i < buttonCount; ++i) {
+        state[2 * i] = buttons[i].isVisible();
+        state[2 * i + 1] = buttons[i].isHighlighted();
+    }
+    if (state == bufferedState) {
+        return false;
+    }
+
+    std::vector<VRGuiBatch::Vertex> vertices;
+    for (std::size_t i = 0; i < buttonCount; ++i) {
+        const VRGuiButton &button = buttons[i];
+        if (button.isVisible()) {
+            VRGuiBatch::AddQuad(vertices, button.getVertexPos().data(),
+                                button.getVertexUV().data(), button.isHighlighted() ? 1.0f : 0.0f);
+        }
+    }
+    batch.Upload(vertices);
+    bufferedState = std::move(state);
+    return true;
+}
+
+void VRGuiPanel::Render(GLsizei instanceCount) const {
+    batch.Render(instanceCount);
+}
@@ -0,0 +1,39 @@
+#ifndef VR_VIDEO_PLAYER_VRGUIPANEL_H
+#define VR_VIDEO_PLAYER_VRGUIPANEL_H
+
+#include <cstddef>
+#include <vector>
+
+#include <GLES3/gl3.h>
+
+#include "VRGuiBatch.h"
+#include "VRGuiButton.h"
+
+/**
+ * The quads of all the visible buttons in one batch. The buffer is only rebuilt when a button is
+ * shown, hidden, or looked at or away from; whether it is looked at goes to the shader as a
+ * per-vertex highlight.
+ */
+class VRGuiPanel {
+public:
+    VRGuiPanel();
+
+    /**
+     * Creates the buffer in a new context; it is filled by the next Update.
+     */
+    void GlSetup();
+
+    /**
+     * Rebuilds the buffer if any button changed since the last call; returns whether it did.
+     */
+    bool Update(const VRGuiButton *buttons, std::size_t buttonCount);
+
+    void Render(GLsizei instanceCount = 1) const;
+
+private:
+    VRGuiBatch batch;
+    // visible and highlighted flags of the buttons in the buffer, empty when it needs a rebuild
+    std::vector<bool> bufferedState;
+};
+
+#endif //VR_VIDEO_PLAYER_VRGUIPANEL_H
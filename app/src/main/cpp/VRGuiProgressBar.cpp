@@ -1,6 +1,8 @@
 #include "VRGuiProgressBar.h"
 
-#include <GLES2/gl2.h>
+#include <GLES3/gl3.h>
+
+#include "GLState.h"
 
 static constexpr GLubyte line2DData[] = {0, 1};
 
@@ -12,15 +14,15 @@ VRGuiProgressBar::VRGuiProgressBar(float xCenter, float yCenter, float width, fl
           progress(0) {
 }
 
-void VRGuiProgressBar::render(GLint program2DParamPosition) const {
+void VRGuiProgressBar::render(GLint program2DParamPosition, GLsizei instanceCount) const {
     std::array<float, 6> progressLineCoords = {xCenter - 0.5f * width, yCenter, 0.5f,
                                                xCenter + width * (progress - 0.5f), yCenter, 0.5f};
 
-    glEnableVertexAttribArray(program2DParamPosition);
+    GetGLState().EnableVertexAttribArray(program2DParamPosition);
     glVertexAttribPointer(program2DParamPosition, 3, GL_FLOAT, GL_FALSE, 0,
                           progressLineCoords.data());
 
-    glDrawElements(GL_LINES, 2, GL_UNSIGNED_BYTE, line2DData);
+    glDrawElementsInstanced(GL_LINES, 2, GL_UNSIGNED_BYTE, line2DData, instanceCount);
 }
 
 void VRGuiProgressBar::setProgress(float progress) {
@@ -9,7 +9,7 @@ class VRGuiProgressBar {
 public:
     VRGuiProgressBar(float xCenter, float yCenter, float width, float height);
 
-    void render(GLint programParamPosition) const;
+    void render(GLint programParamPosition, GLsizei instanceCount = 1) const;
     void setProgress(float progress);
 
 private:
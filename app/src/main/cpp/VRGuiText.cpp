@@ -0,0 +1,155 @@
+#include "VRGuiText.h"
+
+#include <cmath>
+
+#include <algorithm>
+#include <array>
+
+#include "glm/vec2.hpp"
+#include "glm/vec3.hpp"
+#include "Projection.h"
+#include "VRGuiAtlas.h"
+
+static constexpr char32_t REPLACEMENT_CHARACTER = 0xfffd;
+static constexpr char32_t MISSING_GLYPH_CODEPOINT = '?';
+static constexpr char32_t ELLIPSIS_CODEPOINT = 0x2026;
+
+/**
+ * Decodes the code points, with a replacement character for every malformed sequence.
+ */
+static std::vector<char32_t> DecodeUtf8(const std::string &text) {
+    std::vector<char32_t> codepoints;
+    std::size_t i = 0;
+    while (i < text.size()) {
+        const auto lead = static_cast<unsigned char>(text[i++]);
+        int continuationCount;
+        char32_t codepoint;
+        if (lead < 0x80) {
+            codepoints.push_back(lead);
+            continue;
+        } else if ((lead & 0xe0) == 0xc0) {
+            continuationCount = 1;
+            codepoint = lead & 0x1fu;
+        } else if ((lead & 0xf0) == 0xe0) {
+            continuationCount = 2;
+            codepoint = lead & 0x0fu;
+        } else if ((lead & 0xf8) == 0xf0) {
+            continuationCount = 3;
+            codepoint = lead & 0x07u;
+        } else {
+            codepoints.push_back(REPLACEMENT_CHARACTER);
+            continue;
+        }
+
+        for (; continuationCount > 0 && i < text.size(); --continuationCount, ++i) {
+            const auto next = static_cast<unsigned char>(text[i]);
+            if ((next & 0xc0) != 0x80) {
+                break;
+            }
+            codepoint = (codepoint << 6u) | (next & 0x3fu);
+        }
+        codepoints.push_back(continuationCount == 0 ? codepoint : REPLACEMENT_CHARACTER);
+    }
+    return codepoints;
+}
+
+static const VRGuiGlyph *FindGlyph(char32_t codepoint) {
+    const VRGuiGlyph *end = VR_GUI_ATLAS_GLYPHS + VR_GUI_ATLAS_GLYPH_COUNT;
+    const VRGuiGlyph *found = std::lower_bound(
+            VR_GUI_ATLAS_GLYPHS, end, codepoint,
+            [](const VRGuiGlyph &glyph, char32_t value) { return glyph.codepoint < value; });
+    return found != end && found->codepoint == codepoint ? found : nullptr;
+}
+
+VRGuiText::VRGuiText() :
+        batch(),
+        vertices{},
+        changed(false) {
+}
+
+void VRGuiText::GlSetup() {
+    batch.GlSetup();
+    changed = true;
+}
+
+void VRGuiText::Clear() {
+    vertices.clear();
+    changed = true;
+}
+
+void VRGuiText::AddLine(const std::string &text, float centerTheta, float centerPhi,
+                        float centerDistance, float emAlpha, float maxWidthAlpha) {
+    const VRGuiGlyph *missingGlyph = FindGlyph(MISSING_GLYPH_CODEPOINT);
+    std::vector<const VRGuiGlyph *> glyphs;
+    float width = 0.0f;
+    for (char32_t codepoint: DecodeUtf8(text)) {
+        const VRGuiGlyph *glyph = FindGlyph(codepoint);
+        glyphs.push_back(glyph != nullptr ? glyph : missingGlyph);
+        width += glyphs.back()->advance;
+    }
+
+    // ems of the size of the line center, on the plane through it facing the viewer
+    const float emSize = 2.0f * centerDistance * tanf(0.5f * emAlpha);
+    const float maxWidth = 2.0f * centerDistance * tanf(0.5f * maxWidthAlpha) / emSize;
+    if (width > maxWidth) {
+        const VRGuiGlyph *ellipsis = FindGlyph(ELLIPSIS_CODEPOINT);
+        width += ellipsis->advance;
+        while (!glyphs.empty() && width > maxWidth) {
+            width -= glyphs.back()->advance;
+            glyphs.pop_back();
+        }
+        glyphs.push_back(ellipsis);
+    }
+
+    const glm::vec3 center = centerDistance * DirectionFromAngles(centerTheta, centerPhi);
+    const glm::vec3 xAxis =
+            emSize * DirectionFromAngles(centerTheta + 0.5f * PROJECTION_PI, 0.0f);
+    const glm::vec3 yAxis =
+            emSize * DirectionFromAngles(centerTheta, centerPhi + 0.5f * PROJECTION_PI);
+    const VRGuiAtlasMetrics &metrics = VR_GUI_ATLAS_METRICS;
+    // centered both ways, vertically between the ascender and the descender
+    const float baseline = -0.5f * (metrics.ascender + metrics.descender);
+    float penX = -0.5f * width;
+
+    for (const VRGuiGlyph *glyph: glyphs) {
+        const int *atlas = glyph->atlas;
+        if (atlas[2] > atlas[0]) {
+            const float *plane = glyph->plane;
+            const std::array<glm::vec2, 4> planeCorners = {
+                    glm::vec2(penX + plane[0], baseline + plane[3]),
+                    glm::vec2(penX + plane[0], baseline + plane[1]),
+                    glm::vec2(penX + plane[2], baseline + plane[1]),
+                    glm::vec2(penX + plane[2], baseline + plane[3]),
+            };
+            std::array<GLfloat, 12> positions{};
+            for (std::size_t i = 0; i < planeCorners.size(); ++i) {
+                const glm::vec3 position =
+                        center + planeCorners[i].x * xAxis + planeCorners[i].y * yAxis;
+                positions[3 * i] = position.x;
+                positions[3 * i + 1] = position.y;
+                positions[3 * i + 2] = position.z;
+            }
+            const float u0 = float(atlas[0]) / float(metrics.width);
+            const float v0 = float(atlas[1]) / float(metrics.height);
+            const float u1 = float(atlas[2]) / float(metrics.width);
+            const float v1 = float(atlas[3]) / float(metrics.height);
+            const std::array<GLfloat, 8> uvs = {u0, v0, u0, v1, u1, v1, u1, v0};
+            VRGuiBatch::AddQuad(vertices, positions.data(), uvs.data(), 0.0f);
+        }
+        penX += glyph->advance;
+    }
+    changed = true;
+}
+
+bool VRGuiText::Update() {
+    if (!changed) {
+        return false;
+    }
+    batch.Upload(vertices);
+    changed = false;
+    return true;
+}
+
+void VRGuiText::Render(GLsizei instanceCount) const {
+    batch.Render(instanceCount);
+}
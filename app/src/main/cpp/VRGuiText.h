@@ -0,0 +1,46 @@
+#ifndef VR_VIDEO_PLAYER_VRGUITEXT_H
+#define VR_VIDEO_PLAYER_VRGUITEXT_H
+
+#include <string>
+#include <vector>
+
+#include <GLES3/gl3.h>
+
+#include "VRGuiBatch.h"
+
+/**
+ * Lines of text from the glyphs and icons of the GUI atlas, in one batch drawn by the text
+ * program. Like the buttons, each line is placed by the angles of its center, facing the viewer.
+ */
+class VRGuiText {
+public:
+    VRGuiText();
+
+    /**
+     * Creates the buffer in a new context; the lines are uploaded again by the next Update.
+     */
+    void GlSetup();
+
+    void Clear();
+
+    /**
+     * Adds a line of UTF-8 text with an em of emAlpha radians; a line wider than maxWidthAlpha is
+     * cut short with an ellipsis. Characters missing in the atlas are shown as question marks.
+     */
+    void AddLine(const std::string &text, float centerTheta, float centerPhi, float centerDistance,
+                 float emAlpha, float maxWidthAlpha);
+
+    /**
+     * Uploads the lines, if they changed since the last call; returns whether they did.
+     */
+    bool Update();
+
+    void Render(GLsizei instanceCount = 1) const;
+
+private:
+    VRGuiBatch batch;
+    std::vector<VRGuiBatch::Vertex> vertices;
+    bool changed;
+};
+
+#endif //VR_VIDEO_PLAYER_VRGUITEXT_H
@@ -0,0 +1,149 @@
+#include "VideoMipmap.h"
+
+#include <GLES2/gl2ext.h>
+
+#include <algorithm>
+
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "GLUtils.h"
+
+// One triangle covering the viewport, without any vertex data.
+constexpr const char *kCopyVertexShader = R"glsl(#version 300 es
+out vec2 v_UV;
+
+void main() {
+  vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+  v_UV = 2.0 * corner;
+  gl_Position = vec4(4.0 * corner - 1.0, 0.0, 1.0);
+})glsl";
+
+// The texel centers of the copy fall between four video texels, so the bilinear sample is their
+// average.
+constexpr const char *kCopyFragmentShader = R"glsl(#version 300 es
+#extension GL_OES_EGL_image_external_essl3 : enable
+precision highp float;
+
+uniform highp samplerExternalOES u_Texture;
+in vec2 v_UV;
+out vec4 fragColor;
+
+void main() {
+  fragColor = texture(u_Texture, v_UV);
+})glsl";
+
+// the chain stops at this size, so the coarse levels do not smear the poles of stereo views
+// stacked above each other into one another
+static constexpr GLsizei MIN_LEVEL_SIZE = 32;
+// the poles of equirectangular video are stretched along the rows, anisotropic filtering keeps
+// them on the finer levels
+static constexpr GLfloat MAX_ANISOTROPY = 4.0f;
+
+VideoMipmap::VideoMipmap() :
+        programCache(),
+        program(0),
+        vertexArray(0),
+        texture(0),
+        framebuffer(0),
+        width(0),
+        height(0),
+        valid(false) {
+}
+
+void VideoMipmap::GlSetup() {
+    // called for a new context, the objects of the previous one are gone with it
+    texture = 0;
+    framebuffer = 0;
+    width = 0;
+    height = 0;
+    valid = false;
+
+    programCache.GlSetup();
+    program = programCache.Start(kCopyVertexShader, kCopyFragmentShader);
+    if (programCache.Finish(program)) {
+        GetGLState().UseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "u_Texture"), 0);
+    }
+    glGenVertexArrays(1, &vertexArray);
+    CHECK_GL_ERROR("Video mipmap program");
+}
+
+void VideoMipmap::Resize(GLsizei videoWidth, GLsizei videoHeight, GLenum internalFormat,
+                         bool wrapAround) {
+    DeleteTexture();
+    if (videoWidth <= 1 || videoHeight <= 1) {
+        return;
+    }
+
+    width = videoWidth / 2;
+    height = videoHeight / 2;
+    GLsizei levels = 1;
+    while (std::min(width, height) >> levels >= MIN_LEVEL_SIZE) {
+        ++levels;
+    }
+
+    glGenTextures(1, &texture);
+    GetGLState().BindTexture(GL_TEXTURE_2D, texture);
+    glTexStorage2D(GL_TEXTURE_2D, levels, internalFormat, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // the seam of a 360° view, the rows of its poles are clamped
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapAround ? GL_REPEAT : GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    if (GetGLExtensions().textureFilterAnisotropic) {
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT,
+                        std::min(MAX_ANISOTROPY, GetGLExtensions().maxTextureAnisotropy));
+    }
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, GL_NONE);
+    CHECK_GL_ERROR("Video mipmap setup");
+}
+
+bool VideoMipmap::IsEnabled() const {
+    return texture != 0;
+}
+
+bool VideoMipmap::IsValid() const {
+    return valid;
+}
+
+void VideoMipmap::Update(GLuint videoTexture) {
+    GLState &glState = GetGLState();
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glState.Viewport(0, 0, width, height);
+    glState.SetEnabled(GL_BLEND, false);
+    glState.SetEnabled(GL_SCISSOR_TEST, false);
+    glState.UseProgram(program);
+    glState.ActiveTexture(GL_TEXTURE0);
+    glState.BindTexture(GL_TEXTURE_EXTERNAL_OES, videoTexture);
+    glState.BindVertexArray(vertexArray);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glState.BindVertexArray(0);
+
+    glState.BindTexture(GL_TEXTURE_2D, texture);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    CHECK_GL_ERROR("Video mipmap update");
+    valid = true;
+}
+
+GLuint VideoMipmap::GetTexture() const {
+    return texture;
+}
+
+void VideoMipmap::DeleteTexture() {
+    if (texture == 0) {
+        return;
+    }
+    glDeleteFramebuffers(1, &framebuffer);
+    framebuffer = 0;
+    glDeleteTextures(1, &texture);
+    texture = 0;
+    width = 0;
+    height = 0;
+    valid = false;
+    // the name may come back bound to another texture
+    GetGLState().Reset();
+}
@@ -0,0 +1,58 @@
+#ifndef VR_VIDEO_PLAYER_VIDEOMIPMAP_H
+#define VR_VIDEO_PLAYER_VIDEOMIPMAP_H
+
+#include <GLES3/gl3.h>
+
+#include "ProgramCache.h"
+
+/**
+ * A mip-mapped copy of the video frame, for the eye passes to sample when the video is much denser
+ * than the eye buffers; sampling the external texture directly then skips texels, which shimmers
+ * and scatters the fetches. Each decoded frame is copied once, halved by a box filter, and the
+ * other levels are generated from that. The texels are the video colours as sampled, still encoded
+ * by the transfer function of HDR video.
+ */
+class VideoMipmap {
+public:
+    VideoMipmap();
+
+    /**
+     * Builds the copy program in a new context; the texture has to be resized again.
+     */
+    void GlSetup();
+
+    /**
+     * Recreates the texture for video of the size, in the format; the texels wrap around
+     * horizontally for wrapAround. A zero size deletes the texture, disabling the copy.
+     */
+    void Resize(GLsizei videoWidth, GLsizei videoHeight, GLenum internalFormat, bool wrapAround);
+
+    bool IsEnabled() const;
+
+    /**
+     * Whether the texture holds a frame, copied since the last Resize.
+     */
+    bool IsValid() const;
+
+    /**
+     * Copies the current frame of the external video texture and generates the other levels.
+     * Leaves the framebuffer of the copy bound.
+     */
+    void Update(GLuint videoTexture);
+
+    GLuint GetTexture() const;
+
+private:
+    ProgramCache programCache;
+    GLuint program;
+    GLuint vertexArray;
+    GLuint texture;
+    GLuint framebuffer;
+    GLsizei width;
+    GLsizei height;
+    bool valid;
+
+    void DeleteTexture();
+};
+
+#endif //VR_VIDEO_PLAYER_VIDEOMIPMAP_H
@@ -1,9 +1,12 @@
+#include <string>
+
 #include <jni.h>
 #include <android/log.h>
 #include <android/native_window.h>
 #include <android/native_window_jni.h>
 
 #include "logger.h"
+#include "ProgramCache.h"
 #include "Renderer.h"
 
 #define LOG_TAG "VRVideoPlayerN"
@@ -18,6 +21,13 @@ inline Renderer *fromJava(jlong ptr) {
 
 static JavaVM *javaVm;
 
+static std::string JavaToString(JNIEnv *env, jstring str) {
+    const char *chars = env->GetStringUTFChars(str, nullptr);
+    std::string result(chars);
+    env->ReleaseStringUTFChars(str, chars);
+    return result;
+}
+
 extern "C" JNIEXPORT jint JNI_OnLoad(JavaVM *vm, void * /*reserved*/) {
     javaVm = vm;
     return JNI_VERSION_1_6;
@@ -82,6 +92,17 @@ Java_cz_mormegil_vrvideoplayer_NativeLibrary_nativeSetScreenParams(
     fromJava(native_app)->SetScreenParams(width, height);
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_cz_mormegil_vrvideoplayer_NativeLibrary_nativeSetCompositorSurface(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong native_app,
+        jobject surface) {
+    LOG_DEBUG("nativeSetCompositorSurface");
+    fromJava(native_app)->SetCompositorWindow(
+            surface != nullptr ? ANativeWindow_fromSurface(env, surface) : nullptr);
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_cz_mormegil_vrvideoplayer_NativeLibrary_nativeSetOptions(
         JNIEnv * /* jenv */,
@@ -118,6 +139,16 @@ Java_cz_mormegil_vrvideoplayer_NativeLibrary_nativeScanCardboardQr(
     fromJava(native_app)->ScanCardboardQr();
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_cz_mormegil_vrvideoplayer_NativeLibrary_nativeSetEyeBufferQuality(
+        JNIEnv * /* jenv */,
+        jobject /* this */,
+        jlong native_app,
+        jfloat quality) {
+    LOG_DEBUG("nativeSetEyeBufferQuality");
+    fromJava(native_app)->SetEyeBufferQuality(quality);
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_cz_mormegil_vrvideoplayer_NativeLibrary_nativeShowProgressBar(
         JNIEnv * /* jenv */,
@@ -127,12 +158,92 @@ Java_cz_mormegil_vrvideoplayer_NativeLibrary_nativeShowProgressBar(
     fromJava(native_app)->ShowProgressBar();
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_cz_mormegil_vrvideoplayer_NativeLibrary_nativeSetVRGuiTitle(
+        JNIEnv *jenv,
+        jobject /* this */,
+        jlong native_app,
+        jstring title) {
+    LOG_DEBUG("nativeSetVRGuiTitle");
+    fromJava(native_app)->SetVRGuiTitle(JavaToString(jenv, title));
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_cz_mormegil_vrvideoplayer_NativeLibrary_nativeSetVideoTransfer(
+        JNIEnv * /* jenv */,
+        jobject /* this */,
+        jlong native_app,
+        jint transfer_int) {
+    LOG_DEBUG("nativeSetVideoTransfer");
+    fromJava(native_app)->SetVideoTransfer(static_cast<VideoTransfer>(transfer_int));
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_cz_mormegil_vrvideoplayer_NativeLibrary_nativeDrawFrame(
         JNIEnv *jenv,
         jobject /* this */,
         jlong native_app,
-        jfloat video_position) {
+        jfloat video_position,
+        jboolean new_video_frame) {
     // LOG_DEBUG("nativeDrawFrame");
-    fromJava(native_app)->DrawFrame(video_position, jenv);
+    fromJava(native_app)->DrawFrame(video_position, new_video_frame, jenv);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_cz_mormegil_vrvideoplayer_NativeLibrary_nativeNeedsRedraw(
+        JNIEnv * /* jenv */,
+        jobject /* this */,
+        jlong native_app) {
+    return static_cast<jboolean>(fromJava(native_app)->NeedsRedraw());
+}
+
+extern "C" JNIEXPORT jdoubleArray JNICALL
+Java_cz_mormegil_vrvideoplayer_NativeLibrary_nativeGetFrameTiming(
+        JNIEnv *jenv,
+        jobject /* this */,
+        jlong native_app) {
+    const FrameTimingModel model = fromJava(native_app)->GetFrameTiming();
+    // in the order of NativeLibrary.FrameTiming
+    const jdouble values[] = {
+            static_cast<jdouble>(model.GetPredictionErrorNanos()),
+            static_cast<jdouble>(model.GetPresentedFrameCount()),
+            static_cast<jdouble>(model.GetVsyncPeriodNanos()),
+            static_cast<jdouble>(model.GetPipelineDepth()),
+    };
+    const jsize count = sizeof(values) / sizeof(values[0]);
+    jdoubleArray result = jenv->NewDoubleArray(count);
+    jenv->SetDoubleArrayRegion(result, 0, count, values);
+    return result;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_cz_mormegil_vrvideoplayer_NativeLibrary_nativeLoadVideoMesh(
+        JNIEnv *jenv,
+        jobject /* this */,
+        jlong native_app,
+        jint video_fd,
+        jstring cache_path) {
+    LOG_DEBUG("nativeLoadVideoMesh");
+    return fromJava(native_app)->LoadVideoMesh(video_fd, JavaToString(jenv, cache_path));
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_cz_mormegil_vrvideoplayer_NativeLibrary_nativeLoadScreenMesh(
+        JNIEnv *jenv,
+        jobject /* this */,
+        jlong native_app,
+        jstring obj_path,
+        jstring cache_path) {
+    LOG_DEBUG("nativeLoadScreenMesh");
+    return fromJava(native_app)->LoadScreenMesh(JavaToString(jenv, obj_path),
+                                                JavaToString(jenv, cache_path));
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_cz_mormegil_vrvideoplayer_NativeLibrary_nativeSetProgramCacheDir(
+        JNIEnv *jenv,
+        jobject /* this */,
+        jstring cache_dir) {
+    LOG_DEBUG("nativeSetProgramCacheDir");
+    SetProgramCacheDirectory(JavaToString(jenv, cache_dir));
 }
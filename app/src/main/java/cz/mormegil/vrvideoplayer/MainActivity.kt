@@ -3,14 +3,20 @@ package cz.mormegil.vrvideoplayer
 import android.annotation.SuppressLint
 import android.graphics.PointF
 import android.media.AudioManager
+import android.media.MediaExtractor
+import android.media.MediaFormat
 import android.media.MediaPlayer
 import android.net.Uri
+import android.opengl.EGL14
 import android.opengl.GLSurfaceView
 import android.os.Bundle
+import android.provider.OpenableColumns
 import android.util.Log
+import android.view.Choreographer
 import android.view.MenuInflater
 import android.view.MenuItem
 import android.view.MotionEvent
+import android.view.SurfaceHolder
 import android.view.View
 import android.view.WindowManager
 import android.widget.RelativeLayout
@@ -20,15 +26,27 @@ import androidx.core.view.MenuCompat
 import androidx.core.view.WindowCompat
 import androidx.core.view.WindowInsetsCompat
 import androidx.core.view.WindowInsetsControllerCompat
+import androidx.lifecycle.Lifecycle
 import cz.mormegil.vrvideoplayer.databinding.ActivityMainBinding
+import java.io.File
+import java.io.FileDescriptor
+import java.io.IOException
+import java.io.PrintWriter
 import java.lang.IllegalArgumentException
+import javax.microedition.khronos.egl.EGL10
 import javax.microedition.khronos.egl.EGLConfig
+import javax.microedition.khronos.egl.EGLDisplay
+import javax.microedition.khronos.egl.EGLSurface
 import javax.microedition.khronos.opengles.GL10
+import kotlin.concurrent.thread
 import kotlin.math.roundToInt
 
 class MainActivity : AppCompatActivity(), MediaPlayer.OnVideoSizeChangedListener {
     companion object {
         private const val TAG = "VRVideoPlayer"
+        private const val SCREEN_MESH_FILE = "screen.obj"
+        private const val MESH_CACHE_DIR = "meshes"
+        private const val PROGRAM_CACHE_DIR = "programs"
     }
 
     private lateinit var binding: ActivityMainBinding
@@ -40,9 +58,29 @@ class MainActivity : AppCompatActivity(), MediaPlayer.OnVideoSizeChangedListener
     private var inputLayout: InputLayout = InputLayout.Mono
     private var inputMode: InputMode = InputMode.PlainFov
     private var outputMode: OutputMode = OutputMode.MonoLeft
+    private var renderQuality: RenderQuality = RenderQuality.Normal
+    private var customMeshAvailable = false
+
+    // reads the video format and imports the custom meshes, which may need to read through the
+    // whole video file
+    private var videoProbe: Thread? = null
+
+    // read on the GL thread when the surface is created
+    @Volatile
+    private var asyncTimewarp = false
 
     private var lastTouchCoordinates = arrayOf(1.0f, 0.0f)
 
+    // frames are drawn on demand: for new video frames, and whenever the native side needs one
+    private val frameScheduler = object : Choreographer.FrameCallback {
+        override fun doFrame(frameTimeNanos: Long) {
+            if (NativeLibrary.nativeNeedsRedraw(nativeApp)) {
+                glView.requestRender()
+            }
+            Choreographer.getInstance().postFrameCallback(this)
+        }
+    }
+
     @SuppressLint("ClickableViewAccessibility") // VR video really does not support accessibility (and the functionality is also accessible in an alternate way, anyway)
     override fun onCreate(savedInstanceState: Bundle?) {
         super.onCreate(savedInstanceState)
@@ -62,9 +100,11 @@ class MainActivity : AppCompatActivity(), MediaPlayer.OnVideoSizeChangedListener
 
         glView = binding.surfaceView
         glView.setEGLContextClientVersion(2)
+        glView.setEGLConfigChooser(CompositorConfigChooser())
+        glView.setEGLWindowSurfaceFactory(CompositorSurfaceFactory())
         val renderer = Renderer()
         glView.setRenderer(renderer)
-        glView.renderMode = GLSurfaceView.RENDERMODE_CONTINUOUSLY
+        glView.renderMode = GLSurfaceView.RENDERMODE_WHEN_DIRTY
         glView.setOnTouchListener { _, event ->
             // save the X,Y coordinates
             if (event.actionMasked == MotionEvent.ACTION_DOWN) {
@@ -85,10 +125,24 @@ class MainActivity : AppCompatActivity(), MediaPlayer.OnVideoSizeChangedListener
         }
 
         videoTexturePlayer = VideoTexturePlayer(this, videoUri, this)
+        videoTexturePlayer.onNewFrame = { glView.requestRender() }
 
         controller = Controller(getSystemService(AudioManager::class.java), videoTexturePlayer)
 
         nativeApp = NativeLibrary.nativeInit(this, assets, videoTexturePlayer, controller)
+        val programCacheDir = File(cacheDir, PROGRAM_CACHE_DIR)
+        programCacheDir.mkdirs()
+        NativeLibrary.nativeSetProgramCacheDir(programCacheDir.path)
+        videoProbe = thread(name = "VideoProbe") {
+            val transfer = videoTransfer(videoUri)
+            runOnUiThread {
+                if (nativeApp != 0L) {
+                    NativeLibrary.nativeSetVideoTransfer(nativeApp, transfer.ordinal)
+                }
+            }
+            loadCustomMeshes(videoUri)
+        }
+        NativeLibrary.nativeSetVRGuiTitle(nativeApp, videoTitle(videoUri))
 
         WindowCompat.setDecorFitsSystemWindows(window, false)
         WindowInsetsControllerCompat(window, binding.root).let { controller ->
@@ -108,6 +162,90 @@ class MainActivity : AppCompatActivity(), MediaPlayer.OnVideoSizeChangedListener
         volumeControlStream = AudioManager.STREAM_MUSIC
     }
 
+    private fun videoTitle(videoUri: Uri): String {
+        val displayName = try {
+            contentResolver.query(
+                videoUri, arrayOf(OpenableColumns.DISPLAY_NAME), null, null, null
+            )?.use { cursor ->
+                if (cursor.moveToFirst()) cursor.getString(0) else null
+            }
+        } catch (e: RuntimeException) {
+            Log.w(TAG, "Cannot query video name", e)
+            null
+        }
+        return displayName ?: videoUri.lastPathSegment ?: ""
+    }
+
+    // runs on the video probe thread, the extractor reads the file
+    private fun videoTransfer(videoUri: Uri): VideoTransfer {
+        val extractor = MediaExtractor()
+        try {
+            extractor.setDataSource(this, videoUri, null)
+            for (track in 0 until extractor.trackCount) {
+                val format = extractor.getTrackFormat(track)
+                val mime = format.getString(MediaFormat.KEY_MIME) ?: continue
+                if (mime.startsWith("video/") &&
+                    format.containsKey(MediaFormat.KEY_COLOR_TRANSFER)
+                ) {
+                    return when (format.getInteger(MediaFormat.KEY_COLOR_TRANSFER)) {
+                        MediaFormat.COLOR_TRANSFER_ST2084 -> VideoTransfer.Pq
+                        MediaFormat.COLOR_TRANSFER_HLG -> VideoTransfer.Hlg
+                        else -> VideoTransfer.Sdr
+                    }
+                }
+            }
+        } catch (e: IOException) {
+            Log.w(TAG, "Cannot read video format", e)
+        } catch (e: RuntimeException) {
+            Log.w(TAG, "Cannot read video format", e)
+        } finally {
+            extractor.release()
+        }
+        return VideoTransfer.Sdr
+    }
+
+    // runs on the video probe thread, the native side hands the meshes over to the GL thread
+    private fun loadCustomMeshes(videoUri: Uri) {
+        val meshCacheDir = File(cacheDir, MESH_CACHE_DIR)
+        meshCacheDir.mkdirs()
+
+        // a custom screen (dome, curved cinema...) provided by the user for any video
+        var screenMeshLoaded = false
+        val screenMesh = File(getExternalFilesDir(null), SCREEN_MESH_FILE)
+        if (screenMesh.isFile) {
+            val cacheFile =
+                File(meshCacheDir, "screen-${screenMesh.length()}-${screenMesh.lastModified()}.mesh")
+            screenMeshLoaded =
+                NativeLibrary.nativeLoadScreenMesh(nativeApp, screenMesh.path, cacheFile.path)
+        }
+
+        // a projection mesh embedded in the video itself
+        var videoMeshLoaded = false
+        try {
+            contentResolver.openFileDescriptor(videoUri, "r")?.use { fd ->
+                val uriHash = Integer.toHexString(videoUri.toString().hashCode())
+                val cacheFile = File(meshCacheDir, "video-$uriHash-${fd.statSize}.mesh")
+                videoMeshLoaded =
+                    NativeLibrary.nativeLoadVideoMesh(nativeApp, fd.fd, cacheFile.path)
+            }
+        } catch (e: IOException) {
+            Log.w(TAG, "Cannot open video for projection mesh", e)
+        } catch (e: RuntimeException) {
+            Log.w(TAG, "Cannot open video for projection mesh", e)
+        }
+
+        runOnUiThread {
+            if (nativeApp == 0L) {
+                return@runOnUiThread
+            }
+            customMeshAvailable = screenMeshLoaded || videoMeshLoaded
+            // the renderer switches to the projection mesh of the video on its own
+            if (videoMeshLoaded) {
+                inputMode = InputMode.CustomMesh
+            }
+        }
+    }
+
     fun closePlayer(view: View) {
         finish()
     }
@@ -118,9 +256,12 @@ class MainActivity : AppCompatActivity(), MediaPlayer.OnVideoSizeChangedListener
         inflater.inflate(R.menu.settings_menu, popup.menu)
         MenuCompat.setGroupDividerEnabled(popup.menu, true)
 
+        popup.menu.findItem(R.id.input_mode_custom_mesh).setVisible(customMeshAvailable)
         popup.menu.findItem(inputMode.menuItemId()).setChecked(true)
         popup.menu.findItem(inputLayout.menuItemId()).setChecked(true)
         popup.menu.findItem(outputMode.menuItemId()).setChecked(true)
+        popup.menu.findItem(renderQuality.menuItemId()).setChecked(true)
+        popup.menu.findItem(R.id.async_timewarp).setChecked(asyncTimewarp)
 
         popup.setOnMenuItemClickListener { item: MenuItem ->
             when (item.itemId) {
@@ -149,6 +290,21 @@ class MainActivity : AppCompatActivity(), MediaPlayer.OnVideoSizeChangedListener
                     return@setOnMenuItemClickListener true
                 }
 
+                R.id.input_layout_anaglyph_red_cyan_half_color -> {
+                    setInputLayout(InputLayout.AnaglyphRedCyanHalfColor, item)
+                    return@setOnMenuItemClickListener true
+                }
+
+                R.id.input_layout_anaglyph_green_magenta -> {
+                    setInputLayout(InputLayout.AnaglyphGreenMagenta, item)
+                    return@setOnMenuItemClickListener true
+                }
+
+                R.id.input_layout_anaglyph_amber_blue -> {
+                    setInputLayout(InputLayout.AnaglyphAmberBlue, item)
+                    return@setOnMenuItemClickListener true
+                }
+
                 R.id.input_mode_plain_fov -> {
                     setInputMode(InputMode.PlainFov, item)
                     return@setOnMenuItemClickListener true
@@ -174,6 +330,26 @@ class MainActivity : AppCompatActivity(), MediaPlayer.OnVideoSizeChangedListener
                     return@setOnMenuItemClickListener true
                 }
 
+                R.id.input_mode_cube_map -> {
+                    setInputMode(InputMode.CubeMap, item)
+                    return@setOnMenuItemClickListener true
+                }
+
+                R.id.input_mode_equiang_cube_map -> {
+                    setInputMode(InputMode.EquiangCubeMap, item)
+                    return@setOnMenuItemClickListener true
+                }
+
+                R.id.input_mode_fisheye_180 -> {
+                    setInputMode(InputMode.Fisheye180, item)
+                    return@setOnMenuItemClickListener true
+                }
+
+                R.id.input_mode_custom_mesh -> {
+                    setInputMode(InputMode.CustomMesh, item)
+                    return@setOnMenuItemClickListener true
+                }
+
                 R.id.output_mode_mono_left_eye -> {
                     setOutputMode(OutputMode.MonoLeft, item)
                     return@setOnMenuItemClickListener true
@@ -189,6 +365,26 @@ class MainActivity : AppCompatActivity(), MediaPlayer.OnVideoSizeChangedListener
                     return@setOnMenuItemClickListener true
                 }
 
+                R.id.render_quality_low -> {
+                    setRenderQuality(RenderQuality.Low, item)
+                    return@setOnMenuItemClickListener true
+                }
+
+                R.id.render_quality_normal -> {
+                    setRenderQuality(RenderQuality.Normal, item)
+                    return@setOnMenuItemClickListener true
+                }
+
+                R.id.render_quality_high -> {
+                    setRenderQuality(RenderQuality.High, item)
+                    return@setOnMenuItemClickListener true
+                }
+
+                R.id.async_timewarp -> {
+                    setAsyncTimewarp(!asyncTimewarp, item)
+                    return@setOnMenuItemClickListener true
+                }
+
                 else -> {
                     return@setOnMenuItemClickListener false
                 }
@@ -236,10 +432,42 @@ class MainActivity : AppCompatActivity(), MediaPlayer.OnVideoSizeChangedListener
         }
     }
 
+    private fun setRenderQuality(newQuality: RenderQuality, menuItem: MenuItem) {
+        if (newQuality != renderQuality) {
+            renderQuality = newQuality
+            NativeLibrary.nativeSetEyeBufferQuality(nativeApp, renderQuality.eyeBufferScale)
+            menuItem.isChecked = true
+        }
+    }
+
+    private fun setAsyncTimewarp(enabled: Boolean, menuItem: MenuItem) {
+        asyncTimewarp = enabled
+        // the window goes to the compositor, or back, when the surface is recreated
+        glView.onPause()
+        glView.onResume()
+        menuItem.isChecked = enabled
+    }
+
+    // called by the native renderer on the GL thread when the compositor cannot show frames
+    @Suppress("unused")
+    fun onCompositorFailed() {
+        runOnUiThread {
+            if (asyncTimewarp) {
+                asyncTimewarp = false
+                // a paused view gets a new surface when resumed anyway
+                if (lifecycle.currentState.isAtLeast(Lifecycle.State.RESUMED)) {
+                    glView.onPause()
+                    glView.onResume()
+                }
+            }
+        }
+    }
+
     private fun doResume() {
         glView.onResume()
         NativeLibrary.nativeOnResume(nativeApp)
         videoTexturePlayer.onResume()
+        Choreographer.getInstance().postFrameCallback(frameScheduler)
     }
 
     override fun onResume() {
@@ -251,6 +479,7 @@ class MainActivity : AppCompatActivity(), MediaPlayer.OnVideoSizeChangedListener
     override fun onPause() {
         super.onPause()
         Log.d(TAG, "onPause()")
+        Choreographer.getInstance().removeFrameCallback(frameScheduler)
         videoTexturePlayer.onPause()
         NativeLibrary.nativeOnPause(nativeApp)
         glView.onPause()
@@ -259,16 +488,97 @@ class MainActivity : AppCompatActivity(), MediaPlayer.OnVideoSizeChangedListener
     override fun onDestroy() {
         super.onDestroy()
         Log.d(TAG, "onDestroy()")
+        // the probe uses the native renderer until it is done
+        videoProbe?.join()
+        videoProbe = null
         NativeLibrary.nativeOnDestroy(nativeApp)
         nativeApp = 0
         videoTexturePlayer.onDestroy()
     }
 
+    // adb shell dumpsys activity cz.mormegil.vrvideoplayer/.MainActivity
+    override fun dump(
+        prefix: String,
+        fd: FileDescriptor?,
+        writer: PrintWriter,
+        args: Array<out String>?
+    ) {
+        super.dump(prefix, fd, writer, args)
+        if (nativeApp == 0L) {
+            return
+        }
+        val timing = NativeLibrary.getFrameTiming(nativeApp)
+        val errorMs = "%.2f".format(timing.predictionErrorNanos * 1e-6)
+        val periodMs = "%.3f".format(timing.vsyncPeriodNanos * 1e-6)
+        val depth = "%.2f".format(timing.pipelineDepth)
+        writer.println("${prefix}Frame timing:")
+        writer.println(
+            "$prefix  pose prediction error $errorMs ms over ${timing.presentedFrames} frames"
+        )
+        writer.println("$prefix  vsync period $periodMs ms, pipeline depth $depth vsyncs")
+    }
+
     override fun onVideoSizeChanged(mp: MediaPlayer?, width: Int, height: Int) {
         Log.d(TAG, "onVideoSizeChanged()")
         NativeLibrary.nativeOnVideoSizeChanged(nativeApp, width, height)
     }
 
+    /**
+     * The usual RGB888 config, which must also support pbuffers for the offscreen surface used
+     * with asynchronous timewarp.
+     */
+    private class CompositorConfigChooser : GLSurfaceView.EGLConfigChooser {
+        override fun chooseConfig(egl: EGL10, display: EGLDisplay): EGLConfig {
+            val attributes = intArrayOf(
+                EGL10.EGL_RED_SIZE, 8,
+                EGL10.EGL_GREEN_SIZE, 8,
+                EGL10.EGL_BLUE_SIZE, 8,
+                EGL10.EGL_DEPTH_SIZE, 16,
+                EGL10.EGL_RENDERABLE_TYPE, EGL14.EGL_OPENGL_ES2_BIT,
+                EGL10.EGL_SURFACE_TYPE, EGL10.EGL_WINDOW_BIT or EGL10.EGL_PBUFFER_BIT,
+                EGL10.EGL_NONE
+            )
+            val configs = arrayOfNulls<EGLConfig>(1)
+            val configCount = IntArray(1)
+            if (!egl.eglChooseConfig(display, attributes, configs, 1, configCount) ||
+                configCount[0] == 0
+            ) {
+                throw IllegalArgumentException("No EGL config for window and pbuffer surfaces")
+            }
+            return configs[0]!!
+        }
+    }
+
+    /**
+     * With asynchronous timewarp, the native compositor thread renders into the window, and the
+     * frames are rendered into a pbuffer instead.
+     */
+    private inner class CompositorSurfaceFactory : GLSurfaceView.EGLWindowSurfaceFactory {
+        override fun createWindowSurface(
+            egl: EGL10,
+            display: EGLDisplay,
+            config: EGLConfig,
+            nativeWindow: Any?
+        ): EGLSurface? {
+            if (!asyncTimewarp) {
+                return egl.eglCreateWindowSurface(display, config, nativeWindow, null)
+            }
+            NativeLibrary.nativeSetCompositorSurface(
+                nativeApp,
+                (nativeWindow as SurfaceHolder).surface
+            )
+            val attributes = intArrayOf(EGL10.EGL_WIDTH, 1, EGL10.EGL_HEIGHT, 1, EGL10.EGL_NONE)
+            return egl.eglCreatePbufferSurface(display, config, attributes)
+        }
+
+        override fun destroySurface(egl: EGL10, display: EGLDisplay, surface: EGLSurface) {
+            if (nativeApp != 0L) {
+                NativeLibrary.nativeSetCompositorSurface(nativeApp, null)
+            }
+            egl.eglDestroySurface(display, surface)
+        }
+    }
+
     private inner class Renderer : GLSurfaceView.Renderer {
         override fun onSurfaceCreated(gl10: GL10?, config: EGLConfig?) {
             NativeLibrary.nativeOnSurfaceCreated(nativeApp)
@@ -279,8 +589,12 @@ class MainActivity : AppCompatActivity(), MediaPlayer.OnVideoSizeChangedListener
         }
 
         override fun onDrawFrame(gl10: GL10?) {
-            videoTexturePlayer.updateIfNeeded()
-            NativeLibrary.nativeDrawFrame(nativeApp, videoTexturePlayer.getVideoPosition())
+            val newVideoFrame = videoTexturePlayer.updateIfNeeded()
+            NativeLibrary.nativeDrawFrame(
+                nativeApp,
+                videoTexturePlayer.getVideoPosition(),
+                newVideoFrame
+            )
         }
     }
 }
@@ -2,6 +2,7 @@ package cz.mormegil.vrvideoplayer
 
 import android.content.Context
 import android.content.res.AssetManager
+import android.view.Surface
 
 object NativeLibrary {
     external fun nativeInit(
@@ -16,9 +17,12 @@ object NativeLibrary {
     external fun nativeOnDestroy(nativeApp: Long)
     external fun nativeOnSurfaceCreated(nativeApp: Long)
     external fun nativeSetScreenParams(nativeApp: Long, width: Int, height: Int)
+    external fun nativeSetCompositorSurface(nativeApp: Long, surface: Surface?)
     external fun nativeOnVideoSizeChanged(nativeApp: Long, width: Int, height: Int)
     external fun nativeScanCardboardQr(nativeApp: Long)
     external fun nativeShowProgressBar(nativeApp: Long)
+    external fun nativeSetVRGuiTitle(nativeApp: Long, title: String)
+    external fun nativeSetVideoTransfer(nativeApp: Long, transfer: Int)
     external fun nativeSetOptions(
         nativeApp: Long,
         inputLayout: Int,
@@ -26,11 +30,26 @@ object NativeLibrary {
         outputMode: Int
     )
 
+    external fun nativeSetEyeBufferQuality(nativeApp: Long, quality: Float)
+
+    external fun nativeLoadVideoMesh(nativeApp: Long, videoFd: Int, cachePath: String): Boolean
+    external fun nativeLoadScreenMesh(nativeApp: Long, objPath: String, cachePath: String): Boolean
+    external fun nativeSetProgramCacheDir(cacheDir: String)
+
     external fun nativeDrawFrame(
         nativeApp: Long,
-        videoPosition: Float
+        videoPosition: Float,
+        newVideoFrame: Boolean
     )
 
+    external fun nativeNeedsRedraw(nativeApp: Long): Boolean
+    private external fun nativeGetFrameTiming(nativeApp: Long): DoubleArray
+
+    fun getFrameTiming(nativeApp: Long): FrameTiming {
+        val values = nativeGetFrameTiming(nativeApp)
+        return FrameTiming(values[0], values[1].toLong(), values[2], values[3])
+    }
+
     init {
         System.loadLibrary("vrvideoplayer")
     }
@@ -51,6 +70,15 @@ enum class InputLayout {
     },
     AnaglyphRedCyan {
         override fun menuItemId(): Int = R.id.input_layout_anaglyph_red_cyan
+    },
+    AnaglyphRedCyanHalfColor {
+        override fun menuItemId(): Int = R.id.input_layout_anaglyph_red_cyan_half_color
+    },
+    AnaglyphGreenMagenta {
+        override fun menuItemId(): Int = R.id.input_layout_anaglyph_green_magenta
+    },
+    AnaglyphAmberBlue {
+        override fun menuItemId(): Int = R.id.input_layout_anaglyph_amber_blue
     };
 
     abstract fun menuItemId(): Int
@@ -70,10 +98,10 @@ enum class InputMode {
         override fun menuItemId(): Int = R.id.input_mode_equirect_360
     },
     CubeMap {
-        override fun menuItemId(): Int = throw IllegalArgumentException()
+        override fun menuItemId(): Int = R.id.input_mode_cube_map
     },
     EquiangCubeMap {
-        override fun menuItemId(): Int = throw IllegalArgumentException()
+        override fun menuItemId(): Int = R.id.input_mode_equiang_cube_map
     },
     Pyramid {
         override fun menuItemId(): Int = throw IllegalArgumentException()
@@ -83,6 +111,12 @@ enum class InputMode {
     },
     Panorama360 {
         override fun menuItemId(): Int = R.id.input_mode_panorama_360
+    },
+    CustomMesh {
+        override fun menuItemId(): Int = R.id.input_mode_custom_mesh
+    },
+    Fisheye180 {
+        override fun menuItemId(): Int = R.id.input_mode_fisheye_180
     };
 
     abstract fun menuItemId(): Int
@@ -104,3 +138,35 @@ enum class OutputMode {
 
     abstract fun menuItemId(): Int
 }
+
+enum class RenderQuality(val eyeBufferScale: Float) {
+    Low(0.7f) {
+        override fun menuItemId(): Int = R.id.render_quality_low
+    },
+    Normal(1.0f) {
+        override fun menuItemId(): Int = R.id.render_quality_normal
+    },
+    High(1.4f) {
+        override fun menuItemId(): Int = R.id.render_quality_high
+    };
+
+    abstract fun menuItemId(): Int
+}
+
+// the transfer function of the video, by the ordinal
+enum class VideoTransfer {
+    Sdr,
+    Pq,
+    Hlg
+}
+
+// the metrics of the display timing model, for the pose prediction
+data class FrameTiming(
+    // smoothed difference between the predicted and the actual display times of the frames
+    val predictionErrorNanos: Double,
+    // frames with an actual display time; without any, the error is not known
+    val presentedFrames: Long,
+    val vsyncPeriodNanos: Double,
+    // vsyncs from the first one after a frame starts to its display
+    val pipelineDepth: Double
+)
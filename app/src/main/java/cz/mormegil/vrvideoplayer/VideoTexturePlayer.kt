@@ -25,6 +25,9 @@ class VideoTexturePlayer(private val context: Context,
     private var videoPosition: Float = 0.0f
     private val frameAvailable: AtomicBoolean = AtomicBoolean(false)
 
+    // called on an arbitrary thread whenever a new video frame is ready
+    var onNewFrame: (() -> Unit)? = null
+
     fun initializePlayback(texName: Int) {
         cleanup()
 
@@ -117,11 +120,15 @@ class VideoTexturePlayer(private val context: Context,
         }
 
         frameAvailable.set(true)
+        onNewFrame?.invoke()
     }
 
-    fun updateIfNeeded() {
-        if (frameAvailable.getAndSet(false)) {
-            surfaceTexture?.updateTexImage()
+    // latches the latest frame into the texture, returns whether there was a new one
+    fun updateIfNeeded(): Boolean {
+        if (!frameAvailable.getAndSet(false)) {
+            return false
         }
+        surfaceTexture?.updateTexImage()
+        return true
     }
 }
@@ -0,0 +1,135 @@
+#include <cstdint>
+
+#include <initializer_list>
+
+#include "FrameTimingModel.h"
+#include "TestCheck.h"
+
+/**
+ * Drives the FrameTimingModel with synthetic vsync timestamps, with jitter and skipped callbacks
+ * like the ones of the Choreographer, and with present times of frames shown a fixed number of
+ * vsyncs after the first one following their start.
+ */
+
+static constexpr uint64_t START_NANOS = 1'000'000'000'000ULL;
+
+/**
+ * A display with a fixed vsync period, and deterministic jitter of its callbacks.
+ */
+class SyntheticDisplay {
+public:
+    explicit SyntheticDisplay(uint64_t periodNanos) :
+            periodNanos(periodNanos),
+            random(12345) {
+    }
+
+    uint64_t Vsync(uint64_t index) const {
+        return START_NANOS + index * periodNanos;
+    }
+
+    // the first vsync strictly after the time
+    uint64_t NextVsync(uint64_t timeNanos) const {
+        return Vsync((timeNanos - START_NANOS) / periodNanos + 1);
+    }
+
+    // the callback of the vsync, up to 0.2 ms late
+    uint64_t CallbackTime(uint64_t index) {
+        random = random * 1103515245u + 12345u;
+        return Vsync(index) + (random >> 8) % 200'000u;
+    }
+
+    const uint64_t periodNanos;
+
+private:
+    uint32_t random;
+};
+
+/**
+ * Runs the model for the frames, one per vsync except for every fifth, each started some time
+ * after the vsync callback and presented depth vsyncs after the first vsync following its start.
+ * Every seventh vsync callback is skipped. Returns the last prediction error.
+ */
+static int64_t RunFrames(FrameTimingModel &model, SyntheticDisplay &display, uint64_t firstVsync,
+                         int frameCount, int depth) {
+    int64_t error = 0;
+    for (uint64_t index = firstVsync; index < firstVsync + uint64_t(frameCount); ++index) {
+        if (index % 7 != 0) {
+            model.OnVsync(display.CallbackTime(index));
+        }
+        if (index % 5 == 0) {
+            continue;
+        }
+        // the frames start at varying phases of the vsync period
+        const uint64_t startNanos = display.Vsync(index) + 1'000'000 +
+                                    (index % 3) * display.periodNanos / 4;
+        const uint64_t predictedNanos = model.PredictDisplayTime(startNanos);
+        const uint64_t presentNanos =
+                display.NextVsync(startNanos) + uint64_t(depth) * display.periodNanos;
+        model.OnFramePresented(startNanos, predictedNanos, presentNanos);
+        error = int64_t(predictedNanos - presentNanos);
+    }
+    return error;
+}
+
+static void TestDefaultPrediction() {
+    FrameTimingModel model;
+    CHECK(model.GetVsyncPeriodNanos() == 0);
+    // no vsync yet, a fixed latency
+    CHECK(model.PredictDisplayTime(START_NANOS) == START_NANOS + 50'000'000);
+    CHECK_NEAR(model.GetPipelineDepth(), 1.0, 1e-6);
+}
+
+static void TestVsyncPeriod() {
+    for (uint64_t period: {16'666'667ULL, 11'111'111ULL}) {
+        FrameTimingModel model;
+        SyntheticDisplay display(period);
+        RunFrames(model, display, 0, 600, 1);
+        CHECK_NEAR(double(model.GetVsyncPeriodNanos()), double(period), 50'000.0);
+    }
+}
+
+static void TestPipelineDepth() {
+    for (int depth: {0, 1, 2, 3}) {
+        FrameTimingModel model;
+        SyntheticDisplay display(16'666'667);
+        const int64_t error = RunFrames(model, display, 0, 600, depth);
+        CHECK_NEAR(model.GetPipelineDepth(), double(depth), 0.05);
+        // within the callback jitter and what is left of the period estimate
+        CHECK_NEAR(double(error), 0.0, 1'000'000.0);
+        CHECK(model.GetPredictionErrorNanos() < 1'000'000);
+        CHECK(model.GetPresentedFrameCount() == 480);
+    }
+}
+
+static void TestDepthChange() {
+    FrameTimingModel model;
+    SyntheticDisplay display(16'666'667);
+    RunFrames(model, display, 0, 300, 1);
+    CHECK_NEAR(model.GetPipelineDepth(), 1.0, 0.05);
+    // e.g. the system compositor starts composing the app instead of an overlay
+    RunFrames(model, display, 300, 300, 2);
+    CHECK_NEAR(model.GetPipelineDepth(), 2.0, 0.05);
+}
+
+static void TestPause() {
+    FrameTimingModel model;
+    SyntheticDisplay display(16'666'667);
+    RunFrames(model, display, 0, 300, 2);
+    // a second without vsyncs is a pause, not 60 skipped callbacks
+    RunFrames(model, display, 360, 300, 2);
+    CHECK_NEAR(double(model.GetVsyncPeriodNanos()), 16'666'667.0, 50'000.0);
+    CHECK_NEAR(model.GetPipelineDepth(), 2.0, 0.05);
+
+    model.Reset();
+    CHECK(model.GetVsyncPeriodNanos() == 0);
+    CHECK(model.GetPresentedFrameCount() == 0);
+}
+
+int main() {
+    TestDefaultPrediction();
+    TestVsyncPeriod();
+    TestPipelineDepth();
+    TestDepthChange();
+    TestPause();
+    return TestResult();
+}
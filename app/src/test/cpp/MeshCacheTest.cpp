@@ -0,0 +1,105 @@
+#include <cstdint>
+#include <cstdio>
+
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "MeshCache.h"
+#include "TestCheck.h"
+
+/**
+ * Writes mesh caches, damages them the way a crash or a bad storage block would, and checks that
+ * LoadMeshCache refuses them instead of handing out meshes drawing past their arrays.
+ */
+
+// the layout of the first mesh entry, after the 16-byte header
+static constexpr off_t FIRST_ENTRY_MODE_OFFSET = 16;
+static constexpr off_t FIRST_ENTRY_INDEX_OFFSET_OFFSET = 16 + 5 * 4;
+
+static std::string CachePath(const char *name) {
+    return std::string(P_tmpdir) + "/MeshCacheTest-" + std::to_string(getpid()) + "-" + name;
+}
+
+static std::vector<TexturedMesh::Builder> QuadMeshes() {
+    std::vector<TexturedMesh::Builder> meshes(1);
+    TexturedMesh::Builder &quad = meshes[0];
+    GLushort a = quad.add_vertex(-1.0f, -1.0f, -1.0f, 0.0f, 1.0f);
+    GLushort b = quad.add_vertex(1.0f, -1.0f, -1.0f, 1.0f, 1.0f);
+    GLushort c = quad.add_vertex(1.0f, 1.0f, -1.0f, 1.0f, 0.0f);
+    GLushort d = quad.add_vertex(-1.0f, 1.0f, -1.0f, 0.0f, 0.0f);
+    quad.add_quad(a, b, c, d);
+    return meshes;
+}
+
+static uint32_t ReadUint32(const std::string &path, off_t offset) {
+    uint32_t value = 0;
+    int fd = open(path.c_str(), O_RDONLY);
+    CHECK(pread(fd, &value, sizeof(value), offset) == sizeof(value));
+    close(fd);
+    return value;
+}
+
+static void Overwrite(const std::string &path, off_t offset, const void *data, std::size_t size) {
+    int fd = open(path.c_str(), O_WRONLY);
+    CHECK(pwrite(fd, data, size, offset) == ssize_t(size));
+    close(fd);
+}
+
+static void TestRoundTrip() {
+    const std::string path = CachePath("valid");
+    CHECK(WriteMeshCache(path, QuadMeshes()));
+    std::vector<TexturedMesh> meshes;
+    CHECK(LoadMeshCache(path, meshes));
+    CHECK(meshes.size() == 1);
+
+    // a source without meshes is cached as such
+    CHECK(WriteMeshCache(path, {}));
+    CHECK(LoadMeshCache(path, meshes));
+    CHECK(meshes.empty());
+    unlink(path.c_str());
+}
+
+static void TestIndexOutOfRange() {
+    const std::string path = CachePath("index");
+    CHECK(WriteMeshCache(path, QuadMeshes()));
+    const uint32_t indexOffset = ReadUint32(path, FIRST_ENTRY_INDEX_OFFSET_OFFSET);
+    const GLushort badIndex = 4;
+    Overwrite(path, off_t(indexOffset + sizeof(GLushort)), &badIndex, sizeof(badIndex));
+
+    std::vector<TexturedMesh> meshes;
+    CHECK(!LoadMeshCache(path, meshes));
+    CHECK(meshes.empty());
+    unlink(path.c_str());
+}
+
+static void TestUnknownMode() {
+    const std::string path = CachePath("mode");
+    CHECK(WriteMeshCache(path, QuadMeshes()));
+    const uint32_t lineStrip = GL_LINE_STRIP;
+    Overwrite(path, FIRST_ENTRY_MODE_OFFSET, &lineStrip, sizeof(lineStrip));
+
+    std::vector<TexturedMesh> meshes;
+    CHECK(!LoadMeshCache(path, meshes));
+    unlink(path.c_str());
+}
+
+static void TestTruncated() {
+    const std::string path = CachePath("truncated");
+    CHECK(WriteMeshCache(path, QuadMeshes()));
+    CHECK(truncate(path.c_str(), 40) == 0);
+
+    std::vector<TexturedMesh> meshes;
+    CHECK(!LoadMeshCache(path, meshes));
+    unlink(path.c_str());
+}
+
+int main() {
+    TestRoundTrip();
+    TestIndexOutOfRange();
+    TestUnknownMode();
+    TestTruncated();
+    return TestResult();
+}
@@ -0,0 +1,345 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "MeshImport.h"
+#include "TestCheck.h"
+
+/**
+ * Checks the sv3d import on an MP4 file laid out like the ones of the spherical video cameras and
+ * encoders: an audio and a video track, the projection mesh inside the avc1 sample entry, after
+ * its avcC and st3d boxes. Run with the path of a real mesh projection video to import that as
+ * well.
+ */
+
+typedef std::vector<uint8_t> Bytes;
+
+static void Append32(Bytes &bytes, uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        bytes.push_back(uint8_t(value >> shift));
+    }
+}
+
+static void Append16(Bytes &bytes, uint16_t value) {
+    bytes.push_back(uint8_t(value >> 8));
+    bytes.push_back(uint8_t(value));
+}
+
+static void AppendZeros(Bytes &bytes, std::size_t count) {
+    bytes.insert(bytes.end(), count, 0);
+}
+
+static void AppendBytes(Bytes &bytes, const Bytes &other) {
+    bytes.insert(bytes.end(), other.begin(), other.end());
+}
+
+static Bytes Box(const char *type, const Bytes &payload) {
+    Bytes box;
+    Append32(box, uint32_t(8 + payload.size()));
+    box.insert(box.end(), type, type + 4);
+    AppendBytes(box, payload);
+    return box;
+}
+
+static Bytes Boxes(std::initializer_list<Bytes> boxes) {
+    Bytes bytes;
+    for (const Bytes &box: boxes) {
+        AppendBytes(bytes, box);
+    }
+    return bytes;
+}
+
+// a full box with version 0 and no flags
+static Bytes FullBox(const char *type, const Bytes &payload) {
+    Bytes bytes;
+    Append32(bytes, 0);
+    AppendBytes(bytes, payload);
+    return Box(type, bytes);
+}
+
+class BitWriter {
+public:
+    void Write(int bits, uint32_t value) {
+        for (int i = bits - 1; i >= 0; --i) {
+            if (bitPos % 8 == 0) {
+                bytes.push_back(0);
+            }
+            bytes.back() |= uint8_t(((value >> i) & 1u) << (7 - bitPos % 8));
+            ++bitPos;
+        }
+    }
+
+    void WriteFloat(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        Write(32, bits);
+    }
+
+    void AlignToByte() {
+        bitPos = (bitPos + 7) & ~std::size_t(7);
+    }
+
+    const Bytes &GetBytes() const {
+        return bytes;
+    }
+
+private:
+    Bytes bytes;
+    std::size_t bitPos = 0;
+};
+
+static uint32_t ZigZag(int32_t value) {
+    return uint32_t(value << 1) ^ uint32_t(value >> 31);
+}
+
+/**
+ * A quad at distance 1 in front of the viewer, 2 x 2 units large, as one triangle strip; the
+ * coordinate list is -1, 0, 1, 0.5 and the vertices index it by delta.
+ */
+static Bytes QuadMeshBox(float uvOffset) {
+    const float coordinates[] = {-1.0f, 0.0f, 1.0f, 0.5f + uvOffset};
+    // x, y, z, u, v as indices into the coordinates
+    const int vertices[4][5] = {
+            {0, 0, 0, 1, 1},
+            {2, 0, 0, 3, 1},
+            {2, 2, 0, 3, 3},
+            {0, 2, 0, 1, 3},
+    };
+    // ceil(log2(2 * 4)) and ceil(log2(2 * 4))
+    const int coordinateBits = 3;
+    const int vertexBits = 3;
+
+    BitWriter writer;
+    writer.Write(32, 4);
+    for (float coordinate: coordinates) {
+        writer.WriteFloat(coordinate);
+    }
+    writer.Write(32, 4);
+    int previous[5] = {};
+    for (const auto &vertex: vertices) {
+        for (int k = 0; k < 5; ++k) {
+            writer.Write(coordinateBits, ZigZag(vertex[k] - previous[k]));
+            previous[k] = vertex[k];
+        }
+    }
+    writer.AlignToByte();
+
+    const int strip[] = {0, 1, 3, 2};
+    writer.Write(32, 1);
+    writer.Write(8, 0);
+    // triangle strip
+    writer.Write(8, 1);
+    writer.Write(32, 4);
+    int previousIndex = 0;
+    for (int index: strip) {
+        writer.Write(vertexBits, ZigZag(index - previousIndex));
+        previousIndex = index;
+    }
+    writer.AlignToByte();
+    return Box("mesh", writer.GetBytes());
+}
+
+static Bytes ProjectionMeshBox(const Bytes &meshes, bool deflated) {
+    Bytes encoded = meshes;
+    if (deflated) {
+        z_stream stream{};
+        deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+        encoded.resize(deflateBound(&stream, uLong(meshes.size())));
+        stream.next_in = const_cast<Bytef *>(meshes.data());
+        stream.avail_in = uInt(meshes.size());
+        stream.next_out = encoded.data();
+        stream.avail_out = uInt(encoded.size());
+        deflate(&stream, Z_FINISH);
+        encoded.resize(stream.total_out);
+        deflateEnd(&stream);
+    }
+
+    Bytes payload;
+    Append32(payload, uint32_t(crc32(0, encoded.data(), uInt(encoded.size()))));
+    const char *encoding = deflated ? "dfl8" : "raw ";
+    payload.insert(payload.end(), encoding, encoding + 4);
+    AppendBytes(payload, encoded);
+    return FullBox("mshp", payload);
+}
+
+static Bytes VideoSampleEntry(const Bytes &projectionMesh, bool stereo) {
+    Bytes entry;
+    // SampleEntry: reserved, data reference index
+    AppendZeros(entry, 6);
+    Append16(entry, 1);
+    // VisualSampleEntry: pre-defined and reserved, 3840 x 2160, 72 dpi, one frame per sample,
+    // compressor name, depth 24, pre-defined -1
+    AppendZeros(entry, 16);
+    Append16(entry, 3840);
+    Append16(entry, 2160);
+    Append32(entry, 0x00480000);
+    Append32(entry, 0x00480000);
+    Append32(entry, 0);
+    Append16(entry, 1);
+    const char compressorName[32] = "\x0a" "AVC Coding";
+    entry.insert(entry.end(), compressorName, compressorName + sizeof(compressorName));
+    Append16(entry, 0x0018);
+    Append16(entry, 0xffff);
+
+    AppendBytes(entry, Box("avcC", {1, 0x64, 0x00, 0x33, 0xff, 0xe0, 0x00}));
+    AppendBytes(entry, FullBox("st3d", {uint8_t(stereo ? 1 : 0)}));
+    Bytes projectionHeader;
+    AppendZeros(projectionHeader, 12);
+    AppendBytes(entry, Box("sv3d", Boxes({
+            Box("svhd", {0, 0, 0, 0, 't', 'e', 's', 't', 0}),
+            Box("proj", Boxes({
+                    FullBox("prhd", projectionHeader),
+                    projectionMesh,
+            })),
+    })));
+    AppendBytes(entry, Box("pasp", {0, 0, 0, 1, 0, 0, 0, 1}));
+    return Box("avc1", entry);
+}
+
+static Bytes AudioSampleEntry() {
+    Bytes entry;
+    AppendZeros(entry, 6);
+    Append16(entry, 1);
+    // AudioSampleEntry: reserved, 2 channels, 16 bits, pre-defined, reserved, 48 kHz
+    AppendZeros(entry, 8);
+    Append16(entry, 2);
+    Append16(entry, 16);
+    AppendZeros(entry, 4);
+    Append32(entry, 48000u << 16);
+    Bytes descriptor;
+    AppendZeros(descriptor, 30);
+    AppendBytes(entry, FullBox("esds", descriptor));
+    return Box("mp4a", entry);
+}
+
+static Bytes Track(const char *handler, const Bytes &sampleEntry) {
+    Bytes handlerPayload;
+    AppendZeros(handlerPayload, 4);
+    handlerPayload.insert(handlerPayload.end(), handler, handler + 4);
+    AppendZeros(handlerPayload, 13);
+
+    Bytes sampleDescription;
+    Append32(sampleDescription, 1);
+    AppendBytes(sampleDescription, sampleEntry);
+
+    Bytes emptyTable;
+    Append32(emptyTable, 0);
+    return Box("trak", Boxes({
+            FullBox("tkhd", Bytes(80, 0)),
+            Box("mdia", Boxes({
+                    FullBox("mdhd", Bytes(20, 0)),
+                    FullBox("hdlr", handlerPayload),
+                    Box("minf", Boxes({
+                            FullBox("vmhd", Bytes(8, 0)),
+                            Box("stbl", Boxes({
+                                    FullBox("stsd", sampleDescription),
+                                    FullBox("stts", emptyTable),
+                                    FullBox("stsz", Bytes(8, 0)),
+                            })),
+                    })),
+            })),
+    }));
+}
+
+static Bytes Movie(const Bytes &projectionMesh, bool stereo) {
+    return Boxes({
+            Box("ftyp", {'i', 's', 'o', 'm', 0, 0, 2, 0, 'i', 's', 'o', 'm', 'a', 'v', 'c', '1'}),
+            Box("mdat", Bytes(1000, 0xa5)),
+            Box("moov", Boxes({
+                    FullBox("mvhd", Bytes(96, 0)),
+                    Track("soun", AudioSampleEntry()),
+                    Track("vide", VideoSampleEntry(projectionMesh, stereo)),
+            })),
+    });
+}
+
+static bool ImportFromBytes(const Bytes &file, std::vector<TexturedMesh::Builder> &meshes) {
+    FILE *temp = std::tmpfile();
+    std::fwrite(file.data(), 1, file.size(), temp);
+    std::fflush(temp);
+    const bool imported = ImportSv3dMeshes(fileno(temp), meshes);
+    std::fclose(temp);
+    return imported;
+}
+
+static void CheckQuadMesh(const TexturedMesh::Builder &mesh, float uvOffset) {
+    CHECK(mesh.positions().size() == 4 * 3);
+    CHECK(mesh.uvs().size() == 4 * 2);
+    CHECK(mesh.indices().size() == 2 * 3);
+    if (mesh.positions().size() != 4 * 3 || mesh.indices().size() != 2 * 3) {
+        return;
+    }
+    // scaled so that the farthest vertex is at distance 1
+    const float scale = 1.0f / std::sqrt(3.0f);
+    CHECK_NEAR(mesh.positions()[0], -scale, 1e-6);
+    CHECK_NEAR(mesh.positions()[6], scale, 1e-6);
+    CHECK_NEAR(mesh.positions()[7], scale, 1e-6);
+    CHECK_NEAR(mesh.positions()[8], -scale, 1e-6);
+    // the texture origin flipped to the top
+    CHECK_NEAR(mesh.uvs()[0], 0.0f, 1e-6);
+    CHECK_NEAR(mesh.uvs()[1], 1.0f, 1e-6);
+    CHECK_NEAR(mesh.uvs()[4], 0.5f + uvOffset, 1e-6);
+    CHECK_NEAR(mesh.uvs()[5], 0.5f - uvOffset, 1e-6);
+    // the strip 0 1 3 2
+    const std::vector<GLushort> triangles = {0, 1, 3, 3, 1, 2};
+    CHECK(mesh.indices() == triangles);
+}
+
+static void TestMonoRawMesh() {
+    std::vector<TexturedMesh::Builder> meshes;
+    CHECK(ImportFromBytes(Movie(ProjectionMeshBox(QuadMeshBox(0.0f), false), false), meshes));
+    CHECK(meshes.size() == 1);
+    if (meshes.size() == 1) {
+        CheckQuadMesh(meshes[0], 0.0f);
+    }
+}
+
+static void TestStereoDeflatedMeshes() {
+    const Bytes meshBoxes = Boxes({QuadMeshBox(0.0f), QuadMeshBox(0.25f)});
+    std::vector<TexturedMesh::Builder> meshes;
+    CHECK(ImportFromBytes(Movie(ProjectionMeshBox(meshBoxes, true), true), meshes));
+    CHECK(meshes.size() == 2);
+    if (meshes.size() == 2) {
+        CheckQuadMesh(meshes[0], 0.0f);
+        CheckQuadMesh(meshes[1], 0.25f);
+    }
+}
+
+static void TestVideoWithoutMesh() {
+    std::vector<TexturedMesh::Builder> meshes;
+    CHECK(!ImportFromBytes(Movie(Box("free", {}), false), meshes));
+    CHECK(meshes.empty());
+}
+
+static void TestFile(const char *path) {
+    const int fd = open(path, O_RDONLY);
+    CHECK(fd >= 0);
+    if (fd < 0) {
+        return;
+    }
+    std::vector<TexturedMesh::Builder> meshes;
+    CHECK(ImportSv3dMeshes(fd, meshes));
+    close(fd);
+    for (const TexturedMesh::Builder &mesh: meshes) {
+        std::printf("%s: %zu vertices, %zu triangles\n", path, mesh.positions().size() / 3,
+                    mesh.indices().size() / 3);
+        CHECK(!mesh.indices().empty());
+    }
+}
+
+int main(int argc, char *argv[]) {
+    TestMonoRawMesh();
+    TestStereoDeflatedMeshes();
+    TestVideoWithoutMesh();
+    for (int i = 1; i < argc; ++i) {
+        TestFile(argv[i]);
+    }
+    return TestResult();
+}
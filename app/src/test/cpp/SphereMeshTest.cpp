@@ -0,0 +1,145 @@
+#include <cmath>
+#include <cstdio>
+
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+#include <vector>
+
+#include "glm/vec2.hpp"
+#include "glm/vec3.hpp"
+#include "glm/geometric.hpp"
+#include "glm/trigonometric.hpp"
+
+#include "ProjectionMesh.h"
+#include "TestCheck.h"
+
+/**
+ * Measures the texture mapping error of the UV sphere meshes of equirectangular video, and prints
+ * the vertex count versus error table used to choose the tessellation of the renderer.
+ */
+
+static constexpr float CENTRAL_LATITUDE_LIMIT = float(M_PI) / 3.0f;
+
+struct SphereMeshError {
+    std::size_t vertexCount;
+    std::size_t triangleCount;
+    // maximum angular distance between the direction a texel is shown at and its true direction
+    float maxErrorRadians;
+    // the same, limited to |latitude| <= 60°, i.e. where the user usually looks
+    float maxCentralErrorRadians;
+    // triangles facing away from the sphere center, culled by the renderer
+    std::size_t backFacingCount;
+};
+
+static TexturedMesh::Builder BuildSphere(float minTheta, float maxTheta, int n_slices,
+                                         int n_stacks) {
+    TexturedMesh::Builder meshBuilder;
+    ProjectionMeshGenerator<EquirectProjection>::AddMesh({minTheta, maxTheta}, n_slices, n_stacks,
+                                                         {0.0f, 0.0f, 1.0f, 1.0f}, meshBuilder);
+    return meshBuilder;
+}
+
+/**
+ * For sample points inside every triangle of a mesh built for the full [0, 1] texture, compares
+ * the interpolated texture coordinate with the exact equirectangular one for the direction the
+ * point is seen at from the sphere center.
+ */
+static SphereMeshError
+EvaluateSphereMesh(const TexturedMesh::Builder &meshBuilder, float minTheta, float maxTheta) {
+    static const std::array<glm::vec3, 4> sampleWeights = {
+            glm::vec3(1.0f / 3.0f, 1.0f / 3.0f, 1.0f / 3.0f),
+            glm::vec3(0.5f, 0.5f, 0.0f),
+            glm::vec3(0.0f, 0.5f, 0.5f),
+            glm::vec3(0.5f, 0.0f, 0.5f),
+    };
+
+    const std::vector<GLfloat> &positions = meshBuilder.positions();
+    const std::vector<GLfloat> &uvs = meshBuilder.uvs();
+    const std::vector<GLushort> &indices = meshBuilder.indices();
+    const EquirectProjection projection{minTheta, maxTheta};
+    const float thetaRange = maxTheta - minTheta;
+    const float uPeriod = float(M_PI) * 2.0f / thetaRange;
+
+    SphereMeshError result{positions.size() / 3, indices.size() / 3, 0.0f, 0.0f, 0};
+
+    for (std::size_t t = 0; t + 2 < indices.size(); t += 3) {
+        std::array<glm::vec3, 3> pos;
+        std::array<glm::vec2, 3> uv;
+        for (int k = 0; k < 3; ++k) {
+            GLushort index = indices[t + k];
+            pos[k] = {positions[3 * index], positions[3 * index + 1], positions[3 * index + 2]};
+            uv[k] = {uvs[2 * index], uvs[2 * index + 1]};
+        }
+
+        // counter-clockwise when seen from the inside
+        const glm::vec3 normal = glm::cross(pos[1] - pos[0], pos[2] - pos[0]);
+        if (glm::dot(normal, pos[0] + pos[1] + pos[2]) >= 0.0f) {
+            ++result.backFacingCount;
+        }
+
+        for (const glm::vec3 &w: sampleWeights) {
+            glm::vec3 p = glm::normalize(w.x * pos[0] + w.y * pos[1] + w.z * pos[2]);
+            glm::vec2 interpolatedUv = w.x * uv[0] + w.y * uv[1] + w.z * uv[2];
+
+            glm::vec2 exactUv = projection.ToUV(p);
+            exactUv.x += std::round((interpolatedUv.x - exactUv.x) / uPeriod) * uPeriod;
+            float phi = exactUv.y * float(M_PI);
+
+            float error = std::hypot((interpolatedUv.x - exactUv.x) * thetaRange * std::sin(phi),
+                                     (interpolatedUv.y - exactUv.y) * float(M_PI));
+            result.maxErrorRadians = std::max(result.maxErrorRadians, error);
+            if (std::fabs(float(M_PI_2) - phi) <= CENTRAL_LATITUDE_LIMIT) {
+                result.maxCentralErrorRadians = std::max(result.maxCentralErrorRadians, error);
+            }
+        }
+    }
+
+    return result;
+}
+
+static void PrintSphereMeshError(int n_stacks, const SphereMeshError &error) {
+    std::printf("UV grid %3d: %5zu vertices, %5zu triangles, max error %.3f°, central %.3f°\n",
+                n_stacks, error.vertexCount, error.triangleCount,
+                glm::degrees(error.maxErrorRadians), glm::degrees(error.maxCentralErrorRadians));
+}
+
+static void TestErrorPerVertexCount() {
+    const float minTheta = 0.0f;
+    const float maxTheta = float(M_PI) * 2.0f;
+
+    float previousError = float(M_PI);
+    for (int n_stacks: {8, 10, 16, 20, 32}) {
+        const SphereMeshError error =
+                EvaluateSphereMesh(BuildSphere(minTheta, maxTheta, 2 * n_stacks, n_stacks),
+                                   minTheta, maxTheta);
+        PrintSphereMeshError(n_stacks, error);
+        CHECK(error.vertexCount == std::size_t((2 * n_stacks + 1) * (n_stacks + 1)));
+        CHECK(error.backFacingCount == 0);
+        CHECK(error.maxErrorRadians < previousError);
+        // the poles are the worst, the rows of a grid shrink towards them
+        CHECK(error.maxCentralErrorRadians <= error.maxErrorRadians);
+        previousError = error.maxErrorRadians;
+    }
+}
+
+static void TestRendererMeshes() {
+    // the 360° and 180° spheres of the renderer
+    const SphereMeshError full =
+            EvaluateSphereMesh(BuildSphere(0.0f, float(M_PI) * 2.0f, 40, 20), 0.0f,
+                               float(M_PI) * 2.0f);
+    CHECK(full.backFacingCount == 0);
+    CHECK(glm::degrees(full.maxErrorRadians) < 0.4f);
+
+    const SphereMeshError half =
+            EvaluateSphereMesh(BuildSphere(float(M_PI_2), float(M_PI) * 1.5f, 20, 20),
+                               float(M_PI_2), float(M_PI) * 1.5f);
+    CHECK(half.backFacingCount == 0);
+    CHECK(glm::degrees(half.maxErrorRadians) < 0.4f);
+}
+
+int main() {
+    TestErrorPerVertexCount();
+    TestRendererMeshes();
+    return TestResult();
+}
@@ -0,0 +1,43 @@
+#ifndef VR_VIDEO_PLAYER_TESTCHECK_H
+#define VR_VIDEO_PLAYER_TESTCHECK_H
+
+#include <cmath>
+#include <cstdio>
+
+/**
+ * Minimal checks for the host-compiled tests: a failed check is reported and counted, and the
+ * test returns TestResult() from main, so CTest sees the failure.
+ */
+inline int &TestFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline int TestResult() {
+    if (TestFailures() != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", TestFailures());
+        return 1;
+    }
+    return 0;
+}
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++TestFailures(); \
+        } \
+    } while (false)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    do { \
+        const double checkActual = (actual); \
+        const double checkExpected = (expected); \
+        if (!(std::fabs(checkActual - checkExpected) <= (tolerance))) { \
+            std::fprintf(stderr, "%s:%d: check failed: %s = %g, expected %g\n", __FILE__, \
+                         __LINE__, #actual, checkActual, checkExpected); \
+            ++TestFailures(); \
+        } \
+    } while (false)
+
+#endif //VR_VIDEO_PLAYER_TESTCHECK_H
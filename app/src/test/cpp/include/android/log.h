@@ -0,0 +1,26 @@
+#ifndef VR_VIDEO_PLAYER_TEST_ANDROID_LOG_H
+#define VR_VIDEO_PLAYER_TEST_ANDROID_LOG_H
+
+#include <cstdarg>
+#include <cstdio>
+
+// the part of the NDK log used by logger.h, printing to stderr for the host tests
+
+enum android_LogPriority {
+    ANDROID_LOG_DEBUG = 3,
+    ANDROID_LOG_INFO = 4,
+    ANDROID_LOG_WARN = 5,
+    ANDROID_LOG_ERROR = 6,
+};
+
+inline int __android_log_print(int prio, const char *tag, const char *fmt, ...) {
+    std::fprintf(stderr, "%d %s: ", prio, tag);
+    va_list args;
+    va_start(args, fmt);
+    const int result = std::vfprintf(stderr, fmt, args);
+    va_end(args);
+    std::fputc('\n', stderr);
+    return result;
+}
+
+#endif //VR_VIDEO_PLAYER_TEST_ANDROID_LOG_H
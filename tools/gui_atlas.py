@@ -0,0 +1,897 @@
+#!/usr/bin/env python3
+"""
+Generates the atlas of the VR GUI text: multi-channel signed distance fields (MSDF) of the glyphs
+of a TrueType font, and single-channel distance fields of the button icons, packed into one RGB
+image, plus the C++ table of the glyph metrics.
+
+    tools/gui_atlas.py --font Lato-Regular.ttf
+
+writes app/src/main/assets/gui-atlas.png and app/src/main/cpp/VRGuiAtlas.cpp. Only the Python
+standard library is needed; the distance fields follow msdfgen by Viktor Chlumský (simple edge
+colouring, pseudo-distances, sign correction by the scanline fill).
+"""
+
+import argparse
+import math
+import os
+import struct
+import zlib
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+ASSETS_DIR = os.path.join(REPO_ROOT, 'app', 'src', 'main', 'assets')
+CPP_DIR = os.path.join(REPO_ROOT, 'app', 'src', 'main', 'cpp')
+
+ATLAS_NAME = 'gui-atlas.png'
+ATLAS_WIDTH = 512
+# atlas pixels per em of the text
+GLYPH_EM_SIZE = 32
+# atlas pixels per em of the icons, which have finer details than the glyphs
+ICON_EM_SIZE = 48
+# distance range of the fields in atlas pixels, from the outermost to the innermost value
+PX_RANGE = 4
+PADDING = PX_RANGE // 2 + 1
+# empty pixels between the fields, so filtering never mixes in the channels of a neighbour
+GUTTER = 1
+# a channel difference between neighbouring pixels from which interpolation would make artefacts
+CLASH_THRESHOLD = 1.001
+# corners sharper than this angle (radians) separate differently coloured edges
+CORNER_ANGLE = 3.0
+
+# printable ASCII and Latin-1, the rest of the Czech alphabet, and typographic punctuation
+CHARSET = (list(range(0x20, 0x7f)) + list(range(0xa0, 0x100)) +
+           [ord(c) for c in 'ČčĎďĚěŇňŘřŠšŤťŮůŽž–—‘’‚“”„…•€']) + [0x2212]
+
+# letters missing in some fonts, built from the base letter and a spacing accent centred above it;
+# the carons of ď and ť are apostrophes right of the ascender
+COMPOSED = {
+    'Č': 'Cˇ', 'č': 'cˇ', 'Ď': 'Dˇ', 'ď': 'd’', 'Ě': 'Eˇ', 'ě': 'eˇ', 'Ň': 'Nˇ', 'ň': 'nˇ',
+    'Ř': 'Rˇ', 'ř': 'rˇ', 'Š': 'Sˇ', 'š': 'sˇ', 'Ť': 'Tˇ', 'ť': 't’', 'Ů': 'U˚', 'ů': 'u˚',
+    'Ž': 'Zˇ', 'ž': 'zˇ',
+}
+
+# the icon cells of buttons-texture.png, as the private use code points U+E000 + row * 4 + column
+ICON_TEXTURE = 'buttons-texture.png'
+ICON_CELL = 256
+ICON_GRID = 4
+ICON_FIRST_CODEPOINT = 0xe000
+# the icons are one em square, placed around the middle of the capitals
+ICON_BOTTOM = -0.14
+
+RED, GREEN, BLUE = 1, 2, 4
+YELLOW, MAGENTA, CYAN, WHITE = RED | GREEN, RED | BLUE, GREEN | BLUE, RED | GREEN | BLUE
+
+
+# --- TrueType ---------------------------------------------------------------------------------
+
+class Font:
+    def __init__(self, data):
+        self.data = data
+        num_tables = struct.unpack_from('>H', data, 4)[0]
+        self.tables = {}
+        for i in range(num_tables):
+            tag, _, offset, length = struct.unpack_from('>4sIII', data, 12 + 16 * i)
+            self.tables[tag.decode('latin-1')] = (offset, length)
+        if 'glyf' not in self.tables:
+            raise ValueError('only TrueType outlines are supported')
+
+        head = self.tables['head'][0]
+        self.units_per_em = struct.unpack_from('>H', data, head + 18)[0]
+        index_to_loc_format = struct.unpack_from('>h', data, head + 50)[0]
+        num_glyphs = struct.unpack_from('>H', data, self.tables['maxp'][0] + 4)[0]
+
+        loca = self.tables['loca'][0]
+        if index_to_loc_format == 0:
+            self.loca = [2 * v for v in struct.unpack_from('>%dH' % (num_glyphs + 1), data, loca)]
+        else:
+            self.loca = list(struct.unpack_from('>%dI' % (num_glyphs + 1), data, loca))
+
+        hhea = self.tables['hhea'][0]
+        self.ascender, self.descender, self.line_gap = struct.unpack_from('>hhh', data, hhea + 4)
+        num_h_metrics = struct.unpack_from('>H', data, hhea + 34)[0]
+        hmtx = self.tables['hmtx'][0]
+        self.advances = [struct.unpack_from('>H', data, hmtx + 4 * i)[0]
+                         for i in range(num_h_metrics)]
+        self.advances += [self.advances[-1]] * (num_glyphs - num_h_metrics)
+
+        self.cmap = self._read_cmap()
+
+    def _read_cmap(self):
+        data = self.data
+        cmap = self.tables['cmap'][0]
+        count = struct.unpack_from('>H', data, cmap + 2)[0]
+        subtables = {}
+        for i in range(count):
+            platform, encoding, offset = struct.unpack_from('>HHI', data, cmap + 4 + 8 * i)
+            subtables[(platform, encoding)] = cmap + offset
+        mapping = {}
+        if (3, 10) in subtables:
+            table = subtables[(3, 10)]
+            groups = struct.unpack_from('>I', data, table + 12)[0]
+            for i in range(groups):
+                start, end, glyph = struct.unpack_from('>III', data, table + 16 + 12 * i)
+                for c in range(start, end + 1):
+                    mapping[c] = glyph + c - start
+        elif (3, 1) in subtables:
+            table = subtables[(3, 1)]
+            seg_count = struct.unpack_from('>H', data, table + 6)[0] // 2
+            ends = struct.unpack_from('>%dH' % seg_count, data, table + 14)
+            starts_at = table + 16 + 2 * seg_count
+            starts = struct.unpack_from('>%dH' % seg_count, data, starts_at)
+            deltas = struct.unpack_from('>%dh' % seg_count, data, starts_at + 2 * seg_count)
+            range_at = starts_at + 4 * seg_count
+            ranges = struct.unpack_from('>%dH' % seg_count, data, range_at)
+            for i in range(seg_count):
+                for c in range(starts[i], ends[i] + 1):
+                    if c == 0xffff:
+                        continue
+                    if ranges[i] == 0:
+                        glyph = (c + deltas[i]) & 0xffff
+                    else:
+                        at = range_at + 2 * i + ranges[i] + 2 * (c - starts[i])
+                        glyph = struct.unpack_from('>H', data, at)[0]
+                        if glyph != 0:
+                            glyph = (glyph + deltas[i]) & 0xffff
+                    if glyph != 0:
+                        mapping[c] = glyph
+        else:
+            raise ValueError('no Unicode cmap')
+        return mapping
+
+    def contours(self, glyph):
+        """The closed contours of the glyph as lists of (x, y, on_curve) points."""
+        data = self.data
+        start = self.tables['glyf'][0] + self.loca[glyph]
+        if self.loca[glyph + 1] == self.loca[glyph]:
+            return []
+        num_contours = struct.unpack_from('>h', data, start)[0]
+        at = start + 10
+        if num_contours >= 0:
+            ends = struct.unpack_from('>%dH' % num_contours, data, at)
+            at += 2 * num_contours
+            at += 2 + struct.unpack_from('>H', data, at)[0]
+            num_points = ends[-1] + 1 if ends else 0
+            flags = []
+            while len(flags) < num_points:
+                flag = data[at]
+                at += 1
+                repeat = 0
+                if flag & 8:
+                    repeat = data[at]
+                    at += 1
+                flags += [flag] * (repeat + 1)
+            flags = flags[:num_points]
+            xs, at = self._coordinates(flags, at, 2, 16)
+            ys, at = self._coordinates(flags, at, 4, 32)
+            result = []
+            first = 0
+            for end in ends:
+                result.append([(xs[i], ys[i], bool(flags[i] & 1)) for i in range(first, end + 1)])
+                first = end + 1
+            return result
+
+        result = []
+        more = True
+        while more:
+            flags, component = struct.unpack_from('>HH', data, at)
+            at += 4
+            if flags & 1:
+                dx, dy = struct.unpack_from('>hh', data, at)
+                at += 4
+            else:
+                dx, dy = struct.unpack_from('>bb', data, at)
+                at += 2
+            if not flags & 2:
+                raise ValueError('point-matched components are not supported')
+            a, b, c, d = 1.0, 0.0, 0.0, 1.0
+            if flags & 8:
+                a = d = struct.unpack_from('>h', data, at)[0] / 16384.0
+                at += 2
+            elif flags & 0x40:
+                a, d = (v / 16384.0 for v in struct.unpack_from('>hh', data, at))
+                at += 4
+            elif flags & 0x80:
+                a, b, c, d = (v / 16384.0 for v in struct.unpack_from('>hhhh', data, at))
+                at += 8
+            for contour in self.contours(component):
+                result.append([(a * x + c * y + dx, b * x + d * y + dy, on)
+                               for x, y, on in contour])
+            more = bool(flags & 0x20)
+        return result
+
+    def _coordinates(self, flags, at, short_bit, same_bit):
+        values = []
+        value = 0
+        for flag in flags:
+            if flag & short_bit:
+                delta = self.data[at]
+                at += 1
+                value += delta if flag & same_bit else -delta
+            elif not flag & same_bit:
+                value += struct.unpack_from('>h', self.data, at)[0]
+                at += 2
+            values.append(value)
+        return values, at
+
+
+# --- shapes -----------------------------------------------------------------------------------
+
+def sub(a, b):
+    return a[0] - b[0], a[1] - b[1]
+
+
+def add(a, b):
+    return a[0] + b[0], a[1] + b[1]
+
+
+def mul(a, s):
+    return a[0] * s, a[1] * s
+
+
+def dot(a, b):
+    return a[0] * b[0] + a[1] * b[1]
+
+
+def cross(a, b):
+    return a[0] * b[1] - a[1] * b[0]
+
+
+def length(a):
+    return math.hypot(a[0], a[1])
+
+
+def normalize(a):
+    n = length(a)
+    return (a[0] / n, a[1] / n) if n != 0 else (0.0, 1.0)
+
+
+def non_zero_sign(v):
+    return 1.0 if v > 0 else -1.0
+
+
+def solve_quadratic(a, b, c):
+    if a == 0 or abs(b) > 1e12 * abs(a):
+        return [] if b == 0 else [-c / b]
+    discriminant = b * b - 4 * a * c
+    if discriminant > 0:
+        root = math.sqrt(discriminant)
+        return [(-b + root) / (2 * a), (-b - root) / (2 * a)]
+    if discriminant == 0:
+        return [-b / (2 * a)]
+    return []
+
+
+def solve_cubic(a, b, c, d):
+    if a != 0:
+        bn = b / a
+        if abs(bn) < 1e6:
+            return solve_cubic_normed(bn, c / a, d / a)
+    return solve_quadratic(b, c, d)
+
+
+def solve_cubic_normed(a, b, c):
+    a2 = a * a
+    q = (a2 - 3 * b) / 9
+    r = (a * (2 * a2 - 9 * b) + 27 * c) / 54
+    r2 = r * r
+    q3 = q * q * q
+    a /= 3
+    if r2 < q3:
+        t = math.acos(max(-1.0, min(1.0, r / math.sqrt(q3))))
+        q = -2 * math.sqrt(q)
+        return [q * math.cos(t / 3) - a,
+                q * math.cos((t + 2 * math.pi) / 3) - a,
+                q * math.cos((t - 2 * math.pi) / 3) - a]
+    u = -math.copysign(1.0, r) * (abs(r) + math.sqrt(r2 - q3)) ** (1 / 3)
+    v = 0 if u == 0 else q / u
+    x0 = u + v - a
+    if u == v or abs(u - v) < 1e-12 * abs(u + v):
+        return [x0, -0.5 * (u + v) - a]
+    return [x0]
+
+
+class Edge:
+    """A line (two points) or a quadratic Bézier curve (three points)."""
+
+    def __init__(self, points, color=WHITE):
+        self.p = points
+        self.color = color
+
+    def point(self, t):
+        p = self.p
+        if len(p) == 2:
+            return add(p[0], mul(sub(p[1], p[0]), t))
+        return add(mul(add(mul(p[0], 1 - t), mul(p[1], t)), 1 - t),
+                   mul(add(mul(p[1], 1 - t), mul(p[2], t)), t))
+
+    def direction(self, t):
+        p = self.p
+        if len(p) == 2:
+            return sub(p[1], p[0])
+        d = add(mul(sub(p[1], p[0]), 1 - t), mul(sub(p[2], p[1]), t))
+        return d if d != (0, 0) else sub(p[2], p[0])
+
+    def split_in_thirds(self):
+        return [Edge([self.blossom(a / 3, b / 3) for a, b in self._blossom_args(i)], self.color)
+                for i in range(3)]
+
+    def _blossom_args(self, i):
+        if len(self.p) == 2:
+            return [(i, i), (i + 1, i + 1)]
+        return [(i, i), (i, i + 1), (i + 1, i + 1)]
+
+    def blossom(self, t0, t1):
+        """Control points of the part between t0 and t1 are the blossoms of its ends."""
+        p = self.p
+        if len(p) == 2:
+            return self.point(t0)
+        return add(add(mul(p[0], (1 - t0) * (1 - t1)), mul(p[1], (1 - t0) * t1 + t0 * (1 - t1))),
+                   mul(p[2], t0 * t1))
+
+    def signed_distance(self, origin):
+        """(distance, dot) as in msdfgen, and the curve parameter of the closest point."""
+        p = self.p
+        if len(p) == 2:
+            aq = sub(origin, p[0])
+            ab = sub(p[1], p[0])
+            t = dot(aq, ab) / dot(ab, ab)
+            eq = sub(p[0] if t < 0.5 else p[1], origin)
+            endpoint_distance = length(eq)
+            if 0 < t < 1:
+                ortho = dot(normalize((ab[1], -ab[0])), aq)
+                if abs(ortho) < endpoint_distance:
+                    return ortho, 0.0, t
+            return (non_zero_sign(cross(aq, ab)) * endpoint_distance,
+                    abs(dot(normalize(ab), normalize(eq))), t)
+
+        qa = sub(p[0], origin)
+        ab = sub(p[1], p[0])
+        br = add(sub(p[2], p[1]), mul(ab, -1))
+        a = dot(br, br)
+        b = 3 * dot(ab, br)
+        c = 2 * dot(ab, ab) + dot(qa, br)
+        d = dot(qa, ab)
+        ep_dir = self.direction(0)
+        min_distance = non_zero_sign(cross(ep_dir, qa)) * length(qa)
+        param = -dot(qa, ep_dir) / dot(ep_dir, ep_dir)
+        ep_dir = self.direction(1)
+        distance = length(sub(p[2], origin))
+        if distance < abs(min_distance):
+            min_distance = non_zero_sign(cross(ep_dir, sub(p[2], origin))) * distance
+            param = dot(sub(origin, p[1]), ep_dir) / dot(ep_dir, ep_dir)
+        for t in solve_cubic(a, b, c, d):
+            if 0 < t < 1:
+                qe = add(add(qa, mul(ab, 2 * t)), mul(br, t * t))
+                distance = length(qe)
+                if distance <= abs(min_distance):
+                    min_distance = non_zero_sign(cross(add(ab, mul(br, t)), qe)) * distance
+                    param = t
+        if 0 <= param <= 1:
+            return min_distance, 0.0, param
+        if param < 0.5:
+            return (min_distance, abs(dot(normalize(self.direction(0)), normalize(qa))),
+                    param)
+        return (min_distance,
+                abs(dot(normalize(self.direction(1)), normalize(sub(p[2], origin)))), param)
+
+    def pseudo_distance(self, distance, origin, param):
+        if param < 0:
+            direction = normalize(self.direction(0))
+            aq = sub(origin, self.p[0])
+            if dot(aq, direction) < 0:
+                pseudo = cross(aq, direction)
+                if abs(pseudo) <= abs(distance):
+                    return pseudo
+        elif param > 1:
+            direction = normalize(self.direction(1))
+            bq = sub(origin, self.p[-1])
+            if dot(bq, direction) > 0:
+                pseudo = cross(bq, direction)
+                if abs(pseudo) <= abs(distance):
+                    return pseudo
+        return distance
+
+    def crossings(self, y):
+        """(x, winding) of the intersections with the horizontal line at y."""
+        p = self.p
+        result = []
+        if len(p) == 2:
+            (x0, y0), (x1, y1) = p
+            if (y0 <= y < y1) or (y1 <= y < y0):
+                result.append((x0 + (y - y0) * (x1 - x0) / (y1 - y0), 1 if y1 > y0 else -1))
+            return result
+        (x0, y0), (x1, y1), (x2, y2) = p
+        a = y0 - 2 * y1 + y2
+        b = 2 * (y1 - y0)
+        c = y0 - y
+        for t in solve_quadratic(a, b, c):
+            if 0 <= t < 1:
+                dy = self.direction(t)[1]
+                if dy != 0:
+                    result.append((self.point(t)[0], 1 if dy > 0 else -1))
+        return result
+
+
+def contour_edges(points):
+    """Edges of a TrueType contour, with the implied on-curve points between off-curve ones."""
+    n = len(points)
+    start = next((i for i in range(n) if points[i][2]), None)
+    if start is None:
+        # all off-curve: start at an implied midpoint
+        p0, p1 = points[0], points[1]
+        points = [((p0[0] + p1[0]) / 2, (p0[1] + p1[1]) / 2, True)] + points[1:] + [points[0]]
+        n = len(points)
+        start = 0
+    ordered = [points[(start + i) % n] for i in range(n)] + [points[start]]
+    edges = []
+    current = ordered[0][:2]
+    control = None
+    for x, y, on in ordered[1:]:
+        if on:
+            if control is None:
+                if (x, y) != current:
+                    edges.append(Edge([current, (x, y)]))
+            else:
+                edges.append(Edge([current, control, (x, y)]))
+            current = (x, y)
+            control = None
+        else:
+            if control is not None:
+                middle = ((control[0] + x) / 2, (control[1] + y) / 2)
+                edges.append(Edge([current, control, middle]))
+                current = middle
+            control = (x, y)
+    return edges
+
+
+def switch_color(color, seed, banned=0):
+    combined = color & banned
+    if combined in (RED, GREEN, BLUE):
+        return combined ^ WHITE, seed
+    if color in (0, WHITE):
+        return (CYAN, MAGENTA, YELLOW)[seed % 3], seed // 3
+    shifted = color << (1 + (seed & 1))
+    return (shifted | shifted >> 3) & WHITE, seed >> 1
+
+
+def color_edges(contours, seed=0):
+    """msdfgen's simple edge colouring, splitting the edges of single-corner contours if needed."""
+    cross_threshold = math.sin(CORNER_ANGLE)
+    result = []
+    for edges in contours:
+        corners = []
+        if edges:
+            previous = normalize(edges[-1].direction(1))
+            for i, edge in enumerate(edges):
+                current = normalize(edge.direction(0))
+                if dot(previous, current) <= 0 or abs(cross(previous, current)) > cross_threshold:
+                    corners.append(i)
+                previous = normalize(edge.direction(1))
+
+        if not corners:
+            for edge in edges:
+                edge.color = WHITE
+        elif len(corners) == 1:
+            first, seed = switch_color(WHITE, seed)
+            last, seed = switch_color(first, seed)
+            colors = [first, WHITE, last]
+            corner = corners[0]
+            if len(edges) < 3:
+                edges = [part for edge in edges for part in edge.split_in_thirds()]
+                corner *= 3
+            m = len(edges)
+            for i in range(m):
+                edges[(corner + i) % m].color = colors[int(2.0625 + 2.875 * i / (m - 1)) - 2]
+        else:
+            color, seed = switch_color(WHITE, seed)
+            initial = color
+            spline = 0
+            start = corners[0]
+            m = len(edges)
+            for i in range(m):
+                index = (start + i) % m
+                if spline + 1 < len(corners) and corners[spline + 1] == index:
+                    spline += 1
+                    color, seed = switch_color(
+                        color, seed, initial if spline == len(corners) - 1 else 0)
+                edges[index].color = color
+        result.append(edges)
+    return result
+
+
+def generate_msdf(contours, left, bottom, width, height, scale):
+    """
+    RGB rows, from the top, of the field over width × height pixels whose bottom left corner is at
+    (left, bottom) in pixels; the outlines are in font units, scale pixels per unit.
+    """
+    edges = [edge for contour in contours for edge in contour]
+    rows = []
+    for j in reversed(range(height)):
+        y = (bottom + j + 0.5) / scale
+        crossings = sorted(c for edge in edges for c in edge.crossings(y))
+        row = []
+        for i in range(width):
+            x = (left + i + 0.5) / scale
+            origin = (x, y)
+            winding = sum(w for cx, w in crossings if cx < x)
+            inside = winding != 0
+
+            best = [None, None, None]
+            closest = None
+            for edge in edges:
+                distance, alignment, param = edge.signed_distance(origin)
+                key = (abs(distance), alignment)
+                if closest is None or key < closest[0]:
+                    closest = (key, distance)
+                for channel, bit in enumerate((RED, GREEN, BLUE)):
+                    if edge.color & bit and (best[channel] is None or key < best[channel][0]):
+                        best[channel] = (key, edge, distance, param)
+            channels = []
+            for channel in range(3):
+                if best[channel] is None:
+                    channels.append(-1e9)
+                    continue
+                _, edge, distance, param = best[channel]
+                channels.append(edge.pseudo_distance(distance, origin, param))
+
+            true_distance = abs(closest[1]) if inside else -abs(closest[1])
+            median = sorted(channels)[1]
+            if (median > 0) != inside:
+                # a clash of the channels; the plain distance field is correct, if rounder
+                channels = [true_distance] * 3
+            row.append([c * scale for c in channels])
+        rows.append(row)
+    return correct_clashes(rows)
+
+
+def detect_clash(a, b):
+    """
+    Whether interpolating between the neighbouring pixels a and b would make an artefact; only the
+    one farther from the edge is flagged.
+    """
+    pairs = sorted(zip(a, b), key=lambda pair: -abs(pair[1] - pair[0]))
+    (a0, b0), (a1, b1), (a2, b2) = pairs
+    return (abs(b1 - a1) >= CLASH_THRESHOLD and not (b[0] == b[1] == b[2]) and
+            abs(a2) >= abs(b2))
+
+
+def correct_clashes(field):
+    """msdfgen's error correction: clashing pixels get the median in all channels."""
+    height = len(field)
+    width = len(field[0])
+    clashes = []
+    for j in range(height):
+        for i in range(width):
+            pixel = field[j][i]
+            neighbours = [(i + di, j + dj) for di, dj in ((-1, 0), (1, 0), (0, -1), (0, 1))]
+            if any(0 <= x < width and 0 <= y < height and detect_clash(pixel, field[y][x])
+                   for x, y in neighbours):
+                clashes.append((i, j))
+    for i, j in clashes:
+        field[j][i] = [sorted(field[j][i])[1]] * 3
+    return field
+
+
+# --- icons ------------------------------------------------------------------------------------
+
+def distance_transform_1d(f):
+    n = len(f)
+    d = [0.0] * n
+    v = [0] * n
+    z = [0.0] * (n + 1)
+    k = 0
+    z[0] = -math.inf
+    z[1] = math.inf
+    for q in range(1, n):
+        while True:
+            s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k])
+            if s <= z[k]:
+                k -= 1
+                continue
+            break
+        k += 1
+        v[k] = q
+        z[k] = s
+        z[k + 1] = math.inf
+    k = 0
+    for q in range(n):
+        while z[k + 1] < q:
+            k += 1
+        d[q] = (q - v[k]) ** 2 + f[v[k]]
+    return d
+
+
+def distance_transform(mask, size):
+    """Squared distances to the nearest set pixel (Felzenszwalb & Huttenlocher)."""
+    big = float(size * size * 4)
+    grid = [[0.0 if mask[y][x] else big for x in range(size)] for y in range(size)]
+    for x in range(size):
+        column = distance_transform_1d([grid[y][x] for y in range(size)])
+        for y in range(size):
+            grid[y][x] = column[y]
+    return [distance_transform_1d(row) for row in grid]
+
+
+def icon_field(alpha, box):
+    """Rows of the signed distance field of a cell, in atlas pixels, box pixels square."""
+    size = len(alpha)
+    inside = [[a >= 128 for a in row] for row in alpha]
+    outside = [[not v for v in row] for row in inside]
+    to_inside = distance_transform(inside, size)
+    to_outside = distance_transform(outside, size)
+    signed = [[math.sqrt(to_outside[y][x]) - 0.5 if inside[y][x]
+               else 0.5 - math.sqrt(to_inside[y][x]) for x in range(size)] for y in range(size)]
+
+    texels_per_pixel = size / ICON_EM_SIZE
+
+    def sample(sx, sy):
+        # outside of the cell, extrapolate by the distance to its border
+        cx = min(max(sx, 0.0), size - 1.0)
+        cy = min(max(sy, 0.0), size - 1.0)
+        x0, y0 = int(cx), int(cy)
+        x1, y1 = min(x0 + 1, size - 1), min(y0 + 1, size - 1)
+        fx, fy = cx - x0, cy - y0
+        top = signed[y0][x0] * (1 - fx) + signed[y0][x1] * fx
+        bottom = signed[y1][x0] * (1 - fx) + signed[y1][x1] * fx
+        value = top * (1 - fy) + bottom * fy
+        return value - math.hypot(sx - cx, sy - cy)
+
+    rows = []
+    for j in range(box):
+        row = []
+        for i in range(box):
+            sx = (i - PADDING + 0.5) * texels_per_pixel - 0.5
+            sy = (j - PADDING + 0.5) * texels_per_pixel - 0.5
+            distance = sample(sx, sy) / texels_per_pixel
+            row.append([distance] * 3)
+        rows.append(row)
+    return rows
+
+
+# --- PNG --------------------------------------------------------------------------------------
+
+def read_png_alpha(path):
+    with open(path, 'rb') as file:
+        data = file.read()
+    at = 8
+    idat = b''
+    while at < len(data):
+        size, kind = struct.unpack_from('>I4s', data, at)
+        chunk = data[at + 8:at + 8 + size]
+        if kind == b'IHDR':
+            width, height, depth, color_type, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+            if depth != 8 or color_type != 6 or interlace != 0:
+                raise ValueError('only 8-bit RGBA non-interlaced PNG is supported')
+        elif kind == b'IDAT':
+            idat += chunk
+        at += 12 + size
+    raw = zlib.decompress(idat)
+    stride = 4 * width
+    rows = []
+    previous = bytearray(stride)
+    at = 0
+    for _ in range(height):
+        kind = raw[at]
+        line = bytearray(raw[at + 1:at + 1 + stride])
+        at += 1 + stride
+        for i in range(stride):
+            a = line[i - 4] if i >= 4 else 0
+            b = previous[i]
+            c = previous[i - 4] if i >= 4 else 0
+            if kind == 1:
+                line[i] = (line[i] + a) & 0xff
+            elif kind == 2:
+                line[i] = (line[i] + b) & 0xff
+            elif kind == 3:
+                line[i] = (line[i] + (a + b) // 2) & 0xff
+            elif kind == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                predictor = a if pa <= pb and pa <= pc else (b if pb <= pc else c)
+                line[i] = (line[i] + predictor) & 0xff
+        rows.append(list(line[3::4]))
+        previous = line
+    return rows
+
+
+def write_png_rgb(path, width, height, pixels):
+    raw = b''.join(b'\x00' + bytes(pixels[y * width * 3:(y + 1) * width * 3])
+                   for y in range(height))
+
+    def chunk(kind, payload):
+        return (struct.pack('>I', len(payload)) + kind + payload +
+                struct.pack('>I', zlib.crc32(kind + payload) & 0xffffffff))
+
+    with open(path, 'wb') as file:
+        file.write(b'\x89PNG\r\n\x1a\n')
+        file.write(chunk(b'IHDR', struct.pack('>IIBBBBB', width, height, 8, 2, 0, 0, 0)))
+        file.write(chunk(b'IDAT', zlib.compress(raw, 9)))
+        file.write(chunk(b'IEND', b''))
+
+
+# --- atlas ------------------------------------------------------------------------------------
+
+class Entry:
+    def __init__(self, codepoint, advance, plane, field):
+        self.codepoint = codepoint
+        self.advance = advance
+        # left, bottom, right, top in ems
+        self.plane = plane
+        self.field = field
+        self.x = self.y = 0
+
+    @property
+    def width(self):
+        return len(self.field[0]) if self.field else 0
+
+    @property
+    def height(self):
+        return len(self.field)
+
+
+def bounds(contours):
+    xs = [x for points in contours for x, _, _ in points]
+    ys = [y for points in contours for _, y, _ in points]
+    return min(xs), min(ys), max(xs), max(ys)
+
+
+def composed_contours(font, codepoint):
+    """The outline points of a COMPOSED letter, and its advance in font units."""
+    base, accent = (font.cmap[ord(c)] for c in COMPOSED[chr(codepoint)])
+    base_contours = font.contours(base)
+    accent_contours = font.contours(accent)
+    base_left, _, base_right, base_top = bounds(base_contours)
+    accent_left, accent_bottom, accent_right, _ = bounds(accent_contours)
+    advance = font.advances[base]
+    if COMPOSED[chr(codepoint)][1] == '’':
+        dx = base_right - accent_left + 0.04 * font.units_per_em
+        dy = base_top - bounds(accent_contours)[3]
+        advance += accent_right - accent_left
+    else:
+        # the spacing accents sit above the lowercase letters
+        x_top = bounds(font.contours(font.cmap[ord('x')]))[3]
+        dx = (base_left + base_right - accent_left - accent_right) / 2
+        dy = base_top - x_top if chr(codepoint).isupper() else 0
+    moved = [[(x + dx, y + dy, on) for x, y, on in points] for points in accent_contours]
+    return base_contours + moved, advance
+
+
+def glyph_entry(font, codepoint):
+    if codepoint in font.cmap:
+        glyph = font.cmap[codepoint]
+        outline = font.contours(glyph)
+        advance = font.advances[glyph] / font.units_per_em
+    else:
+        outline, advance = composed_contours(font, codepoint)
+        advance /= font.units_per_em
+    contours = [contour_edges(points) for points in outline]
+    contours = [edges for edges in contours if edges]
+    if not contours:
+        return Entry(codepoint, advance, None, [])
+
+    scale = GLYPH_EM_SIZE / font.units_per_em
+    xs = [v for edges in contours for edge in edges for v, _ in edge.p]
+    ys = [v for edges in contours for edge in edges for _, v in edge.p]
+    left = math.floor(min(xs) * scale) - PADDING
+    bottom = math.floor(min(ys) * scale) - PADDING
+    width = math.ceil(max(xs) * scale) - math.floor(min(xs) * scale) + 2 * PADDING
+    height = math.ceil(max(ys) * scale) - math.floor(min(ys) * scale) + 2 * PADDING
+    field = generate_msdf(color_edges(contours), left, bottom, width, height, scale)
+    plane = (left / GLYPH_EM_SIZE, bottom / GLYPH_EM_SIZE,
+             (left + width) / GLYPH_EM_SIZE, (bottom + height) / GLYPH_EM_SIZE)
+    return Entry(codepoint, advance, plane, field)
+
+
+def icon_entries(path):
+    alpha = read_png_alpha(path)
+    entries = []
+    box = ICON_EM_SIZE + 2 * PADDING
+    for row in range(ICON_GRID):
+        for column in range(ICON_GRID):
+            cell = [line[column * ICON_CELL:(column + 1) * ICON_CELL]
+                    for line in alpha[row * ICON_CELL:(row + 1) * ICON_CELL]]
+            if not any(a >= 128 for line in cell for a in line):
+                continue
+            field = icon_field(cell, box)
+            pad = PADDING / ICON_EM_SIZE
+            plane = (-pad, ICON_BOTTOM - pad, 1 + pad, ICON_BOTTOM + 1 + pad)
+            entries.append(Entry(ICON_FIRST_CODEPOINT + row * ICON_GRID + column, 1.0, plane,
+                                 field))
+    return entries
+
+
+def pack(entries):
+    """Shelf packing by decreasing height; returns the atlas height."""
+    x = y = shelf = 0
+    for entry in sorted(entries, key=lambda e: (-e.height, e.codepoint)):
+        if entry.height == 0:
+            continue
+        if x + entry.width > ATLAS_WIDTH:
+            x = 0
+            y += shelf
+            shelf = 0
+        entry.x, entry.y = x, y
+        x += entry.width + GUTTER
+        shelf = max(shelf, entry.height + GUTTER)
+    return (y + shelf + 3) // 4 * 4
+
+
+def write_atlas(entries, width, height, path):
+    pixels = bytearray(width * height * 3)
+    for entry in entries:
+        for j, row in enumerate(entry.field):
+            for i, channels in enumerate(row):
+                at = ((entry.y + j) * width + entry.x + i) * 3
+                for c, distance in enumerate(channels):
+                    value = 0.5 + distance / PX_RANGE
+                    pixels[at + c] = max(0, min(255, int(round(value * 255))))
+    write_png_rgb(path, width, height, pixels)
+
+
+def write_table(font, entries, width, height, path):
+    em = font.units_per_em
+    lines = [
+        '// Generated by tools/gui_atlas.py from %s; do not edit.' % FONT_NAME,
+        '',
+        '#include "VRGuiAtlas.h"',
+        '',
+        'const char *const VR_GUI_ATLAS_TEXTURE = "%s";' % ATLAS_NAME,
+        '',
+        'const VRGuiAtlasMetrics VR_GUI_ATLAS_METRICS = {',
+        '        %d, %d, %.1ff,' % (width, height, PX_RANGE),
+        '        %sf, %sf, %sf',
+        '};',
+        '',
+        'const VRGuiGlyph VR_GUI_ATLAS_GLYPHS[] = {',
+    ]
+    lines[8] = lines[8] % (fmt(font.ascender / em), fmt(font.descender / em),
+                           fmt((font.ascender - font.descender + font.line_gap) / em))
+    for entry in sorted(entries, key=lambda e: e.codepoint):
+        if entry.plane is None:
+            plane = atlas = (0, 0, 0, 0)
+        else:
+            plane = entry.plane
+            atlas = (entry.x, entry.y, entry.x + entry.width, entry.y + entry.height)
+        lines.append('        {0x%04x, %sf, {%sf, %sf, %sf, %sf}, {%d, %d, %d, %d}},' % (
+            (entry.codepoint, fmt(entry.advance)) + tuple(fmt(v) for v in plane) + atlas))
+    lines += [
+        '};',
+        '',
+        'const std::size_t VR_GUI_ATLAS_GLYPH_COUNT =',
+        '        sizeof(VR_GUI_ATLAS_GLYPHS) / sizeof(VR_GUI_ATLAS_GLYPHS[0]);',
+        '',
+    ]
+    with open(path, 'w') as file:
+        file.write('\n'.join(lines))
+
+
+def fmt(value):
+    text = '%.6g' % value
+    return text if any(c in text for c in '.e') else text + '.0'
+
+
+def main():
+    global FONT_NAME
+    parser = argparse.ArgumentParser(description=__doc__.strip().split('\n\n')[0])
+    parser.add_argument('--font', required=True, help='TrueType font of the text')
+    args = parser.parse_args()
+    FONT_NAME = os.path.basename(args.font)
+
+    with open(args.font, 'rb') as file:
+        font = Font(file.read())
+    available = [c for c in CHARSET if c in font.cmap or chr(c) in COMPOSED]
+    entries = [glyph_entry(font, c) for c in available]
+    missing = [c for c in CHARSET if c not in available]
+    if missing:
+        print('Missing in the font: %s' % ' '.join('U+%04X' % c for c in missing))
+    entries += icon_entries(os.path.join(ASSETS_DIR, ICON_TEXTURE))
+
+    height = pack(entries)
+    write_atlas(entries, ATLAS_WIDTH, height, os.path.join(ASSETS_DIR, ATLAS_NAME))
+    write_table(font, entries, ATLAS_WIDTH, height, os.path.join(CPP_DIR, 'VRGuiAtlas.cpp'))
+    print('%d glyphs and icons in a %d × %d atlas' % (len(entries), ATLAS_WIDTH, height))
+
+
+FONT_NAME = ''
+
+if __name__ == '__main__':
+    main()